@@ -648,17 +648,24 @@ struct memorypool {
 
 
 /* Global constants.                                                         */
+/* NOTE utymap: globals are thread local as meshes are built concurrently.   */
 
-REAL splitter;       /* Used to split REAL factors for exact multiplication. */
-REAL epsilon;                             /* Floating-point machine epsilon. */
-REAL resulterrbound;
-REAL ccwerrboundA, ccwerrboundB, ccwerrboundC;
-REAL iccerrboundA, iccerrboundB, iccerrboundC;
-REAL o3derrboundA, o3derrboundB, o3derrboundC;
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+THREAD_LOCAL REAL splitter;  /* Used to split REAL factors for exact multiplication. */
+THREAD_LOCAL REAL epsilon;                /* Floating-point machine epsilon. */
+THREAD_LOCAL REAL resulterrbound;
+THREAD_LOCAL REAL ccwerrboundA, ccwerrboundB, ccwerrboundC;
+THREAD_LOCAL REAL iccerrboundA, iccerrboundB, iccerrboundC;
+THREAD_LOCAL REAL o3derrboundA, o3derrboundB, o3derrboundC;
 
 /* Random number seed is not constant, but I've made it global anyway.       */
 
-unsigned long randomseed;                     /* Current random number seed. */
+THREAD_LOCAL unsigned long randomseed;        /* Current random number seed. */
 
 
 /* Mesh data structure.  Triangle operates on only one mesh, but the mesh    */
@@ -6,7 +6,10 @@
 #include "LodRange.hpp"
 #include "builders/BuilderContext.hpp"
 #include "builders/ExternalBuilder.hpp"
+#include "builders/MeshCache.hpp"
 #include "builders/QuadKeyBuilder.hpp"
+#include "builders/QuadKeyPrefetcher.hpp"
+#include "builders/QuadKeyScheduler.hpp"
 #include "builders/buildings/BuildingBuilder.hpp"
 #include "builders/misc/BarrierBuilder.hpp"
 #include "builders/poi/TreeBuilder.hpp"
@@ -16,19 +19,28 @@
 #include "index/GeoStore.hpp"
 #include "index/InMemoryElementStore.hpp"
 #include "index/PersistentElementStore.hpp"
+#include "mapcss/BinaryStyleSheet.hpp"
 #include "mapcss/MapCssParser.hpp"
 #include "mapcss/StyleSheet.hpp"
+#include "mapcss/StyleSheetDiff.hpp"
 #include "meshing/MeshTypes.hpp"
+#include "utils/CancellationToken.hpp"
 #include "utils/GeoUtils.hpp"
+#include "utils/ThreadPool.hpp"
 
 #include "Callbacks.hpp"
 #include "ExportElementVisitor.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <exception>
 #include <fstream>
+#include <functional>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <unordered_map>
 
@@ -36,6 +48,8 @@
 class Application
 {
     const int SrtmElevationLodStart = 42; // NOTE: disable for initial MVP
+    const std::string BinaryStyleSheetExtension = ".mapcss.bin";
+    const std::size_t DefaultMeshCacheSize = 64 * 1024 * 1024;
 
 public:
 
@@ -44,7 +58,9 @@ public:
                 const char* elePath, 
                 OnError* errorCallback) :
         stringTable_(stringPath), geoStore_(stringTable_), srtmEleProvider_(elePath),
-        flatEleProvider_(), quadKeyBuilder_(geoStore_, stringTable_)
+        flatEleProvider_(), quadKeyBuilder_(geoStore_, stringTable_),
+        meshCache_(std::make_shared<utymap::builders::MeshCache>("", DefaultMeshCacheSize)),
+        isPrefetchEnabled_(false), lastRequestId_(0), workerCount_(utymap::utils::getWorkerCount())
     {
         registerDefaultBuilders();
     }
@@ -55,19 +71,78 @@ public:
         getStyleProvider(path);
     }
 
-    void registerInMemoryStore(const char* key)
+    // Reloads stylesheet and reports levels of details and selectors changed since
+    // it was loaded last time. Provider is replaced only if rules were changed.
+    void reloadStylesheet(const char* path, OnStyleChanged* changeCallback, OnError* errorCallback)
+    {
+        safeExecute([&]() {
+            std::string filePath = path;
+            utymap::mapcss::StyleSheet stylesheet = parseStyleSheet(filePath);
+
+            utymap::mapcss::StyleSheetDiff diff;
+            {
+                std::lock_guard<std::mutex> lock(styleLock_);
+                auto oldStylesheet = styleSheets_.find(filePath);
+                diff = utymap::mapcss::StyleSheetDiff::create(
+                    oldStylesheet != styleSheets_.end() ? oldStylesheet->second : utymap::mapcss::StyleSheet(), stylesheet);
+
+                if (!diff.empty()) {
+                    // NOTE gradients of previous version are reused, so only new ones are parsed.
+                    auto oldProvider = styleProviders_.find(filePath);
+                    createStyleProvider(filePath, stylesheet, oldProvider != styleProviders_.end()
+                        ? oldProvider->second->getGradients()
+                        : utymap::mapcss::StyleProvider::Gradients());
+                }
+            }
+
+            // NOTE cached quadkeys are validated by style hash, this just frees memory.
+            if (!diff.empty())
+                std::atomic_load(&meshCache_)->invalidate(diff.lodMask);
+
+            // NOTE callback is called without lock as client may load quadkeys or register stylesheets.
+            std::vector<int> lods;
+            for (int lod = 0; lod < 32; ++lod) {
+                if (diff.lodMask & (1u << lod))
+                    lods.push_back(lod);
+            }
+            std::vector<const char*> selectors;
+            for (const auto& selector : diff.selectors)
+                selectors.push_back(selector.c_str());
+
+            changeCallback(lods.data(), static_cast<int>(lods.size()),
+                           selectors.data(), static_cast<int>(selectors.size()));
+        }, errorCallback);
+    }
+
+    // Configures cache of built quadkeys. Compiled stylesheets registered later
+    // are kept in the same directory. Disk is not used if directory is empty.
+    void configureMeshCache(const char* directory, int memorySize)
+    {
+        {
+            std::lock_guard<std::mutex> lock(styleLock_);
+            cacheDirectory_ = directory;
+        }
+        std::atomic_store(&meshCache_, std::make_shared<utymap::builders::MeshCache>(
+            directory, memorySize > 0 ? static_cast<std::size_t>(memorySize) : DefaultMeshCacheSize));
+    }
+
+    // Registers in-memory store. Data imported into filtered store is reduced
+    // to elements and tags used by stylesheet of the import.
+    void registerInMemoryStore(const char* key, bool isFiltered)
     {
         geoStore_.registerStore(key,
-            std::make_shared<utymap::index::InMemoryElementStore>(stringTable_));
+            std::make_shared<utymap::index::InMemoryElementStore>(stringTable_), isFiltered);
     }
 
-    void registerPersistentStore(const char* key, const char* dataPath)
+    // Registers persistent store. Data imported into filtered store is reduced
+    // to elements and tags used by stylesheet of the import.
+    void registerPersistentStore(const char* key, const char* dataPath, bool isFiltered)
     {
         geoStore_.registerStore(key,
-            std::make_shared<utymap::index::PersistentElementStore>(dataPath, stringTable_));
+            std::make_shared<utymap::index::PersistentElementStore>(dataPath, stringTable_), isFiltered);
     }
 
-    // Preload elevation data. Not thread safe.
+    // Preload elevation data.
     void preloadElevation(const utymap::QuadKey& quadKey)
     {
         getElevationProvider(quadKey).preload(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey));
@@ -127,6 +202,45 @@ public:
         return geoStore_.hasData(quadKey);
     }
 
+    // Checks whether there is data for every quadkey.
+    void hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results)
+    {
+        geoStore_.hasData(quadKeys, results);
+    }
+
+    // Loads several quadkeys building them on workers as asynchronous requests, so
+    // they are prioritized and cancelled by camera. Meshes and elements of every
+    // quadkey are reported together, followed by completion callback with index of
+    // quadkey in given vector. Callbacks are called on different threads, but never
+    // concurrently. Blocks until all quadkeys are completed, so should not be
+    // called from callbacks. NOTE elements are still searched for every quadkey
+    // separately as quadkeys are built independently.
+    void loadQuadKeys(const char* styleFile,
+                      const std::vector<utymap::QuadKey>& quadKeys,
+                      OnMeshBuilt* meshCallback,
+                      OnElementLoaded* elementCallback,
+                      OnQuadKeyLoaded* completionCallback)
+    {
+        std::string stylePath = styleFile;
+        auto batch = std::make_shared<BatchRequest>(quadKeys.size());
+        // NOTE quadkeys are submitted in read order, so store reads stay close to each
+        // other unless camera prioritizes them differently.
+        for (std::size_t index : getReadOrder(quadKeys)) {
+            scheduleRequest(stylePath, quadKeys[index], nullptr, nullptr,
+                [=](int, const std::shared_ptr<const utymap::builders::MeshCache::TileData>& data, const char* errorMessage) {
+                std::lock_guard<std::mutex> lock(batch->lock);
+                if (data != nullptr)
+                    notify(*data, meshCallback, elementCallback);
+                completionCallback(static_cast<int>(index), errorMessage);
+                if (--batch->remaining == 0)
+                    batch->completed.notify_all();
+            });
+        }
+
+        std::unique_lock<std::mutex> lock(batch->lock);
+        batch->completed.wait(lock, [&batch]() { return batch->remaining == 0; });
+    }
+
     // Loads quadKey.
     void loadQuadKey(const char* styleFile, 
                      const utymap::QuadKey& quadKey, 
@@ -135,21 +249,76 @@ public:
                      OnError* errorCallback)
     {
         safeExecute([&]() {
-            auto styleProvider = getStyleProvider(styleFile);
-            ExportElementVisitor elementVisitor(stringTable_, *styleProvider, quadKey.levelOfDetail, elementCallback);
-            quadKeyBuilder_.build(quadKey, *styleProvider, getElevationProvider(quadKey),
-                [&meshCallback](const utymap::meshing::Mesh& mesh) {
-                // NOTE do not notify if mesh is empty.
-                if (!mesh.vertices.empty()) {
-                    meshCallback(mesh.name.data(),
-                        mesh.vertices.data(), static_cast<int>(mesh.vertices.size()),
-                        mesh.triangles.data(), static_cast<int>(mesh.triangles.size()),
-                        mesh.colors.data(), static_cast<int>(mesh.colors.size()));
-                }
-            }, [&elementVisitor](const utymap::entities::Element& element) {
-                element.accept(elementVisitor);
-            });
+            buildQuadKey(styleFile, quadKey, meshCallback, elementCallback, utymap::utils::CancellationToken::none());
         }, errorCallback);
+        prefetch(styleFile, quadKey);
+    }
+
+    // Loads quadKey on worker thread. Returns request id. Callbacks are called on
+    // worker thread, completion callback is called last with the same request id.
+    int loadQuadKeyAsync(const char* styleFile,
+                         const utymap::QuadKey& quadKey,
+                         OnMeshBuilt* meshCallback,
+                         OnElementLoaded* elementCallback,
+                         OnRequestCompleted* completionCallback)
+    {
+        std::string stylePath = styleFile;
+        int requestId = scheduleRequest(stylePath, quadKey, meshCallback, elementCallback,
+            [=](int requestId, const std::shared_ptr<const utymap::builders::MeshCache::TileData>&, const char* errorMessage) {
+            completionCallback(requestId, errorMessage);
+        });
+        prefetch(stylePath, quadKey);
+        return requestId;
+    }
+
+    // Enables building of quadkeys which are likely to be loaded next into
+    // mesh cache when workers have nothing else to do.
+    void setPrefetchEnabled(bool isEnabled)
+    {
+        isPrefetchEnabled_ = isEnabled;
+        if (!isEnabled)
+            dropBackground();
+    }
+
+    // Cancels asynchronous request. Its completion callback is called with error
+    // message, meshes and elements reported before should be discarded.
+    void cancelRequest(int requestId)
+    {
+        std::lock_guard<std::mutex> lock(requestLock_);
+        auto request = requests_.find(requestId);
+        if (request != requests_.end())
+            request->second.cancelToken->cancel();
+    }
+
+    // Updates camera used to prioritize asynchronous requests. Requests and
+    // prefetches which are being built for quadkeys out of view distance are cancelled.
+    void setCamera(const utymap::builders::QuadKeyScheduler::Camera& camera)
+    {
+        scheduler_.setCamera(camera);
+
+        std::lock_guard<std::mutex> lock(requestLock_);
+        for (const auto& pair : requests_) {
+            if (!scheduler_.isVisible(pair.second.quadKey))
+                pair.second.cancelToken->cancel();
+        }
+    }
+
+    // Sets amount of workers used by asynchronous requests. Waits for
+    // already queued requests if workers are running. Should not be called
+    // from callbacks as they are called on workers.
+    void setWorkerCount(int workerCount)
+    {
+        std::shared_ptr<utymap::utils::ThreadPool> workers;
+        {
+            std::lock_guard<std::mutex> lock(workerLock_);
+            workerCount_ = workerCount > 0 ? static_cast<std::size_t>(workerCount) : utymap::utils::getWorkerCount();
+            workers.swap(workers_);
+        }
+        // NOTE old workers are stopped without lock as queued requests enqueue new tasks.
+        // Waiting first ensures that they do not hold the last reference to themselves.
+        if (workers != nullptr)
+            workers->wait();
+        workers.reset();
     }
 
     // Gets id for the string.
@@ -171,6 +340,239 @@ private:
         }
     }
 
+    // Returns indices of quadkeys in order of their location in persistent
+    // stores: files are grouped by level of details and named by quadkey.
+    static std::vector<std::size_t> getReadOrder(const std::vector<utymap::QuadKey>& quadKeys)
+    {
+        std::vector<std::string> names;
+        names.reserve(quadKeys.size());
+        for (const auto& quadKey : quadKeys)
+            names.push_back(utymap::utils::GeoUtils::quadKeyToString(quadKey));
+
+        std::vector<std::size_t> order(quadKeys.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return quadKeys[lhs].levelOfDetail < quadKeys[rhs].levelOfDetail ||
+                  (quadKeys[lhs].levelOfDetail == quadKeys[rhs].levelOfDetail && names[lhs] < names[rhs]);
+        });
+        return order;
+    }
+
+    // Asynchronous request or prefetch which is queued or being built.
+    struct ActiveRequest
+    {
+        utymap::QuadKey quadKey;
+        std::shared_ptr<utymap::utils::CancellationToken> cancelToken;
+        bool isBackground;
+    };
+
+    // Several quadkeys loaded together.
+    struct BatchRequest
+    {
+        explicit BatchRequest(std::size_t count) : remaining(count)
+        {
+        }
+
+        std::size_t remaining;
+        std::mutex lock;
+        std::condition_variable completed;
+    };
+
+    // Called when request is completed with built data or error message. Data
+    // is nullptr if request failed, is cancelled or dropped.
+    typedef std::function<void(int, const std::shared_ptr<const utymap::builders::MeshCache::TileData>&, const char*)> RequestCallback;
+
+    // Adds request for quadkey to scheduler and lets worker process it. Returns request id.
+    int scheduleRequest(const std::string& stylePath,
+                        const utymap::QuadKey& quadKey,
+                        OnMeshBuilt* meshCallback,
+                        OnElementLoaded* elementCallback,
+                        const RequestCallback& completion)
+    {
+        int requestId = ++lastRequestId_;
+        auto cancelToken = std::make_shared<utymap::utils::CancellationToken>();
+        {
+            std::lock_guard<std::mutex> lock(requestLock_);
+            requests_[requestId] = ActiveRequest{ quadKey, cancelToken, false };
+        }
+
+        // NOTE scheduler calls drop task on thread which updates camera, so completion is
+        // reported on worker as for other requests. Rejected request is reported on worker
+        // too as caller gets its id only after return.
+        auto drop = [=]() {
+            getWorkers()->enqueue([=]() {
+                removeRequest(requestId);
+                completion(requestId, nullptr, "Request is dropped: quadkey is out of view distance.");
+            });
+        };
+        bool isScheduled = scheduler_.push(quadKey, [=]() {
+            std::string errorMessage;
+            std::shared_ptr<const utymap::builders::MeshCache::TileData> data;
+            try {
+                if (!cancelToken->isCancelled())
+                    data = buildQuadKey(stylePath, quadKey, meshCallback, elementCallback, *cancelToken);
+                if (cancelToken->isCancelled())
+                    errorMessage = "Request is cancelled.";
+            }
+            catch (std::exception& ex) {
+                errorMessage = ex.what();
+            }
+            removeRequest(requestId);
+            completion(requestId, data, errorMessage.empty() ? nullptr : errorMessage.c_str());
+        }, drop);
+
+        if (isScheduled)
+            processNext();
+        else
+            drop();
+        return requestId;
+    }
+
+    void removeRequest(int requestId)
+    {
+        std::lock_guard<std::mutex> lock(requestLock_);
+        requests_.erase(requestId);
+    }
+
+    // Builds quadkey or replays its meshes and elements from cache. Callbacks
+    // are optional. Returns built data or nullptr if build is cancelled: nothing
+    // is reported or cached once cancellation token is cancelled.
+    std::shared_ptr<const utymap::builders::MeshCache::TileData> buildQuadKey(const std::string& styleFile,
+                                                                               const utymap::QuadKey& quadKey,
+                                                                               OnMeshBuilt* meshCallback,
+                                                                               OnElementLoaded* elementCallback,
+                                                                               const utymap::utils::CancellationToken& cancelToken)
+    {
+        auto style = getStyle(styleFile);
+        auto styleProvider = style.provider;
+        auto meshCache = std::atomic_load(&meshCache_);
+        utymap::builders::MeshCache::Key key{ quadKey, style.getHash(quadKey.levelOfDetail),
+            quadKey.levelOfDetail <= SrtmElevationLodStart ? 0 : 1, geoStore_.getRevision() };
+
+        auto cached = meshCache->get(key);
+        if (cached != nullptr) {
+            notify(*cached, meshCallback, elementCallback);
+            return cached;
+        }
+
+        // NOTE elevation data is loaded before build as quadkey may be requested by prefetch or
+        // asynchronously without preloading it by client.
+        auto& eleProvider = getElevationProvider(quadKey);
+        eleProvider.preload(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey));
+
+        auto data = std::make_shared<utymap::builders::MeshCache::TileData>();
+        ExportElementVisitor elementVisitor(stringTable_, *styleProvider, quadKey.levelOfDetail, elementCallback, &data->elements);
+        quadKeyBuilder_.build(quadKey, *styleProvider, eleProvider,
+            [&](const utymap::meshing::Mesh& mesh) {
+            // NOTE do not notify if mesh is empty.
+            if (!mesh.vertices.empty() && !cancelToken.isCancelled()) {
+                notify(mesh, meshCallback);
+                auto copy = std::make_shared<utymap::meshing::Mesh>(mesh.name);
+                copy->vertices = mesh.vertices;
+                copy->triangles = mesh.triangles;
+                copy->colors = mesh.colors;
+                data->meshes.push_back(copy);
+            }
+        }, [&](const utymap::entities::Element& element, const utymap::mapcss::Style& style) {
+            if (!cancelToken.isCancelled())
+                elementVisitor.visit(element, style);
+        }, cancelToken);
+
+        if (cancelToken.isCancelled())
+            return nullptr;
+
+        meshCache->put(key, data);
+        return data;
+    }
+
+    static void notify(const utymap::builders::MeshCache::TileData& data,
+                       OnMeshBuilt* meshCallback,
+                       OnElementLoaded* elementCallback)
+    {
+        for (const auto& mesh : data.meshes)
+            notify(*mesh, meshCallback);
+        for (const auto& element : data.elements)
+            ExportElementVisitor::notify(element, elementCallback);
+    }
+
+    static void notify(const utymap::meshing::Mesh& mesh, OnMeshBuilt* meshCallback)
+    {
+        if (meshCallback == nullptr)
+            return;
+
+        meshCallback(mesh.name.data(),
+            mesh.vertices.data(), static_cast<int>(mesh.vertices.size()),
+            mesh.triangles.data(), static_cast<int>(mesh.triangles.size()),
+            mesh.colors.data(), static_cast<int>(mesh.colors.size()));
+    }
+
+    // Lets worker process the most important request which is not necessary the latest one.
+    void processNext()
+    {
+        getWorkers()->enqueue([this]() {
+            utymap::builders::QuadKeyScheduler::Task task;
+            if (scheduler_.pop(task))
+                task();
+        });
+    }
+
+    // Schedules building of predicted quadkeys in background replacing previous prediction.
+    void prefetch(const std::string& styleFile, const utymap::QuadKey& quadKey)
+    {
+        if (!isPrefetchEnabled_)
+            return;
+
+        dropBackground();
+        for (const auto& predicted : prefetcher_.predict(quadKey)) {
+            int requestId = ++lastRequestId_;
+            auto cancelToken = std::make_shared<utymap::utils::CancellationToken>();
+            {
+                std::lock_guard<std::mutex> lock(requestLock_);
+                requests_[requestId] = ActiveRequest{ predicted, cancelToken, true };
+            }
+
+            bool isScheduled = scheduler_.push(predicted, [=]() {
+                try {
+                    // NOTE built quadkey is kept only in mesh cache.
+                    if (!cancelToken->isCancelled() && hasData(predicted))
+                        buildQuadKey(styleFile, predicted, nullptr, nullptr, *cancelToken);
+                }
+                catch (std::exception&) {
+                    // NOTE errors are reported when quadkey is actually requested.
+                }
+                removeRequest(requestId);
+            }, [=]() { removeRequest(requestId); }, true);
+
+            if (isScheduled)
+                processNext();
+            else
+                removeRequest(requestId);
+        }
+    }
+
+    // Drops queued prefetches and cancels ones which are being built.
+    void dropBackground()
+    {
+        scheduler_.dropBackground();
+
+        std::lock_guard<std::mutex> lock(requestLock_);
+        for (const auto& pair : requests_) {
+            if (pair.second.isBackground)
+                pair.second.cancelToken->cancel();
+        }
+    }
+
+    // Creates workers on first use. Returned pointer keeps workers alive
+    // even if they are replaced concurrently.
+    std::shared_ptr<utymap::utils::ThreadPool> getWorkers()
+    {
+        std::lock_guard<std::mutex> lock(workerLock_);
+        if (workers_ == nullptr)
+            workers_ = std::make_shared<utymap::utils::ThreadPool>(workerCount_);
+        return workers_;
+    }
+
     utymap::heightmap::ElevationProvider& getElevationProvider(const utymap::QuadKey& quadKey)
     {
         return quadKey.levelOfDetail <= SrtmElevationLodStart
@@ -178,12 +580,53 @@ private:
             : (utymap::heightmap::ElevationProvider&) srtmEleProvider_;
     }
 
+    // Style provider with hashes of its rules, taken together so they match each other.
+    struct StyleInfo
+    {
+        std::shared_ptr<utymap::mapcss::StyleProvider> provider;
+        std::vector<std::uint64_t> lodHashes;
+
+        std::uint64_t getHash(int levelOfDetail) const
+        {
+            return levelOfDetail >= 0 && levelOfDetail < static_cast<int>(lodHashes.size()) ? lodHashes[levelOfDetail] : 0;
+        }
+    };
+
+    StyleInfo getStyle(const std::string& filePath)
+    {
+        std::lock_guard<std::mutex> lock(styleLock_);
+        auto styleProvider = findStyleProvider(filePath);
+        return StyleInfo{ styleProvider, styleHashes_[filePath] };
+    }
+
     std::shared_ptr<utymap::mapcss::StyleProvider> getStyleProvider(const std::string& filePath)
+    {
+        std::lock_guard<std::mutex> lock(styleLock_);
+        return findStyleProvider(filePath);
+    }
+
+    // Finds style provider or creates it if it is not loaded yet. Should be called under style lock.
+    std::shared_ptr<utymap::mapcss::StyleProvider> findStyleProvider(const std::string& filePath)
     {
         auto pair = styleProviders_.find(filePath);
         if (pair != styleProviders_.end())
             return pair->second;
 
+        // NOTE use precompiled stylesheet if mapcss files are not changed since last run.
+        utymap::mapcss::StyleSheet stylesheet;
+        utymap::mapcss::StyleProvider::Gradients gradients;
+        std::string binaryPath = getBinaryStyleSheetPath(filePath);
+        if (!binaryPath.empty() && utymap::mapcss::BinaryStyleSheet::read(binaryPath, filePath, stylesheet, gradients)) {
+            setStyleSheet(filePath, stylesheet);
+            styleProviders_[filePath] = std::make_shared<utymap::mapcss::StyleProvider>(stylesheet, stringTable_, gradients);
+            return styleProviders_[filePath];
+        }
+
+        return createStyleProvider(filePath, parseStyleSheet(filePath), gradients);
+    }
+
+    utymap::mapcss::StyleSheet parseStyleSheet(const std::string& filePath)
+    {
         std::ifstream styleFile(filePath);
         if (!styleFile.good())
             throw std::invalid_argument(std::string("Cannot read mapcss file:") + filePath);
@@ -191,9 +634,42 @@ private:
         // NOTE not safe, but don't want to use boost filesystem only for this task.
         std::string dir = filePath.substr(0, filePath.find_last_of("\\/") + 1);
         utymap::mapcss::MapCssParser parser(dir);
-        utymap::mapcss::StyleSheet stylesheet = parser.parse(styleFile);
-        styleProviders_[filePath] = std::make_shared<utymap::mapcss::StyleProvider>(stylesheet, stringTable_);
-        return styleProviders_[filePath];
+        return parser.parse(styleFile);
+    }
+
+    std::shared_ptr<utymap::mapcss::StyleProvider> createStyleProvider(const std::string& filePath,
+                                                                       const utymap::mapcss::StyleSheet& stylesheet,
+                                                                       const utymap::mapcss::StyleProvider::Gradients& gradients)
+    {
+        auto styleProvider = std::make_shared<utymap::mapcss::StyleProvider>(stylesheet, stringTable_, gradients);
+        // NOTE it is fine if cache directory is read only.
+        std::string binaryPath = getBinaryStyleSheetPath(filePath);
+        if (!binaryPath.empty())
+            utymap::mapcss::BinaryStyleSheet::write(binaryPath, filePath, stylesheet, styleProvider->getGradients());
+        setStyleSheet(filePath, stylesheet);
+        styleProviders_[filePath] = styleProvider;
+        return styleProvider;
+    }
+
+    // Returns path of compiled stylesheet in cache directory or empty string if
+    // there is no cache directory. Should be called under style lock.
+    std::string getBinaryStyleSheetPath(const std::string& filePath) const
+    {
+        // NOTE binary file keeps source path, so hash collision is detected on read.
+        return cacheDirectory_.empty()
+            ? ""
+            : cacheDirectory_ + std::to_string(std::hash<std::string>()(filePath)) + BinaryStyleSheetExtension;
+    }
+
+    void setStyleSheet(const std::string& filePath, const utymap::mapcss::StyleSheet& stylesheet)
+    {
+        styleSheets_[filePath] = stylesheet;
+        // NOTE include path as different stylesheets may have the same rules for some lods.
+        std::vector<std::uint64_t> hashes = utymap::mapcss::StyleSheetDiff::getLodHashes(stylesheet);
+        std::uint64_t pathHash = std::hash<std::string>()(filePath);
+        for (auto& hash : hashes)
+            hash ^= pathHash;
+        styleHashes_[filePath] = hashes;
     }
 
     void registerDefaultBuilders()
@@ -222,6 +698,23 @@ private:
 
     utymap::builders::QuadKeyBuilder quadKeyBuilder_;
     std::unordered_map<std::string, std::shared_ptr<utymap::mapcss::StyleProvider>> styleProviders_;
+    std::unordered_map<std::string, utymap::mapcss::StyleSheet> styleSheets_;
+    std::unordered_map<std::string, std::vector<std::uint64_t>> styleHashes_;
+    std::string cacheDirectory_;
+    std::mutex styleLock_;
+
+    std::shared_ptr<utymap::builders::MeshCache> meshCache_;
+
+    utymap::builders::QuadKeyScheduler scheduler_;
+    utymap::builders::QuadKeyPrefetcher prefetcher_;
+    std::atomic<bool> isPrefetchEnabled_;
+    std::unordered_map<int, ActiveRequest> requests_;
+    std::mutex requestLock_;
+    std::atomic<int> lastRequestId_;
+    std::size_t workerCount_;
+    std::mutex workerLock_;
+    // NOTE declared last to complete requests before other members are destroyed.
+    std::shared_ptr<utymap::utils::ThreadPool> workers_;
 };
 
 #endif // APPLICATION_HPP_DEFINED
@@ -14,6 +14,18 @@ typedef void OnElementLoaded(std::uint64_t id, const char** tags, int tagsSize,
                              const double* vertices, int vertexSize,
                              const char** style, int styleSize);
 
+// Called when stylesheet is reloaded: reports levels of details and selectors
+// affected by changes.
+typedef void OnStyleChanged(const int* levelOfDetails, int lodSize,
+                            const char** selectors, int selectorSize);
+
+// Called when asynchronous request is completed. Error message is null on success.
+typedef void OnRequestCompleted(int requestId, const char* errorMessage);
+
+// Called when quadkey of batch is loaded: reports index of quadkey in the batch.
+// Error message is null on success.
+typedef void OnQuadKeyLoaded(int quadKeyIndex, const char* errorMessage);
+
 // Called when operation is completed.
 typedef void OnError(const char* errorMessage);
 
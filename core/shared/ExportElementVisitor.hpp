@@ -5,6 +5,7 @@
 #include "Callbacks.hpp"
 #include "GeoCoordinate.hpp"
 #include "QuadKey.hpp"
+#include "builders/MeshCache.hpp"
 #include "entities/Element.hpp"
 #include "entities/Node.hpp"
 #include "entities/Area.hpp"
@@ -21,14 +22,49 @@ struct ExportElementVisitor : public utymap::entities::ElementVisitor
     using Tags = std::vector<utymap::formats::Tag>;
     using Coordinates = std::vector<utymap::GeoCoordinate>;
 
+    // Exported elements are also added to given list if it is specified.
     ExportElementVisitor(utymap::index::StringTable& stringTable,
                         utymap::mapcss::StyleProvider& styleProvider,
                         int levelOfDetail,
-                        OnElementLoaded* elementCallback) :
-    stringTable_(stringTable), styleProvider_(styleProvider), levelOfDetail_(levelOfDetail), elementCallback_(elementCallback)
+                        OnElementLoaded* elementCallback,
+                        std::vector<utymap::builders::MeshCache::ElementData>* exported = nullptr) :
+    stringTable_(stringTable), styleProvider_(styleProvider), levelOfDetail_(levelOfDetail), elementCallback_(elementCallback),
+    exported_(exported), element_(nullptr), style_(nullptr)
     {
     }
 
+    // Passes exported element to element callback.
+    static void notify(const utymap::builders::MeshCache::ElementData& data, OnElementLoaded* elementCallback)
+    {
+        if (elementCallback == nullptr)
+            return;
+
+        std::vector<const char*> ctags;
+        ctags.reserve(data.tags.size());
+        for (const auto& str : data.tags)
+            ctags.push_back(str.c_str());
+
+        std::vector<const char*> cstyles;
+        cstyles.reserve(data.style.size());
+        for (const auto& str : data.style)
+            cstyles.push_back(str.c_str());
+
+        elementCallback(data.id,
+            ctags.data(), static_cast<int>(ctags.size()),
+            data.vertices.data(), static_cast<int>(data.vertices.size()),
+            cstyles.data(), static_cast<int>(cstyles.size()));
+    }
+
+    // Exports element using style which is already calculated for it.
+    void visit(const utymap::entities::Element& element, const utymap::mapcss::Style& style)
+    {
+        element_ = &element;
+        style_ = &style;
+        element.accept(*this);
+        element_ = nullptr;
+        style_ = nullptr;
+    }
+
     void visitNode(const utymap::entities::Node& node)
     {
         visitElement(node, Coordinates{ node.coordinate });
@@ -52,52 +88,42 @@ private:
 
     void visitElement(const utymap::entities::Element& element, const Coordinates& coordinates)
     {
+        utymap::builders::MeshCache::ElementData data;
+        data.id = element.id;
         // convert tags
-        std::vector<const char*> ctags;
-        tagStrings_.reserve(element.tags.size() * 2);
-        ctags.reserve(element.tags.size() * 2);
-        for (std::size_t i = 0; i < element.tags.size(); ++i) {
-            const utymap::entities::Tag& tag = element.tags[i];
-            tagStrings_.push_back(stringTable_.getString(tag.key));
-            tagStrings_.push_back(stringTable_.getString(tag.value));
-            ctags.push_back(tagStrings_[tagStrings_.size() - 2].c_str());
-            ctags.push_back(tagStrings_[tagStrings_.size() - 1].c_str());
+        data.tags.reserve(element.tags.size() * 2);
+        for (const auto& tag : element.tags) {
+            data.tags.push_back(stringTable_.getString(tag.key));
+            data.tags.push_back(stringTable_.getString(tag.value));
         }
         // convert geometry
-        std::vector<double> coords;
-        coords.reserve(coordinates.size() * 2);
-        for (std::size_t i = 0; i < coordinates.size(); ++i) {
-            const utymap::GeoCoordinate coordinate = coordinates[i];
-            coords.push_back(coordinate.longitude);
-            coords.push_back(coordinate.latitude);
+        data.vertices.reserve(coordinates.size() * 2);
+        for (const auto& coordinate : coordinates) {
+            data.vertices.push_back(coordinate.longitude);
+            data.vertices.push_back(coordinate.latitude);
         }
         // convert style
-        utymap::mapcss::Style style = styleProvider_.forElement(element, levelOfDetail_);
-        std::vector<const char*> cstyles;
-        styleStrings_.reserve(style.declarations.size() * 2);
-        cstyles.reserve(style.declarations.size());
-        for (const auto pair : style.declarations) {
-            styleStrings_.push_back(stringTable_.getString(pair.first));
-            styleStrings_.push_back(*pair.second->value());
-            cstyles.push_back(styleStrings_[styleStrings_.size() - 2].c_str());
-            cstyles.push_back(styleStrings_[styleStrings_.size() - 1].c_str());
+        utymap::mapcss::Style style = &element == element_
+            ? *style_
+            : styleProvider_.forElement(element, levelOfDetail_);
+        data.style.reserve(style.declarations().size() * 2);
+        for (const auto& declaration : style.declarations()) {
+            data.style.push_back(stringTable_.getString(declaration->key()));
+            data.style.push_back(declaration->value());
         }
 
-        elementCallback_(element.id,
-            ctags.data(), static_cast<int>(ctags.size()),
-            coords.data(), static_cast<int>(coords.size()),
-            cstyles.data(), static_cast<int>(cstyles.size()));
+        notify(data, elementCallback_);
 
-        // NOTE clear vectors after raw array data is consumed by external code
-        tagStrings_.clear();
-        styleStrings_.clear();
+        if (exported_ != nullptr)
+            exported_->push_back(std::move(data));
     }
     utymap::index::StringTable& stringTable_;
     utymap::mapcss::StyleProvider& styleProvider_;
     int levelOfDetail_;
     OnElementLoaded* elementCallback_;
-    std::vector<std::string> tagStrings_;   // holds temporary tag strings
-    std::vector<std::string> styleStrings_; // holds temporary style strings
+    std::vector<utymap::builders::MeshCache::ElementData>* exported_;
+    const utymap::entities::Element* element_;
+    const utymap::mapcss::Style* style_;
 };
 
 #endif // EXPORTELEMENTVISITOR_HPP_DEFINED
@@ -10,6 +10,16 @@
 
 static Application* applicationPtr = nullptr;
 
+// Converts array of tileX, tileY, levelOfDetail triples to quadkeys.
+static std::vector<utymap::QuadKey> toQuadKeys(const int* quadKeys, int quadKeyCount)
+{
+    std::vector<utymap::QuadKey> result;
+    result.reserve(static_cast<std::size_t>(quadKeyCount));
+    for (int i = 0; i < quadKeyCount; ++i)
+        result.push_back(utymap::QuadKey(quadKeys[i * 3 + 2], quadKeys[i * 3], quadKeys[i * 3 + 1]));
+    return result;
+}
+
 extern "C"
 {
     // Composes object graph.
@@ -32,6 +42,14 @@ extern "C"
         applicationPtr->registerStylesheet(path);
     }
 
+    // Reloads stylesheet and reports changes.
+    void EXPORT_API reloadStylesheet(const char* path,                 // path to stylesheet
+                                     OnStyleChanged* changeCallback,   // change callback
+                                     OnError* errorCallback)           // completion callback
+    {
+        applicationPtr->reloadStylesheet(path, changeCallback, errorCallback);
+    }
+
     // Preloads elevation data.
     void EXPORT_API preloadElevation(int tileX,        // tile x
                                      int tileY,        // tile y
@@ -40,16 +58,27 @@ extern "C"
         applicationPtr->preloadElevation(utymap::QuadKey(levelOfDetail, tileX, tileY));
     }
 
+    // Configures cache of built quadkeys and compiled stylesheets. Should be called
+    // before stylesheets are registered to use compiled ones.
+    void EXPORT_API configureMeshCache(const char* directory, // cache directory, empty to keep only in memory
+                                       int memorySize)        // memory limit in bytes
+    {
+        applicationPtr->configureMeshCache(directory, memorySize);
+    }
+
     // Registers new in-memory store.
-    void EXPORT_API registerInMemoryStore(const char* key)
+    void EXPORT_API registerInMemoryStore(const char* key,   // store key
+                                          bool isFiltered)   // keep only elements and tags used by stylesheet
     {
-        applicationPtr->registerInMemoryStore(key);
+        applicationPtr->registerInMemoryStore(key, isFiltered);
     }
 
     // Registers new persistent store.
-    void EXPORT_API registerPersistentStore(const char* key, const char* dataPath)
+    void EXPORT_API registerPersistentStore(const char* key,      // store key
+                                            const char* dataPath, // path to store data
+                                            bool isFiltered)      // keep only elements and tags used by stylesheet
     {
-        applicationPtr->registerPersistentStore(key, dataPath);
+        applicationPtr->registerPersistentStore(key, dataPath, isFiltered);
     }
 
     // Adds data to store to specific level of details range.
@@ -156,9 +185,69 @@ extern "C"
         applicationPtr->loadQuadKey(styleFile, quadKey, meshCallback, elementCallback, errorCallback);
     }
 
+    // Loads quadkey on worker thread and returns request id.
+    int EXPORT_API loadQuadKeyAsync(const char* styleFile,                    // style file
+                                    int tileX, int tileY, int levelOfDetail,  // quadkey info
+                                    OnMeshBuilt* meshCallback,                // mesh callback
+                                    OnElementLoaded* elementCallback,         // element callback
+                                    OnRequestCompleted* completionCallback)   // completion callback
+    {
+        utymap::QuadKey quadKey(levelOfDetail, tileX, tileY);
+        return applicationPtr->loadQuadKeyAsync(styleFile, quadKey, meshCallback, elementCallback, completionCallback);
+    }
+
+    // Cancels asynchronous loading of quadkey. Completion callback is still called.
+    void EXPORT_API cancelRequest(int requestId)
+    {
+        applicationPtr->cancelRequest(requestId);
+    }
+
+    // Sets camera used to prioritize asynchronous loading.
+    void EXPORT_API setCamera(double latitude, double longitude, // camera position on the ground
+                              double heading,                    // view direction in degrees from north
+                              double fieldOfView,                // horizontal field of view in degrees
+                              double viewDistance)               // max distance to tile in meters
+    {
+        applicationPtr->setCamera(utymap::builders::QuadKeyScheduler::Camera {
+            utymap::GeoCoordinate(latitude, longitude), heading, fieldOfView, viewDistance });
+    }
+
+    // Enables building of quadkeys which are likely to be loaded next.
+    void EXPORT_API setPrefetchEnabled(bool isEnabled)
+    {
+        applicationPtr->setPrefetchEnabled(isEnabled);
+    }
+
+    // Sets amount of worker threads used by asynchronous loading.
+    void EXPORT_API setWorkerCount(int workerCount)
+    {
+        applicationPtr->setWorkerCount(workerCount);
+    }
+
     // Checks whether there is data for given quadkey
     bool EXPORT_API hasData(int tileX, int tileY, int levelOfDetail) // quadkey info
     {
         return applicationPtr->hasData(utymap::QuadKey(levelOfDetail, tileX, tileY));
     }
+
+    // Checks whether there is data for every given quadkey.
+    void EXPORT_API hasDataBatch(const int* quadKeys, // tileX, tileY, levelOfDetail of every quadkey
+                                 int quadKeyCount,    // amount of quadkeys
+                                 bool* results)       // result for every quadkey
+    {
+        applicationPtr->hasData(toQuadKeys(quadKeys, quadKeyCount), results);
+    }
+
+    // Loads several quadkeys on workers and returns when all of them are completed.
+    // Completion callback gets index of quadkey after all its meshes and elements are reported.
+    void EXPORT_API loadQuadKeys(const char* styleFile,                    // style file
+                                 const int* quadKeys,                      // tileX, tileY, levelOfDetail of every quadkey
+                                 int quadKeyCount,                         // amount of quadkeys
+                                 OnMeshBuilt* meshCallback,                // mesh callback
+                                 OnElementLoaded* elementCallback,         // element callback
+                                 OnQuadKeyLoaded* completionCallback)      // completion callback
+    {
+        applicationPtr->loadQuadKeys(styleFile, toQuadKeys(quadKeys, quadKeyCount),
+                                     meshCallback, elementCallback, completionCallback);
+    }
 }
@@ -27,6 +27,17 @@ struct QuadKey
         return levelOfDetail == other.levelOfDetail &&
                tileX == other.tileX && tileY == other.tileY;
     }
+
+    // Orders quadkeys by level of details, tile x and tile y.
+    bool operator<(const QuadKey& other) const
+    {
+        if (levelOfDetail == other.levelOfDetail) {
+            if (tileX == other.tileX)
+                return tileY < other.tileY;
+            return tileX < other.tileX;
+        }
+        return levelOfDetail < other.levelOfDetail;
+    }
 };
 
 }
@@ -7,6 +7,7 @@
 #include "mapcss/StyleProvider.hpp"
 #include "meshing/MeshBuilder.hpp"
 #include "meshing/MeshTypes.hpp"
+#include "utils/CancellationToken.hpp"
 #include "utils/GeoUtils.hpp"
 
 #include <functional>
@@ -30,25 +31,29 @@ struct BuilderContext
     const utymap::heightmap::ElevationProvider& eleProvider;
     // Mesh callback should be called once mesh is constructed.
     std::function<void(const utymap::meshing::Mesh&)> meshCallback;
-    // Element callback is called to process original element by external logic.
-    std::function<void(const utymap::entities::Element&)> elementCallback;
+    // Element callback is called to process original element with its style by external logic.
+    std::function<void(const utymap::entities::Element&, const utymap::mapcss::Style&)> elementCallback;
     // Mesh builder.
     const utymap::meshing::MeshBuilder meshBuilder;
+    // Builders should stop as soon as possible once it is cancelled.
+    const utymap::utils::CancellationToken& cancelToken;
 
     BuilderContext(const utymap::QuadKey& quadKey,
                    const utymap::mapcss::StyleProvider& styleProvider,
                    utymap::index::StringTable& stringTable,
                    const utymap::heightmap::ElevationProvider& eleProvider,
                    std::function<void(const utymap::meshing::Mesh&)> meshCallback,
-                   std::function<void(const utymap::entities::Element&)> elementCallback) :
+                   std::function<void(const utymap::entities::Element&, const utymap::mapcss::Style&)> elementCallback,
+                   const utymap::utils::CancellationToken& cancelToken = utymap::utils::CancellationToken::none()) :
         quadKey(quadKey),
         boundingBox(utymap::utils::GeoUtils::quadKeyToBoundingBox(quadKey)),
         styleProvider(styleProvider),
         stringTable(stringTable),
         eleProvider(eleProvider),
-        meshBuilder(eleProvider),
+        meshBuilder(eleProvider, cancelToken),
         meshCallback(meshCallback),
-        elementCallback(elementCallback)
+        elementCallback(elementCallback),
+        cancelToken(cancelToken)
     {
     }
 };
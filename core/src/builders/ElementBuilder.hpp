@@ -2,7 +2,9 @@
 #define BUILDERS_ELEMENTBUILDER_HPP_DEFINED
 
 #include "builders/BuilderContext.hpp"
+#include "entities/Element.hpp"
 #include "entities/ElementVisitor.hpp"
+#include "mapcss/Style.hpp"
 
 namespace utymap { namespace builders {
 
@@ -11,15 +13,43 @@ class ElementBuilder : public utymap::entities::ElementVisitor
 {
 public:
     ElementBuilder(const utymap::builders::BuilderContext& context) :
-        context_(context)
+        context_(context), element_(nullptr), style_(nullptr)
     {
     }
 
+    // Builds element using style which is already calculated for it. Builder may
+    // defer building till complete, so element should be alive until then.
+    void build(const utymap::entities::Element& element, const utymap::mapcss::Style& style)
+    {
+        const utymap::entities::Element* lastElement = element_;
+        const utymap::mapcss::Style* lastStyle = style_;
+
+        element_ = &element;
+        style_ = &style;
+        element.accept(*this);
+
+        element_ = lastElement;
+        style_ = lastStyle;
+    }
+
     // Called when all objects for the corresponding quadkey are processed.
     virtual void complete() = 0;
 
 protected:
+    // Returns style passed to build for given element or calculates it for
+    // element visited in other way, e.g. for member of relation.
+    utymap::mapcss::Style getStyle(const utymap::entities::Element& element) const
+    {
+        return &element == element_
+            ? *style_
+            : context_.styleProvider.forElement(element, context_.quadKey.levelOfDetail);
+    }
+
     const utymap::builders::BuilderContext& context_;
+
+private:
+    const utymap::entities::Element* element_;
+    const utymap::mapcss::Style* style_;
 };
 
 }}
@@ -19,13 +19,13 @@ public:
     {
     }
 
-    void visitNode(const utymap::entities::Node& node) { context_.elementCallback(node); }
+    void visitNode(const utymap::entities::Node& node) { context_.elementCallback(node, getStyle(node)); }
 
-    void visitWay(const utymap::entities::Way& way) { context_.elementCallback(way); }
+    void visitWay(const utymap::entities::Way& way) { context_.elementCallback(way, getStyle(way)); }
 
-    void visitArea(const utymap::entities::Area& area) { context_.elementCallback(area); }
+    void visitArea(const utymap::entities::Area& area) { context_.elementCallback(area, getStyle(area)); }
 
-    void visitRelation(const utymap::entities::Relation& relation) { context_.elementCallback(relation); }
+    void visitRelation(const utymap::entities::Relation& relation) { context_.elementCallback(relation, getStyle(relation)); }
 
     void complete() { }
 };
@@ -0,0 +1,384 @@
+#include "builders/MeshCache.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::meshing;
+using namespace utymap::utils;
+
+namespace {
+    const std::uint32_t Signature = 0x434d4d55; // UMMC
+    const std::uint32_t Version = 1;
+    const std::string FileExtension = ".mesh";
+
+    template <typename T>
+    std::size_t getSize(const std::vector<T>& data)
+    {
+        return data.size() * sizeof(T);
+    }
+
+    std::size_t getSize(const std::vector<std::string>& data)
+    {
+        std::size_t size = 0;
+        for (const auto& str : data)
+            size += sizeof(str) + str.size();
+        return size;
+    }
+
+    // Estimates amount of memory used by tile data.
+    std::size_t getSize(const MeshCache::TileData& data)
+    {
+        std::size_t size = sizeof(data);
+        for (const auto& mesh : data.meshes)
+            size += sizeof(*mesh) + mesh->name.size() +
+                    getSize(mesh->vertices) + getSize(mesh->triangles) + getSize(mesh->colors);
+        for (const auto& element : data.elements)
+            size += sizeof(element) + getSize(element.tags) + getSize(element.vertices) + getSize(element.style);
+        return size;
+    }
+
+    class Writer
+    {
+    public:
+        Writer(std::ofstream& file) : file_(file) {}
+
+        template <typename T>
+        void write(const T& value)
+        {
+            file_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void write(const std::string& str)
+        {
+            write(static_cast<std::uint32_t>(str.size()));
+            file_.write(str.data(), str.size());
+        }
+
+        template <typename T>
+        void write(const std::vector<T>& data)
+        {
+            write(static_cast<std::uint32_t>(data.size()));
+            file_.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+        }
+
+        void write(const std::vector<std::string>& data)
+        {
+            write(static_cast<std::uint32_t>(data.size()));
+            for (const auto& str : data)
+                write(str);
+        }
+
+        void write(const MeshCache::Key& key)
+        {
+            write(key.quadKey.levelOfDetail);
+            write(key.quadKey.tileX);
+            write(key.quadKey.tileY);
+            write(key.styleHash);
+            write(key.elevationMode);
+            write(key.dataVersion);
+        }
+
+    private:
+        std::ofstream& file_;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(std::ifstream& file, std::uint64_t remaining) : file_(file), remaining_(remaining) {}
+
+        bool good() const { return file_.good(); }
+
+        template <typename T>
+        void read(T& value)
+        {
+            file_.read(reinterpret_cast<char*>(&value), sizeof(value));
+        }
+
+        void read(std::string& str)
+        {
+            str.resize(readSize(1));
+            if (!str.empty())
+                file_.read(&str[0], str.size());
+        }
+
+        template <typename T>
+        void read(std::vector<T>& data)
+        {
+            data.resize(readSize(sizeof(T)));
+            if (!data.empty())
+                file_.read(reinterpret_cast<char*>(data.data()), data.size() * sizeof(T));
+        }
+
+        void read(std::vector<std::string>& data)
+        {
+            data.resize(readSize(sizeof(std::uint32_t)));
+            for (auto& str : data)
+                read(str);
+        }
+
+        void read(MeshCache::Key& key)
+        {
+            read(key.quadKey.levelOfDetail);
+            read(key.quadKey.tileX);
+            read(key.quadKey.tileY);
+            read(key.styleHash);
+            read(key.elevationMode);
+            read(key.dataVersion);
+        }
+
+        // Reads size of collection and fails stream if it exceeds file size.
+        std::uint32_t readSize(std::size_t itemSize)
+        {
+            std::uint32_t size = 0;
+            read(size);
+            if (!file_.good() || size * static_cast<std::uint64_t>(itemSize) > remaining_)
+                file_.setstate(std::ios::failbit);
+            return file_.good() ? size : 0;
+        }
+
+    private:
+        std::ifstream& file_;
+        std::uint64_t remaining_;
+    };
+
+    inline bool operator==(const MeshCache::Key& lhs, const MeshCache::Key& rhs)
+    {
+        return lhs.quadKey == rhs.quadKey && lhs.styleHash == rhs.styleHash &&
+               lhs.elevationMode == rhs.elevationMode && lhs.dataVersion == rhs.dataVersion;
+    }
+}
+
+class MeshCache::MeshCacheImpl
+{
+    struct Entry
+    {
+        std::string id;
+        std::uint32_t lodBit;
+        std::shared_ptr<const TileData> data;
+        std::size_t size;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+public:
+    MeshCacheImpl(const std::string& directory, std::size_t memoryLimit) :
+        directory_(directory), memoryLimit_(memoryLimit), memorySize_(0), entries_(), entryMap_()
+    {
+    }
+
+    std::shared_ptr<const TileData> get(const Key& key)
+    {
+        std::string id = getId(key);
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            auto it = entryMap_.find(id);
+            if (it != entryMap_.end()) {
+                // NOTE move to front as the most recently used.
+                entries_.splice(entries_.begin(), entries_, it->second);
+                return it->second->data;
+            }
+        }
+
+        auto data = readFile(key);
+        if (data != nullptr)
+            putMemory(key, data);
+        return data;
+    }
+
+    void put(const Key& key, const std::shared_ptr<const TileData>& data)
+    {
+        putMemory(key, data);
+        writeFile(key, *data);
+    }
+
+    void invalidate(std::uint32_t lodMask)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            if ((it->lodBit & lodMask) != 0)
+                it = erase(it);
+            else
+                ++it;
+        }
+    }
+
+private:
+
+    void putMemory(const Key& key, const std::shared_ptr<const TileData>& data)
+    {
+        std::string id = getId(key);
+        std::size_t size = getSize(*data);
+
+        std::lock_guard<std::mutex> lock(lock_);
+        auto existing = entryMap_.find(id);
+        if (existing != entryMap_.end())
+            erase(existing->second);
+
+        if (size > memoryLimit_)
+            return;
+
+        std::uint32_t lodBit = key.quadKey.levelOfDetail < 32 ? 1u << key.quadKey.levelOfDetail : 0;
+        entries_.push_front(Entry{ id, lodBit, data, size });
+        entryMap_[id] = entries_.begin();
+        memorySize_ += size;
+
+        while (memorySize_ > memoryLimit_)
+            erase(std::prev(entries_.end()));
+    }
+
+    EntryList::iterator erase(EntryList::iterator it)
+    {
+        memorySize_ -= it->size;
+        entryMap_.erase(it->id);
+        return entries_.erase(it);
+    }
+
+    std::shared_ptr<const TileData> readFile(const Key& key) const
+    {
+        if (directory_.empty())
+            return nullptr;
+
+        std::ifstream file(getFilePath(key.quadKey), std::ios::in | std::ios::binary | std::ios::ate);
+        if (!file.good())
+            return nullptr;
+
+        Reader reader(file, static_cast<std::uint64_t>(file.tellg()));
+        file.seekg(0);
+
+        std::uint32_t signature = 0, version = 0;
+        Key fileKey;
+        reader.read(signature);
+        reader.read(version);
+        reader.read(fileKey);
+        // NOTE file keeps the last built version of quadkey.
+        if (!reader.good() || signature != Signature || version != Version || !(fileKey == key))
+            return nullptr;
+
+        auto data = std::make_shared<TileData>();
+        data->meshes.resize(reader.readSize(sizeof(std::uint32_t)));
+        for (auto& mesh : data->meshes) {
+            std::string name;
+            reader.read(name);
+            auto result = std::make_shared<Mesh>(name);
+            reader.read(result->vertices);
+            reader.read(result->triangles);
+            reader.read(result->colors);
+            mesh = result;
+        }
+
+        data->elements.resize(reader.readSize(sizeof(std::uint64_t)));
+        for (auto& element : data->elements) {
+            reader.read(element.id);
+            reader.read(element.tags);
+            reader.read(element.vertices);
+            reader.read(element.style);
+        }
+
+        return reader.good() ? data : nullptr;
+    }
+
+    void writeFile(const Key& key, const TileData& data) const
+    {
+        if (directory_.empty())
+            return;
+
+        // NOTE write to temporary file first, so readers never see partially written data.
+        std::string path = getFilePath(key.quadKey);
+        std::stringstream ss;
+        ss << path << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+        std::string tempPath = ss.str();
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.good())
+                return;
+
+            Writer writer(file);
+            writer.write(Signature);
+            writer.write(Version);
+            writer.write(key);
+
+            writer.write(static_cast<std::uint32_t>(data.meshes.size()));
+            for (const auto& mesh : data.meshes) {
+                writer.write(mesh->name);
+                writer.write(mesh->vertices);
+                writer.write(mesh->triangles);
+                writer.write(mesh->colors);
+            }
+
+            writer.write(static_cast<std::uint32_t>(data.elements.size()));
+            for (const auto& element : data.elements) {
+                writer.write(element.id);
+                writer.write(element.tags);
+                writer.write(element.vertices);
+                writer.write(element.style);
+            }
+
+            if (!file.good()) {
+                file.close();
+                std::remove(tempPath.c_str());
+                return;
+            }
+        }
+
+        std::remove(path.c_str());
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0)
+            std::remove(tempPath.c_str());
+    }
+
+    std::string getFilePath(const QuadKey& quadKey) const
+    {
+        std::stringstream ss;
+        ss << directory_ << quadKey.levelOfDetail << "_" << GeoUtils::quadKeyToString(quadKey) << FileExtension;
+        return ss.str();
+    }
+
+    static std::string getId(const Key& key)
+    {
+        std::stringstream ss;
+        ss << key.quadKey.levelOfDetail << "/" << key.quadKey.tileX << "/" << key.quadKey.tileY << "/"
+           << key.styleHash << "/" << key.elevationMode << "/" << key.dataVersion;
+        return ss.str();
+    }
+
+    const std::string directory_;
+    const std::size_t memoryLimit_;
+    std::size_t memorySize_;
+    EntryList entries_;
+    std::unordered_map<std::string, EntryList::iterator> entryMap_;
+    std::mutex lock_;
+};
+
+MeshCache::MeshCache(const std::string& directory, std::size_t memoryLimit) :
+    pimpl_(new MeshCache::MeshCacheImpl(directory, memoryLimit))
+{
+}
+
+MeshCache::~MeshCache()
+{
+}
+
+std::shared_ptr<const MeshCache::TileData> MeshCache::get(const Key& key)
+{
+    return pimpl_->get(key);
+}
+
+void MeshCache::put(const Key& key, const std::shared_ptr<const TileData>& data)
+{
+    pimpl_->put(key, data);
+}
+
+void MeshCache::invalidate(std::uint32_t lodMask)
+{
+    pimpl_->invalidate(lodMask);
+}
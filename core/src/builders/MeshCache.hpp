@@ -0,0 +1,69 @@
+#ifndef BUILDERS_MESHCACHE_HPP_DEFINED
+#define BUILDERS_MESHCACHE_HPP_DEFINED
+
+#include "QuadKey.hpp"
+#include "meshing/MeshTypes.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace utymap { namespace builders {
+
+// Keeps results of quadkey building: meshes and exported elements. Recently used
+// quadkeys are kept in memory limited by size, all of them are written to disk
+// if directory is specified. Thread safe.
+class MeshCache
+{
+public:
+    // Element exported to external code: tags and style are key-value string pairs.
+    struct ElementData
+    {
+        std::uint64_t id;
+        std::vector<std::string> tags;
+        std::vector<double> vertices;
+        std::vector<std::string> style;
+    };
+
+    // Result of building quadkey.
+    struct TileData
+    {
+        std::vector<std::shared_ptr<const utymap::meshing::Mesh>> meshes;
+        std::vector<ElementData> elements;
+    };
+
+    // Describes everything what affects result of building quadkey.
+    struct Key
+    {
+        utymap::QuadKey quadKey;
+        // Hash of style rules used at quadkey's level of details.
+        std::uint64_t styleHash;
+        int elevationMode;
+        // Revision of data in element stores.
+        std::uint64_t dataVersion;
+    };
+
+    // Creates cache with memory limit in bytes. Disk is not used if directory is empty.
+    MeshCache(const std::string& directory, std::size_t memoryLimit);
+
+    ~MeshCache();
+
+    // Returns cached data for given key or nullptr.
+    std::shared_ptr<const TileData> get(const Key& key);
+
+    // Stores data in memory and on disk.
+    void put(const Key& key, const std::shared_ptr<const TileData>& data);
+
+    // Removes quadkeys at given levels of details from memory. Disk entries are
+    // replaced once quadkey is built again as they are validated by key.
+    void invalidate(std::uint32_t lodMask);
+
+private:
+    class MeshCacheImpl;
+    std::unique_ptr<MeshCacheImpl> pimpl_;
+};
+
+}}
+
+#endif // BUILDERS_MESHCACHE_HPP_DEFINED
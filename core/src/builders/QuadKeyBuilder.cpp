@@ -8,6 +8,9 @@
 #include "entities/Area.hpp"
 #include "entities/Relation.hpp"
 #include "utils/CoreUtils.hpp"
+#include "utils/ParallelUtils.hpp"
+
+#include <mutex>
 
 using namespace utymap;
 using namespace utymap::builders;
@@ -16,8 +19,10 @@ using namespace utymap::heightmap;
 using namespace utymap::index;
 using namespace utymap::mapcss;
 using namespace utymap::meshing;
+using namespace utymap::utils;
 
 const std::string BuilderKeyName = "builders";
+const std::size_t NoBuilder = static_cast<std::size_t>(-1);
 
 class QuadKeyBuilder::QuadKeyBuilderImpl
 {
@@ -25,7 +30,8 @@ private:
 
     typedef std::unordered_map<std::string, ElementBuilderFactory> BuilderFactoryMap;
 
-class AggregateElementVisitor : public ElementVisitor
+// Collects found elements for builders specified in their style.
+class AggregateElementVisitor
 {
 public:
     AggregateElementVisitor(const QuadKey& quadKey,
@@ -35,70 +41,124 @@ public:
                            const MeshCallback& meshFunc,
                            const ElementCallback& elementFunc,
                            BuilderFactoryMap& builderFactoryMap,
-                           std::uint32_t builderKeyId) :
-        context_(quadKey, styleProvider, stringTable, eleProvider, meshFunc, elementFunc),
+                           std::uint32_t builderKeyId,
+                           const CancellationToken& cancelToken) :
+        context_(quadKey, styleProvider, stringTable, eleProvider, meshFunc, elementFunc, cancelToken),
         builderFactoryMap_(builderFactoryMap),
-        builderKeyId_(builderKeyId)
+        builderKeyId_(builderKeyId),
+        namedBuilders_(styleProvider.getBuilderNames().size(), NoBuilder)
     {
     }
 
-    void visitNode(const Node& node) { visitElement(node); }
+    // Assigns element to builders specified in its style.
+    void visit(const std::shared_ptr<const Element>& element, const Style& style)
+    {
+        // We don't know how to build it. Skip.
+        if (!style.has(builderKeyId_))
+            return;
 
-    void visitWay(const Way& way) { visitElement(way); }
+        // NOTE element is shared by store, so it and its style are valid until builders complete.
+        std::size_t index = elements_.size();
+        elements_.push_back(ElementEntry{ element, style });
 
-    void visitArea(const Area& area) { visitElement(area); }
+        // NOTE evaluated value depends on element, so it is resolved every time.
+        const StyleDeclaration& declaration = *style.get(builderKeyId_);
+        if (declaration.isEval()) {
+            for (std::size_t builderIndex : getBuilderIndices(style.getString(builderKeyId_)))
+                builders_[builderIndex].elements.push_back(index);
+            return;
+        }
 
-    void visitRelation(const Relation& relation) { visitElement(relation); }
+        for (std::uint16_t nameIndex : declaration.builders())
+            builders_[getNamedBuilderIndex(nameIndex)].elements.push_back(index);
+    }
 
+    // Builds collected elements: builders are independent, so they are run in
+    // parallel on shared workers or one by one if quadkey is built on a worker.
     void complete()
     {
-        for (const auto& builder : builders_)
-            builder.second->complete();
+        utymap::utils::parallelFor(builders_.size(), [&](std::size_t i) {
+            BuilderEntry& entry = builders_[i];
+            for (std::size_t index : entry.elements) {
+                if (context_.cancelToken.isCancelled())
+                    return;
+                // NOTE style caches evaluated values, so every builder uses own copy.
+                Style style = elements_[index].style;
+                entry.builder->build(*elements_[index].element, style);
+            }
+            entry.builder->complete();
+        });
     }
 
 private:
 
-    // Calls appropriate visitor for given element
-    void visitElement(const Element& element)
+    // Element with its style kept until builders complete.
+    struct ElementEntry
     {
-        Style style = context_.styleProvider.forElement(element, context_.quadKey.levelOfDetail);
+        std::shared_ptr<const Element> element;
+        Style style;
+    };
 
-        // We don't know how to build it. Skip.
-        if (!style.has(builderKeyId_))
-            return;
+    // Builder with indices of elements it should build.
+    struct BuilderEntry
+    {
+        std::shared_ptr<ElementBuilder> builder;
+        std::vector<std::size_t> elements;
+    };
+
+    // Returns index of builder by index of its name in style provider.
+    std::size_t getNamedBuilderIndex(std::uint16_t nameIndex)
+    {
+        std::size_t& builderIndex = namedBuilders_[nameIndex];
+        if (builderIndex == NoBuilder)
+            builderIndex = getBuilderIndex(context_.styleProvider.getBuilderNames()[nameIndex]);
+        return builderIndex;
+    }
 
-        std::stringstream ss(*style.get(builderKeyId_)->value());
+    // Resolves evaluated comma separated builder names into builder indices.
+    const std::vector<std::size_t>& getBuilderIndices(const std::string& names)
+    {
+        auto indices = evaluatedIndices_.find(names);
+        if (indices != evaluatedIndices_.end())
+            return indices->second;
+
+        std::vector<std::size_t> result;
+        std::stringstream ss(names);
         while (ss.good()) {
             std::string name;
             getline(ss, name, ',');
-            element.accept(getBuilder(name));
+            result.push_back(getBuilderIndex(name));
         }
+        return evaluatedIndices_[names] = result;
     }
 
-    ElementBuilder& getBuilder(const std::string& name)
+    std::size_t getBuilderIndex(const std::string& name)
     {
-        auto builderPair = builders_.find(name);
-        if (builderPair != builders_.end()) {
-            return *builderPair->second;
+        auto builderPair = builderIndices_.find(name);
+        if (builderPair != builderIndices_.end()) {
+            return builderPair->second;
         }
 
         auto factory = builderFactoryMap_.find(name);
-        if (factory == builderFactoryMap_.end()) {
-            // use external builder by default
-            auto externalBuilder = std::make_shared<ExternalBuilder>(context_);
-            builders_[name] = externalBuilder;
-            return *externalBuilder;
-        }
-
-        auto builder = factory->second(context_);
-        builders_[name] = builder;
-        return *builder;
+        // use external builder by default
+        std::shared_ptr<ElementBuilder> builder = factory == builderFactoryMap_.end()
+            ? std::make_shared<ExternalBuilder>(context_)
+            : factory->second(context_);
+
+        builderIndices_[name] = builders_.size();
+        builders_.push_back(BuilderEntry{ builder, std::vector<std::size_t>() });
+        return builders_.size() - 1;
     }
 
     const BuilderContext context_;
     BuilderFactoryMap& builderFactoryMap_;
     std::uint32_t builderKeyId_;
-    std::unordered_map<std::string, std::shared_ptr<ElementBuilder>> builders_;
+    std::unordered_map<std::string, std::size_t> builderIndices_;
+    // Builder indices by index of builder name in style provider.
+    std::vector<std::size_t> namedBuilders_;
+    std::unordered_map<std::string, std::vector<std::size_t>> evaluatedIndices_;
+    std::vector<BuilderEntry> builders_;
+    std::vector<ElementEntry> elements_;
 };
 
 public:
@@ -120,13 +180,28 @@ public:
                const StyleProvider& styleProvider,
                const ElevationProvider& eleProvider,
                const MeshCallback& meshFunc,
-               const ElementCallback& elementFunc)
+               const ElementCallback& elementFunc,
+               const CancellationToken& cancelToken)
     {
+        // NOTE builders complete concurrently, so callbacks are serialized.
+        std::mutex callbackLock;
+        MeshCallback meshCallback = [&](const Mesh& mesh) {
+            std::lock_guard<std::mutex> lock(callbackLock);
+            meshFunc(mesh);
+        };
+        ElementCallback elementCallback = [&](const Element& element, const Style& style) {
+            std::lock_guard<std::mutex> lock(callbackLock);
+            elementFunc(element, style);
+        };
+
         AggregateElementVisitor elementVisitor(quadKey, styleProvider, stringTable_,
-            eleProvider, meshFunc, elementFunc, builderFactory_, builderKeyId_);
+            eleProvider, meshCallback, elementCallback, builderFactory_, builderKeyId_, cancelToken);
 
-        geoStore_.search(quadKey, styleProvider, elementVisitor);
-        elementVisitor.complete();
+        geoStore_.search(quadKey, styleProvider, [&](const std::shared_ptr<const Element>& element, const Style& style) {
+            elementVisitor.visit(element, style);
+        }, cancelToken);
+        if (!cancelToken.isCancelled())
+            elementVisitor.complete();
     }
 
 private:
@@ -142,9 +217,9 @@ void QuadKeyBuilder::registerElementBuilder(const std::string& name, ElementBuil
 }
 
 void QuadKeyBuilder::build(const QuadKey& quadKey, const StyleProvider& styleProvider, const ElevationProvider& eleProvider, 
-    MeshCallback meshFunc, ElementCallback elementFunc)
+    MeshCallback meshFunc, ElementCallback elementFunc, const CancellationToken& cancelToken)
 {
-    pimpl_->build(quadKey, styleProvider, eleProvider, meshFunc, elementFunc);
+    pimpl_->build(quadKey, styleProvider, eleProvider, meshFunc, elementFunc, cancelToken);
 }
 
 QuadKeyBuilder::QuadKeyBuilder(GeoStore& geoStore, StringTable& stringTable) :
@@ -9,6 +9,7 @@
 #include "index/GeoStore.hpp"
 #include "mapcss/StyleProvider.hpp"
 #include "meshing/MeshTypes.hpp"
+#include "utils/CancellationToken.hpp"
 
 #include <functional>
 #include <string>
@@ -22,7 +23,7 @@ class QuadKeyBuilder
 public:
 
     typedef std::function<void(const utymap::meshing::Mesh&)> MeshCallback;
-    typedef std::function<void(const utymap::entities::Element&)> ElementCallback;
+    typedef std::function<void(const utymap::entities::Element&, const utymap::mapcss::Style&)> ElementCallback;
     // Factory of element builders
     typedef std::function<std::shared_ptr<utymap::builders::ElementBuilder>(const utymap::builders::BuilderContext&)> ElementBuilderFactory;
 
@@ -31,15 +32,19 @@ public:
 
     ~QuadKeyBuilder();
 
-    // Registers factory method for element builder.
+    // Registers factory method for element builder. Should be called before
+    // building as factories are shared by concurrent builds without locking.
     void registerElementBuilder(const std::string& name, ElementBuilderFactory factory);
 
-    // Builds tile for given quadkey.
+    // Builds tile for given quadkey. Can be called from several threads:
+    // every call uses own builder instances. Returns early with partial
+    // result once cancellation token is cancelled.
     void build(const utymap::QuadKey& quadKey,
                const utymap::mapcss::StyleProvider& styleProvider,
                const utymap::heightmap::ElevationProvider& eleProvider,
                MeshCallback meshFunc,
-               ElementCallback elementFunc);
+               ElementCallback elementFunc,
+               const utymap::utils::CancellationToken& cancelToken);
 
 private:
     class QuadKeyBuilderImpl;
@@ -0,0 +1,135 @@
+#include "builders/QuadKeyPrefetcher.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    int sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+}
+
+class QuadKeyPrefetcher::QuadKeyPrefetcherImpl
+{
+public:
+    QuadKeyPrefetcherImpl(std::size_t historySize) :
+        historySize_(std::max<std::size_t>(historySize, 2)), history_()
+    {
+    }
+
+    std::vector<QuadKey> predict(const QuadKey& quadKey)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        history_.push_back(quadKey);
+        if (history_.size() > historySize_)
+            history_.pop_front();
+
+        // NOTE motion is estimated only between requests at the same level of details.
+        int dx = 0, dy = 0, zoomTrend = 0;
+        for (std::size_t i = 1; i < history_.size(); ++i) {
+            const QuadKey& previous = history_[i - 1];
+            const QuadKey& current = history_[i];
+            if (current.levelOfDetail == previous.levelOfDetail) {
+                dx += current.tileX - previous.tileX;
+                dy += current.tileY - previous.tileY;
+            }
+            else
+                zoomTrend += sign(current.levelOfDetail - previous.levelOfDetail);
+        }
+
+        std::vector<QuadKey> result;
+        addNeighbours(quadKey, dx, dy, result);
+        if (zoomTrend > 0)
+            addChildren(quadKey, result);
+        else if (zoomTrend < 0)
+            addParent(quadKey, result);
+        return result;
+    }
+
+private:
+
+    // Adds tiles ahead in direction of motion or all direct neighbours if there is no motion.
+    void addNeighbours(const QuadKey& quadKey, int dx, int dy, std::vector<QuadKey>& result) const
+    {
+        // NOTE minor axis is ignored if motion is mostly along another one.
+        int stepX = std::abs(dx) * 2 >= std::abs(dy) ? sign(dx) : 0;
+        int stepY = std::abs(dy) * 2 >= std::abs(dx) ? sign(dy) : 0;
+
+        if (stepX == 0 && stepY == 0) {
+            add(quadKey, 0, -1, result);
+            add(quadKey, 1, 0, result);
+            add(quadKey, 0, 1, result);
+            add(quadKey, -1, 0, result);
+        }
+        else if (stepX != 0 && stepY != 0) {
+            add(quadKey, stepX, stepY, result);
+            add(quadKey, stepX, 0, result);
+            add(quadKey, 0, stepY, result);
+        }
+        else {
+            add(quadKey, stepX, stepY, result);
+            add(quadKey, stepX + stepY, stepY + stepX, result);
+            add(quadKey, stepX - stepY, stepY - stepX, result);
+        }
+    }
+
+    void addChildren(const QuadKey& quadKey, std::vector<QuadKey>& result) const
+    {
+        if (quadKey.levelOfDetail >= GeoUtils::MaxLevelOfDetails)
+            return;
+
+        for (int y = 0; y < 2; ++y) {
+            for (int x = 0; x < 2; ++x)
+                add(QuadKey(quadKey.levelOfDetail + 1, quadKey.tileX * 2 + x, quadKey.tileY * 2 + y), result);
+        }
+    }
+
+    void addParent(const QuadKey& quadKey, std::vector<QuadKey>& result) const
+    {
+        if (quadKey.levelOfDetail > GeoUtils::MinLevelOfDetails)
+            add(QuadKey(quadKey.levelOfDetail - 1, quadKey.tileX / 2, quadKey.tileY / 2), result);
+    }
+
+    void add(const QuadKey& quadKey, int dx, int dy, std::vector<QuadKey>& result) const
+    {
+        add(QuadKey(quadKey.levelOfDetail, quadKey.tileX + dx, quadKey.tileY + dy), result);
+    }
+
+    // Adds quadkey if it is valid and was not requested recently.
+    void add(const QuadKey& quadKey, std::vector<QuadKey>& result) const
+    {
+        int tileCount = 1 << quadKey.levelOfDetail;
+        if (quadKey.tileX < 0 || quadKey.tileX >= tileCount || quadKey.tileY < 0 || quadKey.tileY >= tileCount)
+            return;
+
+        if (std::find(history_.begin(), history_.end(), quadKey) == history_.end() &&
+            std::find(result.begin(), result.end(), quadKey) == result.end())
+            result.push_back(quadKey);
+    }
+
+    const std::size_t historySize_;
+    std::deque<QuadKey> history_;
+    std::mutex lock_;
+};
+
+QuadKeyPrefetcher::QuadKeyPrefetcher(std::size_t historySize) :
+    pimpl_(new QuadKeyPrefetcher::QuadKeyPrefetcherImpl(historySize))
+{
+}
+
+QuadKeyPrefetcher::~QuadKeyPrefetcher()
+{
+}
+
+std::vector<QuadKey> QuadKeyPrefetcher::predict(const QuadKey& quadKey)
+{
+    return pimpl_->predict(quadKey);
+}
@@ -0,0 +1,33 @@
+#ifndef BUILDERS_QUADKEYPREFETCHER_HPP_DEFINED
+#define BUILDERS_QUADKEYPREFETCHER_HPP_DEFINED
+
+#include "QuadKey.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace utymap { namespace builders {
+
+// Predicts quadkeys which are likely to be requested next using history of
+// recent requests: neighbours in direction of motion and children or parent
+// depending on zoom trend. Thread safe.
+class QuadKeyPrefetcher
+{
+public:
+    // Creates prefetcher which keeps given amount of recent requests.
+    explicit QuadKeyPrefetcher(std::size_t historySize = 8);
+
+    ~QuadKeyPrefetcher();
+
+    // Adds quadkey to history and returns quadkeys to prefetch, the most
+    // probable first. Recently requested quadkeys are not returned.
+    std::vector<utymap::QuadKey> predict(const utymap::QuadKey& quadKey);
+
+private:
+    class QuadKeyPrefetcherImpl;
+    std::unique_ptr<QuadKeyPrefetcherImpl> pimpl_;
+};
+
+}}
+#endif // BUILDERS_QUADKEYPREFETCHER_HPP_DEFINED
@@ -0,0 +1,219 @@
+#include "BoundingBox.hpp"
+#include "builders/QuadKeyScheduler.hpp"
+#include "utils/GeoUtils.hpp"
+#include "utils/MathUtils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    // Importance multiplier for tiles outside of field of view.
+    const double OutOfViewFactor = 0.1;
+
+    // Returns bearing from one point to another in degrees clockwise from north.
+    double getBearing(const GeoCoordinate& from, const GeoCoordinate& to)
+    {
+        double lat1 = deg2Rad(from.latitude);
+        double lat2 = deg2Rad(to.latitude);
+        double dLon = deg2Rad(to.longitude - from.longitude);
+
+        double y = std::sin(dLon) * std::cos(lat2);
+        double x = std::cos(lat1) * std::sin(lat2) - std::sin(lat1) * std::cos(lat2) * std::cos(dLon);
+        return rad2Deg(std::atan2(y, x));
+    }
+
+    // Returns absolute difference between two directions in degrees.
+    double getAngle(double direction1, double direction2)
+    {
+        double angle = std::fmod(std::abs(direction1 - direction2), 360);
+        return angle > 180 ? 360 - angle : angle;
+    }
+}
+
+class QuadKeyScheduler::QuadKeySchedulerImpl
+{
+    struct Request
+    {
+        QuadKey quadKey;
+        Task run;
+        Task drop;
+        std::uint64_t sequence;
+        double importance;
+        bool isBackground;
+    };
+
+    // Orders requests in heap: foreground, the most important and then the oldest one is on top.
+    struct RequestLess
+    {
+        bool operator()(const Request& lhs, const Request& rhs) const
+        {
+            if (lhs.isBackground != rhs.isBackground)
+                return lhs.isBackground;
+            return lhs.importance < rhs.importance ||
+                  (lhs.importance == rhs.importance && lhs.sequence > rhs.sequence);
+        }
+    };
+
+public:
+    QuadKeySchedulerImpl() : requests_(), camera_(), hasCamera_(false), sequence_(0)
+    {
+    }
+
+    bool push(const QuadKey& quadKey, const Task& run, const Task& drop, bool isBackground)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        Request request{ quadKey, run, drop, sequence_++, 0, isBackground };
+        if (hasCamera_ && !getImportance(quadKey, request.importance))
+            return false;
+
+        requests_.push_back(request);
+        std::push_heap(requests_.begin(), requests_.end(), RequestLess());
+        return true;
+    }
+
+    bool pop(Task& run)
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        if (requests_.empty())
+            return false;
+
+        std::pop_heap(requests_.begin(), requests_.end(), RequestLess());
+        run = std::move(requests_.back().run);
+        requests_.pop_back();
+        return true;
+    }
+
+    void setCamera(const Camera& camera)
+    {
+        std::vector<Task> dropped;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            camera_ = camera;
+            hasCamera_ = true;
+            dropped = remove([this](Request& request) { return !getImportance(request.quadKey, request.importance); });
+        }
+
+        // NOTE drop callbacks are called without lock as they may push new requests.
+        for (const auto& drop : dropped)
+            drop();
+    }
+
+    void dropBackground()
+    {
+        std::vector<Task> dropped;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            dropped = remove([](const Request& request) { return request.isBackground; });
+        }
+
+        for (const auto& drop : dropped)
+            drop();
+    }
+
+    bool isVisible(const QuadKey& quadKey) const
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        double importance;
+        return !hasCamera_ || getImportance(quadKey, importance);
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(lock_);
+        return requests_.size();
+    }
+
+private:
+
+    // Removes requests matching predicate and returns their drop tasks. Should be called under lock.
+    template <typename Predicate>
+    std::vector<Task> remove(const Predicate& predicate)
+    {
+        std::vector<Task> dropped;
+        auto end = std::partition(requests_.begin(), requests_.end(),
+            [&predicate](Request& request) { return !predicate(request); });
+        for (auto it = end; it != requests_.end(); ++it)
+            dropped.push_back(std::move(it->drop));
+        requests_.erase(end, requests_.end());
+        std::make_heap(requests_.begin(), requests_.end(), RequestLess());
+        return dropped;
+    }
+
+    // Calculates importance as approximate screen space size of the tile.
+    // Returns false if tile is out of view distance.
+    bool getImportance(const QuadKey& quadKey, double& importance) const
+    {
+        BoundingBox bbox = GeoUtils::quadKeyToBoundingBox(quadKey);
+        GeoCoordinate center = bbox.center();
+        double radius = GeoUtils::distance(center, bbox.maxPoint);
+        double distance = GeoUtils::distance(camera_.position, center);
+
+        if (camera_.viewDistance > 0 && distance - radius > camera_.viewDistance)
+            return false;
+
+        // NOTE camera is above the tile.
+        if (distance <= radius) {
+            importance = 1;
+            return true;
+        }
+
+        double halfSize = rad2Deg(std::atan(radius / distance));
+        double angle = getAngle(getBearing(camera_.position, center), camera_.heading);
+        bool isInView = angle <= camera_.fieldOfView / 2 + halfSize;
+
+        importance = radius / distance * (isInView ? 1 : OutOfViewFactor);
+        return true;
+    }
+
+    std::vector<Request> requests_;
+    Camera camera_;
+    bool hasCamera_;
+    std::uint64_t sequence_;
+    mutable std::mutex lock_;
+};
+
+QuadKeyScheduler::QuadKeyScheduler() :
+    pimpl_(new QuadKeyScheduler::QuadKeySchedulerImpl())
+{
+}
+
+QuadKeyScheduler::~QuadKeyScheduler()
+{
+}
+
+bool QuadKeyScheduler::push(const QuadKey& quadKey, const Task& run, const Task& drop, bool isBackground)
+{
+    return pimpl_->push(quadKey, run, drop, isBackground);
+}
+
+bool QuadKeyScheduler::pop(Task& run)
+{
+    return pimpl_->pop(run);
+}
+
+void QuadKeyScheduler::setCamera(const Camera& camera)
+{
+    pimpl_->setCamera(camera);
+}
+
+void QuadKeyScheduler::dropBackground()
+{
+    pimpl_->dropBackground();
+}
+
+bool QuadKeyScheduler::isVisible(const QuadKey& quadKey) const
+{
+    return pimpl_->isVisible(quadKey);
+}
+
+std::size_t QuadKeyScheduler::size() const
+{
+    return pimpl_->size();
+}
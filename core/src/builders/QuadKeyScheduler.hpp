@@ -0,0 +1,65 @@
+#ifndef BUILDERS_QUADKEYSCHEDULER_HPP_DEFINED
+#define BUILDERS_QUADKEYSCHEDULER_HPP_DEFINED
+
+#include "GeoCoordinate.hpp"
+#include "QuadKey.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace utymap { namespace builders {
+
+// Keeps pending quadkey requests ordered by their importance for the camera:
+// visible and close tiles which take more screen space go first. Requests
+// are processed in order of submission until camera is set. Thread safe.
+class QuadKeyScheduler
+{
+public:
+    typedef std::function<void()> Task;
+
+    // Describes camera looking at the ground.
+    struct Camera
+    {
+        // Position projected on the ground.
+        utymap::GeoCoordinate position;
+        // View direction in degrees clockwise from north.
+        double heading;
+        // Horizontal field of view in degrees.
+        double fieldOfView;
+        // Tiles farther than this distance in meters are dropped. Not used if not positive.
+        double viewDistance;
+    };
+
+    QuadKeyScheduler();
+
+    ~QuadKeyScheduler();
+
+    // Adds request for given quadkey. Drop task is called instead of run
+    // task if request becomes not visible before it is processed. Background
+    // requests are processed only when there are no other ones. Returns false
+    // without calling any task if quadkey is already out of view distance.
+    bool push(const utymap::QuadKey& quadKey, const Task& run, const Task& drop, bool isBackground = false);
+
+    // Removes request with the highest priority. Returns false if there are no requests.
+    bool pop(Task& run);
+
+    // Updates camera: reorders pending requests and drops ones which are out of view distance.
+    void setCamera(const Camera& camera);
+
+    // Drops all pending background requests.
+    void dropBackground();
+
+    // Checks whether quadkey is within view distance of current camera.
+    bool isVisible(const utymap::QuadKey& quadKey) const;
+
+    // Returns amount of pending requests.
+    std::size_t size() const;
+
+private:
+    class QuadKeySchedulerImpl;
+    std::unique_ptr<QuadKeySchedulerImpl> pimpl_;
+};
+
+}}
+#endif // BUILDERS_QUADKEYSCHEDULER_HPP_DEFINED
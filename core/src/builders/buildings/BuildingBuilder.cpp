@@ -15,7 +15,9 @@
 #include "utils/CoreUtils.hpp"
 #include "utils/ElementUtils.hpp"
 #include "utils/GradientUtils.hpp"
+#include "utils/ParallelUtils.hpp"
 
+#include <algorithm>
 #include <exception>
 #include <unordered_map>
 
@@ -30,16 +32,6 @@ using namespace utymap::utils;
 
 namespace {
 
-    const std::string RoofTypeKey = "roof-type";
-    const std::string RoofHeightKey = "roof-height";
-    const std::string RoofColorKey = "roof-color";
-
-    const std::string FacadeTypeKey = "facade-type";
-    const std::string FacadeColorKey = "facade-color";
-
-    const std::string HeightKey = "height";
-    const std::string MinHeightKey = "min-height";
-
     const std::string MeshNamePrefix = "building:";
 
     // Defines roof builder which does nothing.
@@ -157,7 +149,7 @@ class BuildingBuilder::BuildingBuilderImpl : public ElementBuilder
 {
 public:
     BuildingBuilderImpl(const utymap::builders::BuilderContext& context) :
-        ElementBuilder(context)
+        ElementBuilder(context), keys_(context.styleProvider.getKeys())
     {
     }
 
@@ -167,7 +159,7 @@ public:
 
     void visitArea(const utymap::entities::Area& area)
     {
-        Style style = context_.styleProvider.forElement(area, context_.quadKey.levelOfDetail);
+        Style style = getStyle(area);
 
         // NOTE this might happen if relation contains not a building
         if (!isBuilding(style))
@@ -175,7 +167,7 @@ public:
 
         bool justCreated = ensureContext(area);
         polygon_->addContour(toPoints(area.coordinates));
-        build(area, style);
+        buildBuilding(area, style);
 
         completeIfNecessary(justCreated);
     }
@@ -187,7 +179,7 @@ public:
 
         bool justCreated = ensureContext(relation);
 
-        Style style = context_.styleProvider.forElement(relation, context_.quadKey.levelOfDetail);
+        Style style = getStyle(relation);
 
         if (isMultipolygon(style) && isBuilding(style)) {
             MultiPolygonVisitor visitor(polygon_);
@@ -195,7 +187,7 @@ public:
             for (const auto& element : relation.elements)
                 element->accept(visitor);
 
-            build(relation, style);
+            buildBuilding(relation, style);
         }
         else {
             for (const auto& element : relation.elements)
@@ -209,6 +201,12 @@ public:
     {
     }
 
+    // Returns meshes built so far in order of elements.
+    std::vector<std::shared_ptr<Mesh>>& meshes()
+    {
+        return meshes_;
+    }
+
 private:
 
     inline bool ensureContext(const Element& element)
@@ -227,52 +225,52 @@ private:
     inline void completeIfNecessary(bool justCreated)
     {
         if (justCreated) {
-            context_.meshCallback(*mesh_);
+            meshes_.push_back(mesh_);
             mesh_.reset();
         }
     }
 
     inline bool isBuilding(const Style& style) const
     {
-        return *style.getString("building") == "true";
+        return style.getString(keys_.building) == "true";
     }
 
     inline bool isMultipolygon(const Style& style) const
     {
-        return *style.getString("multipolygon") == "true";
+        return style.getString(keys_.multipolygon) == "true";
     }
 
-    void build(const Element& element, const Style& style)
+    void buildBuilding(const Element& element, const Style& style)
     {
         MeshContext meshContext(*mesh_, style);
 
         auto geoCoordinate = GeoCoordinate(polygon_->points[1], polygon_->points[0]);
 
-        double height = style.getValue(HeightKey);
+        double height = style.getValue(keys_.height);
         // NOTE do not allow height to be zero. This might happen due to the issues in input osm data.
         if (height == 0)
             height = 10;
 
-        double minHeight = style.getValue(MinHeightKey);
+        double minHeight = style.getValue(keys_.minHeight);
 
         double elevation = context_.eleProvider.getElevation(geoCoordinate) + minHeight;
 
         height -= minHeight;
 
         // roof
-        auto roofType = style.getString(RoofTypeKey);
-        double roofHeight = style.getValue(RoofHeightKey);
-        auto roofGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, element.tags, RoofColorKey);
-        auto roofBuilder = RoofBuilderFactoryMap.find(*roofType)->second(context_, meshContext);
+        const std::string& roofType = style.getString(keys_.roofType);
+        double roofHeight = style.getValue(keys_.roofHeight);
+        auto roofGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, element.tags, keys_.roofColor);
+        auto roofBuilder = RoofBuilderFactoryMap.find(roofType)->second(context_, meshContext);
         roofBuilder->setHeight(roofHeight);
         roofBuilder->setMinHeight(elevation + height);
         roofBuilder->setColor(roofGradient, 0);
         roofBuilder->build(*polygon_);
 
         // facade
-        auto facadeType = style.getString(FacadeTypeKey);
-        auto facadeBuilder = FacadeBuilderFactoryMap.find(*facadeType)->second(context_, meshContext);
-        auto facadeGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, element.tags, FacadeColorKey);
+        const std::string& facadeType = style.getString(keys_.facadeType);
+        auto facadeBuilder = FacadeBuilderFactoryMap.find(facadeType)->second(context_, meshContext);
+        auto facadeGradient = GradientUtils::evaluateGradient(context_.styleProvider, meshContext.style, element.tags, keys_.facadeColor);
         facadeBuilder->setHeight(height);
         facadeBuilder->setMinHeight(elevation);
         facadeBuilder->setColor(facadeGradient, 0);
@@ -281,12 +279,14 @@ private:
         polygon_.reset();
     }
 
+    const StyleKeys& keys_;
     std::shared_ptr<Polygon> polygon_;
     std::shared_ptr<Mesh> mesh_;
+    std::vector<std::shared_ptr<Mesh>> meshes_;
 };
 
 BuildingBuilder::BuildingBuilder(const BuilderContext& context)
-    : ElementBuilder(context), pimpl_(new BuildingBuilder::BuildingBuilderImpl(context))
+    : ElementBuilder(context), elements_()
 {
 }
 
@@ -298,17 +298,40 @@ void BuildingBuilder::visitWay(const Way&) { }
 
 void BuildingBuilder::visitArea(const Area& area)
 {
-    area.accept(*pimpl_);
+    elements_.push_back(std::make_pair(&area, getStyle(area)));
 }
 
 void BuildingBuilder::complete()
 {
-    pimpl_->complete();
+    // NOTE every worker builds contiguous range of elements with own builder,
+    // so meshes are reported in the order of elements. There is only one chunk
+    // if builder is already run on a worker, so it is built sequentially.
+    std::size_t count = elements_.size();
+    std::size_t chunkCount = std::min(getParallelism(), count);
+    std::vector<std::vector<std::shared_ptr<Mesh>>> meshes(chunkCount);
+    parallelFor(chunkCount, [&](std::size_t chunk) {
+        BuildingBuilderImpl builder(context_);
+        for (std::size_t i = count * chunk / chunkCount; i < count * (chunk + 1) / chunkCount; ++i) {
+            if (context_.cancelToken.isCancelled())
+                return;
+            builder.build(*elements_[i].first, elements_[i].second);
+        }
+        meshes[chunk] = std::move(builder.meshes());
+    });
+    elements_.clear();
+
+    if (context_.cancelToken.isCancelled())
+        return;
+
+    for (const auto& chunkMeshes : meshes) {
+        for (const auto& mesh : chunkMeshes)
+            context_.meshCallback(*mesh);
+    }
 }
 
 void BuildingBuilder::visitRelation(const utymap::entities::Relation& relation)
 {
-    relation.accept(*pimpl_);
+    elements_.push_back(std::make_pair(&relation, getStyle(relation)));
 }
 
 }}
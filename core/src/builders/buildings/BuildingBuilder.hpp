@@ -3,12 +3,16 @@
 
 #include "builders/BuilderContext.hpp"
 #include "builders/ElementBuilder.hpp"
+#include "mapcss/Style.hpp"
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace utymap { namespace builders {
 
-// Responsible for building generation.
+// Responsible for building generation. Buildings are independent, so they are
+// collected and built concurrently on complete.
 class BuildingBuilder : public utymap::builders::ElementBuilder
 {
 public:
@@ -28,7 +32,8 @@ public:
 
 private:
     class BuildingBuilderImpl;
-    std::unique_ptr<BuildingBuilderImpl> pimpl_;
+    // Elements with their styles to be built on complete.
+    std::vector<std::pair<const utymap::entities::Element*, utymap::mapcss::Style>> elements_;
 };
 
 }}
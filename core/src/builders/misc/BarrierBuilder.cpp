@@ -6,6 +6,7 @@
 #include "utils/ElementUtils.hpp"
 #include "utils/GeometryUtils.hpp"
 #include "utils/GradientUtils.hpp"
+#include "utils/ParallelUtils.hpp"
 
 using namespace ClipperLib;
 using namespace utymap::builders;
@@ -16,17 +17,37 @@ using namespace utymap::utils;
 
 namespace {
     const double Scale = 1E7;
-    const std::string HeightKey = "height";
-    const std::string MinHeightKey = "min-height";
-    const std::string ColorKey = "color";
-    const std::string OffsetKey = "offset";
     const std::string MeshNamePrefix = "barrier:";
 }
 
 void BarrierBuilder::visitWay(const Way& way)
 {
-    Style style = context_.styleProvider.forElement(way, context_.quadKey.levelOfDetail);
+    ways_.push_back(std::make_pair(&way, getStyle(way)));
+}
+
+void BarrierBuilder::complete()
+{
+    // NOTE barriers are independent: every one is built into own mesh on shared
+    // workers and meshes are reported in the order of ways. Ways are built
+    // sequentially if builder is already run on a worker.
+    std::vector<std::unique_ptr<Mesh>> meshes(ways_.size());
+    parallelFor(ways_.size(), [&](std::size_t i) {
+        if (context_.cancelToken.isCancelled())
+            return;
+        meshes[i].reset(new Mesh(utymap::utils::getMeshName(MeshNamePrefix, *ways_[i].first)));
+        buildWay(*ways_[i].first, ways_[i].second, *meshes[i]);
+    });
+    ways_.clear();
+
+    if (context_.cancelToken.isCancelled())
+        return;
+
+    for (const auto& mesh : meshes)
+        context_.meshCallback(*mesh);
+}
 
+void BarrierBuilder::buildWay(const Way& way, const Style& style, Mesh& mesh) const
+{
     ClipperOffset offset;
     Path path;
     path.reserve(way.coordinates.size());
@@ -42,7 +63,7 @@ void BarrierBuilder::visitWay(const Way& way)
     offset.AddPath(path, JoinType::jtMiter, EndType::etOpenSquare);
 
     Paths solution;
-    double offsetInMeters = style.getValue(OffsetKey);
+    double offsetInMeters = style.getValue(context_.styleProvider.getKeys().offset);
     double offsetInGrads = GeoUtils::getOffset(way.coordinates[0], offsetInMeters);
     offset.Execute(solution, offsetInGrads * Scale);
     auto& shape = solution[0];
@@ -62,19 +83,19 @@ void BarrierBuilder::visitWay(const Way& way)
 
     polygon.addContour(vertices);
 
-    buildFromPolygon(way, style, polygon);
+    buildFromPolygon(way, style, polygon, mesh);
 }
 
-void BarrierBuilder::buildFromPolygon(const Way& way, const Style& style, Polygon& polygon)
+void BarrierBuilder::buildFromPolygon(const Way& way, const Style& style, Polygon& polygon, Mesh& mesh) const
 {
-    double height = style.getValue(HeightKey);
-    double minHeight = style.getValue(MinHeightKey);
+    const StyleKeys& keys = context_.styleProvider.getKeys();
+    double height = style.getValue(keys.height);
+    double minHeight = style.getValue(keys.minHeight);
     double elevation = context_.eleProvider.getElevation(way.coordinates[0]) + minHeight;
 
-    Mesh mesh(utymap::utils::getMeshName(MeshNamePrefix, way));
     MeshContext meshContext(mesh, style);
 
-    auto gradient = GradientUtils::evaluateGradient(context_.styleProvider, style, way.tags, ColorKey);
+    auto gradient = GradientUtils::evaluateGradient(context_.styleProvider, style, way.tags, keys.color);
 
     // NOTE: Reuse building builders.
 
@@ -89,6 +110,4 @@ void BarrierBuilder::buildFromPolygon(const Way& way, const Style& style, Polygo
         .setMinHeight(elevation)
         .setColor(gradient, 0)
         .build(polygon);
-
-    context_.meshCallback(mesh);
 }
\ No newline at end of file
@@ -3,17 +3,21 @@
 
 #include "builders/ElementBuilder.hpp"
 #include "mapcss/Style.hpp"
+#include "meshing/MeshTypes.hpp"
 #include "meshing/Polygon.hpp"
 
+#include <utility>
+#include <vector>
+
 namespace utymap { namespace builders {
 
-// Provides the way to build barrier.
+// Provides the way to build barrier. Barriers are built concurrently on complete.
 class BarrierBuilder : public ElementBuilder
 {
 
 public:
     BarrierBuilder(const utymap::builders::BuilderContext& context)
-        : ElementBuilder(context)
+        : ElementBuilder(context), ways_()
     {
     }
 
@@ -25,12 +29,20 @@ public:
 
     void visitRelation(const utymap::entities::Relation& relation) { }
 
-    void complete() { }
+    void complete();
    
 private:
+    void buildWay(const utymap::entities::Way& way,
+                  const utymap::mapcss::Style& style,
+                  utymap::meshing::Mesh& mesh) const;
+
     void buildFromPolygon(const utymap::entities::Way& way, 
                           const utymap::mapcss::Style& style,
-                          utymap::meshing::Polygon& polygon);
+                          utymap::meshing::Polygon& polygon,
+                          utymap::meshing::Mesh& mesh) const;
+
+    // Ways with their styles to be built on complete.
+    std::vector<std::pair<const utymap::entities::Way*, utymap::mapcss::Style>> ways_;
 };
 
 }}
@@ -10,17 +10,12 @@ using namespace utymap::utils;
 
 namespace {
     const std::string MeshNamePrefix = "tree:";
-    const std::string FoliageColorKey = "foliage-color";
-    const std::string TrunkColorKey = "trunk-color";
-    const std::string FoliageRadius = "foliage-radius";
-    const std::string TrunkRadius = "trunk-radius";
-    const std::string TrunkHeight = "trunk-height";
 }
 
 void TreeBuilder::visitNode(const utymap::entities::Node& node)
 {
     Mesh mesh(utymap::utils::getMeshName(MeshNamePrefix, node));
-    Style style = context_.styleProvider.forElement(node, context_.quadKey.levelOfDetail);
+    Style style = getStyle(node);
    
     MeshContext meshContext(mesh, style);
 
@@ -38,17 +33,18 @@ TreeGenerator TreeBuilder::createGenerator(const BuilderContext& builderContext,
 {
     double relativeSize = builderContext.boundingBox.maxPoint.latitude - builderContext.boundingBox.minPoint.latitude;
     GeoCoordinate relativeCoordinate = builderContext.boundingBox.center();
+    const StyleKeys& keys = builderContext.styleProvider.getKeys();
 
-    double foliageRadiusInDegrees = meshContext.style.getValue(FoliageRadius, relativeSize, relativeCoordinate);
-    double foliageRadiusInMeters = meshContext.style.getValue(FoliageRadius, relativeSize);
+    double foliageRadiusInDegrees = meshContext.style.getValue(keys.foliageRadius, relativeSize, relativeCoordinate);
+    double foliageRadiusInMeters = meshContext.style.getValue(keys.foliageRadius, relativeSize);
 
-    auto foliageGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, tags, FoliageColorKey);
-    auto trunkGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, tags, TrunkColorKey);
+    auto foliageGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, tags, keys.foliageColor);
+    auto trunkGradient = GradientUtils::evaluateGradient(builderContext.styleProvider, meshContext.style, tags, keys.trunkColor);
 
     return TreeGenerator(builderContext, meshContext)
         .setFoliageColor(foliageGradient, 0)
         .setFoliageRadius(foliageRadiusInDegrees, foliageRadiusInMeters)
         .setTrunkColor(trunkGradient, 0)
-        .setTrunkRadius(meshContext.style.getValue(TrunkRadius, relativeSize, relativeCoordinate))
-        .setTrunkHeight(meshContext.style.getValue(TrunkHeight, relativeSize));
+        .setTrunkRadius(meshContext.style.getValue(keys.trunkRadius, relativeSize, relativeCoordinate))
+        .setTrunkHeight(meshContext.style.getValue(keys.trunkHeight, relativeSize));
 }
\ No newline at end of file
@@ -25,8 +25,6 @@ using namespace utymap::utils;
 
 namespace {
     const static double Scale = 1E7;
-    const static std::string TerrainLayerKey = "terrain-layer";
-    const static std::string WidthKey = "width";
 
     // Converts coordinate to clipper's IntPoint.
     inline IntPoint toIntPoint(double x, double y)
@@ -38,15 +36,16 @@ namespace {
     struct RelationVisitor : public ElementVisitor
     {
         const Relation& relation;
-        ElementVisitor& builder;
+        ElementBuilder& builder;
+        const BuilderContext& context;
         TerraGenerator::Region& region;
 
-        RelationVisitor(ElementVisitor& b, const Relation& r, TerraGenerator::Region& reg) :
-                builder(b), relation(r), region(reg) {}
+        RelationVisitor(ElementBuilder& b, const BuilderContext& c, const Relation& r, TerraGenerator::Region& reg) :
+                relation(r), builder(b), context(c), region(reg) {}
 
-        void visitNode(const utymap::entities::Node& n) { n.accept(builder); }
+        void visitNode(const utymap::entities::Node& n) { build(n); }
 
-        void visitWay(const utymap::entities::Way& w) { w.accept(builder); }
+        void visitWay(const utymap::entities::Way& w) { build(w); }
 
         void visitArea(const utymap::entities::Area& a)
         {
@@ -58,7 +57,24 @@ namespace {
             region.points.push_back(path);
         }
 
-        void visitRelation(const utymap::entities::Relation& r)  { r.accept(builder); }
+        void visitRelation(const utymap::entities::Relation& r)  { build(r); }
+
+    private:
+        // Element without tags is result of clipping: it is styled using relation
+        // tags. Element itself is not modified as it is shared with other builders.
+        template <typename T>
+        void build(const T& element)
+        {
+            if (!element.tags.empty()) {
+                element.accept(builder);
+                return;
+            }
+
+            T tagged;
+            tagged.id = element.id;
+            tagged.tags = relation.tags;
+            builder.build(element, context.styleProvider.forElement(tagged, context.quadKey.levelOfDetail));
+        }
     };
 }
 
@@ -68,6 +84,7 @@ public:
 
     TerraBuilderImpl(const BuilderContext& context) :
         ElementBuilder(context), 
+        keys_(context.styleProvider.getKeys()),
         style_(context.styleProvider.forCanvas(context.quadKey.levelOfDetail)), 
         clipper_(),
         generator_(context, style_, clipper_)
@@ -86,11 +103,11 @@ public:
 
     void visitWay(const utymap::entities::Way& way)
     {
-        Style style = context_.styleProvider.forElement(way, context_.quadKey.levelOfDetail);
+        Style style = getStyle(way);
         TerraGenerator::Region region = createRegion(style, way.coordinates);
 
         // make polygon from line by offsetting it using width specified
-        double width = style.getValue(WidthKey, 
+        double width = style.getValue(keys_.width, 
             context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude,
             context_.boundingBox.center());
 
@@ -105,17 +122,17 @@ public:
 
         region.points = solution;
         std::string type = region.isLayer 
-            ? *style.getString(TerrainLayerKey)
+            ? style.getString(keys_.terrainLayer)
             : "";
         generator_.addRegion(type, region);
     }
 
     void visitArea(const utymap::entities::Area& area)
     {
-        Style style = context_.styleProvider.forElement(area, context_.quadKey.levelOfDetail);
+        Style style = getStyle(area);
         TerraGenerator::Region region = createRegion(style, area.coordinates);
         std::string type = region.isLayer
-            ? *style.getString(TerrainLayerKey)
+            ? style.getString(keys_.terrainLayer)
             : "";
         generator_.addRegion(type, region);
     }
@@ -123,23 +140,19 @@ public:
     void visitRelation(const utymap::entities::Relation& rel)
     {
         TerraGenerator::Region region;
-        RelationVisitor visitor(*this, rel, region);
+        RelationVisitor visitor(*this, context_, rel, region);
 
-        for (const auto& element : rel.elements) {
-            // if there are no tags, then this element is result of clipping
-            if (element->tags.empty())
-                element->tags = rel.tags;
+        for (const auto& element : rel.elements)
             element->accept(visitor);
-        }
 
         if (!region.points.empty()) {
-            Style style = context_.styleProvider.forElement(rel, context_.quadKey.levelOfDetail);
-            region.isLayer = style.has(context_.stringTable.getId(TerrainLayerKey));
+            Style style = getStyle(rel);
+            region.isLayer = style.has(keys_.terrainLayer);
             if (!region.isLayer)
                 region.context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style, ""));
 
             std::string type = region.isLayer 
-                ? *style.getString(TerrainLayerKey)
+                ? style.getString(keys_.terrainLayer)
                 : "";
             generator_.addRegion(type, region);
         }
@@ -164,13 +177,14 @@ private:
 
         region.points.push_back(path);
 
-        region.isLayer = style.has(context_.stringTable.getId(TerrainLayerKey));
+        region.isLayer = style.has(keys_.terrainLayer);
         if (!region.isLayer)
             region.context = std::make_shared<TerraGenerator::RegionContext>(generator_.createRegionContext(style, ""));
 
         return std::move(region);
     }
 
+    const StyleKeys& keys_;
     const Style style_;
     ClipperEx clipper_;
     ClipperOffset offset_;
@@ -180,11 +194,11 @@ private:
 
 void TerraBuilder::visitNode(const utymap::entities::Node& node) { pimpl_->visitNode(node); }
 
-void TerraBuilder::visitWay(const utymap::entities::Way& way) { pimpl_->visitWay(way); }
+void TerraBuilder::visitWay(const utymap::entities::Way& way) { pimpl_->build(way, getStyle(way)); }
 
-void TerraBuilder::visitArea(const utymap::entities::Area& area) { pimpl_->visitArea(area); }
+void TerraBuilder::visitArea(const utymap::entities::Area& area) { pimpl_->build(area, getStyle(area)); }
 
-void TerraBuilder::visitRelation(const utymap::entities::Relation& relation) { pimpl_->visitRelation(relation); }
+void TerraBuilder::visitRelation(const utymap::entities::Relation& relation) { pimpl_->build(relation, getStyle(relation)); }
 
 void TerraBuilder::complete() { pimpl_->complete(); }
 
@@ -19,15 +19,6 @@ namespace {
     const static double Scale = 1E7;
 
     const static std::string TerrainMeshName = "terrain";
-    const static std::string ColorNoiseFreqKey = "color-noise-freq";
-    const static std::string EleNoiseFreqKey = "ele-noise-freq";
-    const static std::string GradientKey = "color";
-    const static std::string MaxAreaKey = "max-area";
-    const static std::string HeightOffsetKey = "height-offset";
-    const static std::string LayerPriorityKey = "layer-priority";
-    const static std::string MeshNameKey = "mesh-name";
-    const static std::string MeshExtrasKey = "mesh-extras";
-    const static std::string GridCellSize = "grid-cell-size";
 
     const static std::unordered_map<std::string, TerraExtras::ExtrasFunc> ExtrasFuncs = 
     {
@@ -52,13 +43,18 @@ void TerraGenerator::addRegion(const std::string& type, const Region& region)
 
 void TerraGenerator::generate(Path& tileRect)
 {
-    double size = style_.getValue(GridCellSize,
+    double size = style_.getValue(context_.styleProvider.getKeys().gridCellSize,
         context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude, 
         context_.boundingBox.center());
     splitter_.setParams(Scale, size);
 
     buildLayers();
+    if (context_.cancelToken.isCancelled())
+        return;
+
     buildBackground(tileRect);
+    if (context_.cancelToken.isCancelled())
+        return;
 
     context_.meshCallback(mesh_);
 }
@@ -67,11 +63,13 @@ void TerraGenerator::generate(Path& tileRect)
 void TerraGenerator::buildLayers()
 {
     // 1. process layers: regions with shared properties.
-    std::stringstream ss(*style_.getString(LayerPriorityKey));
+    std::stringstream ss(style_.getString(context_.styleProvider.getKeys().layerPriority));
     while (ss.good()) {
         std::string name;
         getline(ss, name, ',');
         auto layer = layers_.find(name);
+        if (context_.cancelToken.isCancelled())
+            return;
         if (layer != layers_.end()) {
             buildFromRegions(layer->second, createRegionContext(style_, name + "-"));
             layers_.erase(layer);
@@ -81,6 +79,8 @@ void TerraGenerator::buildLayers()
     // 2. Process the rest: each region has already its own properties.
     for (auto& layer : layers_)
         for (auto& region : layer.second) {
+            if (context_.cancelToken.isCancelled())
+                return;
             buildFromPaths(region.points, *region.context);
         }
 }
@@ -100,13 +100,14 @@ void TerraGenerator::buildBackground(Path& tileRect)
 TerraGenerator::RegionContext TerraGenerator::createRegionContext(const Style& style, const std::string& prefix)
 {
     double quadKeyWidth = context_.boundingBox.maxPoint.latitude - context_.boundingBox.minPoint.latitude;
-
-    return TerraGenerator::RegionContext(style, prefix, MeshBuilder::Options(
-        style.getValue(prefix + MaxAreaKey, quadKeyWidth * quadKeyWidth),
-        style.getValue(prefix + EleNoiseFreqKey, quadKeyWidth),
-        style.getValue(prefix + ColorNoiseFreqKey, quadKeyWidth),
-        style.getValue(prefix + HeightOffsetKey, quadKeyWidth),
-        context_.styleProvider.getGradient(*style.getString(prefix + GradientKey)),
+    const StyleKeys::TerrainKeys& keys = context_.styleProvider.getKeys().terrain(prefix);
+
+    return TerraGenerator::RegionContext(style, keys, MeshBuilder::Options(
+        style.getValue(keys.maxArea, quadKeyWidth * quadKeyWidth),
+        style.getValue(keys.eleNoiseFreq, quadKeyWidth),
+        style.getValue(keys.colorNoiseFreq, quadKeyWidth),
+        style.getValue(keys.heightOffset, quadKeyWidth),
+        context_.styleProvider.getGradient(style.getString(keys.color)),
         std::numeric_limits<double>::lowest(),
         /* no new vertices on boundaries */ 1));
 }
@@ -182,9 +183,12 @@ TerraGenerator::Points TerraGenerator::restorePoints(const Path& path)
 
 void TerraGenerator::fillMesh(Polygon& polygon, const RegionContext& regionContext)
 {
+    if (context_.cancelToken.isCancelled())
+        return;
+
     TerraExtras::MeshContext meshContext(regionContext.style, regionContext.options);
 
-    std::string meshName = *style_.getString(regionContext.prefix + MeshNameKey);
+    std::string meshName = style_.getString(regionContext.keys.meshName);
     if (!meshName.empty()) {
         Mesh polygonMesh(meshName);
 
@@ -208,7 +212,7 @@ void TerraGenerator::addExtrasIfNecessary(utymap::meshing::Mesh &mesh,
                                           TerraExtras::MeshContext& meshContext,
                                           const RegionContext& regionContext)
 {
-    std::string meshExtras = *style_.getString(regionContext.prefix + MeshExtrasKey);
+    std::string meshExtras = style_.getString(regionContext.keys.meshExtras);
     if (meshExtras.empty())
         return;
 
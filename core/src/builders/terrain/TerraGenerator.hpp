@@ -23,14 +23,15 @@ public:
     // Region context encapsulates information about given region.
     struct RegionContext
     {
-        const utymap::mapcss::Style& style;
-        const std::string prefix;  // Prefix in mapcss.
+        // NOTE context can outlive element, so style keeps own copy of tags.
+        const utymap::mapcss::Style style;
+        const utymap::mapcss::StyleKeys::TerrainKeys keys;  // Keys prefixed in mapcss.
         const utymap::meshing::MeshBuilder::Options options;
 
         RegionContext(const utymap::mapcss::Style& style,
-                      const std::string& prefix,
+                      const utymap::mapcss::StyleKeys::TerrainKeys& keys,
                       const utymap::meshing::MeshBuilder::Options& options) :
-            style(style), prefix(prefix), options(options)
+            style(style.detached()), keys(keys), options(options)
         {
         }
     };
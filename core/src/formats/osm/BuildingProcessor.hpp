@@ -17,11 +17,14 @@ namespace utymap { namespace formats {
 class BuildingProcessor
 {
 public:
+    // NOTE building parts are not removed from context immediately: their ids are
+    // stored in removals to be applied once all relations are resolved.
     BuildingProcessor(utymap::entities::Relation& relation,
                       const utymap::formats::RelationMembers& members,
-                      utymap::formats::OsmDataContext& context,
+                      const utymap::formats::OsmDataContext& context,
+                      utymap::formats::OsmDataContext::Removals& removals,
                       std::function<void(utymap::entities::Relation&)> resolve)
-    : relation_(relation), members_(members), context_(context), resolve_(resolve)
+    : relation_(relation), members_(members), context_(context), removals_(removals), resolve_(resolve)
     {
     }
 
@@ -33,19 +36,19 @@ public:
     void visit(OsmDataContext::NodeMapType::const_iterator node)
     {
         relation_.elements.push_back(node->second);
-        context_.nodeMap.erase(node->first);
+        removals_.nodes.push_back(node->first);
     }
 
     void visit(OsmDataContext::WayMapType::const_iterator way)
     {
         relation_.elements.push_back(way->second);
-        context_.wayMap.erase(way->first);
+        removals_.ways.push_back(way->first);
     }
 
     void visit(OsmDataContext::AreaMapType::const_iterator area)
     {
         relation_.elements.push_back(area->second);
-        context_.areaMap.erase(area->first);
+        removals_.areas.push_back(area->first);
     }
 
     void visit(OsmDataContext::RelationMapType::const_iterator rel, const std::string& role)
@@ -58,14 +61,15 @@ public:
         // NOTE add specific tags instead to make this relation ignored by building builder?
         // We should prevent usage of this relation by building builder. However, it might be
         // used by some other builderes.
-        context_.relationMap.erase(rel->first);
+        removals_.relations.push_back(rel->first);
     }
 
 private:
 
     utymap::entities::Relation& relation_;
     const utymap::formats::RelationMembers& members_;
-    utymap::formats::OsmDataContext& context_;
+    const utymap::formats::OsmDataContext& context_;
+    utymap::formats::OsmDataContext::Removals& removals_;
     std::function<void(utymap::entities::Relation&)> resolve_;
 };
 
@@ -2,6 +2,7 @@
 #include "entities/Way.hpp"
 #include "entities/Area.hpp"
 #include "entities/Relation.hpp"
+#include "BoundingBox.hpp"
 #include "formats/osm/MultipolygonProcessor.hpp"
 
 #include "utils/ElementUtils.hpp"
@@ -9,6 +10,9 @@
 #include "utils/GeometryUtils.hpp"
 
 #include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 using namespace utymap;
 using namespace utymap::entities;
@@ -18,6 +22,49 @@ using namespace utymap::index;
 typedef std::deque<GeoCoordinate> Coords;
 typedef std::vector<int> Ints;
 
+namespace {
+
+// Checks whether inner bounding box is inside outer one including its border.
+inline bool containsBoundingBox(const BoundingBox& outer, const BoundingBox& inner)
+{
+    return inner.minPoint.latitude >= outer.minPoint.latitude && inner.maxPoint.latitude <= outer.maxPoint.latitude &&
+           inner.minPoint.longitude >= outer.minPoint.longitude && inner.maxPoint.longitude <= outer.maxPoint.longitude;
+}
+
+// Hashes coordinate by its exact value.
+struct CoordinateHash
+{
+    std::size_t operator()(const GeoCoordinate& c) const
+    {
+        // NOTE adding zero makes negative zero equal to positive one.
+        std::size_t seed = std::hash<double>()(c.latitude + 0.0);
+        return seed ^ (std::hash<double>()(c.longitude + 0.0) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+    }
+};
+
+// Compares coordinates exactly. NOTE GeoCoordinate::operator== uses tolerance, so
+// it is not consistent with hash.
+struct CoordinateEqual
+{
+    bool operator()(const GeoCoordinate& lhs, const GeoCoordinate& rhs) const
+    {
+        return lhs.latitude == rhs.latitude && lhs.longitude == rhs.longitude;
+    }
+};
+
+typedef std::unordered_set<GeoCoordinate, CoordinateHash, CoordinateEqual> CoordinateSet;
+typedef std::unordered_map<GeoCoordinate, std::vector<std::size_t>, CoordinateHash, CoordinateEqual> CoordinateIndexMap;
+
+// Keeps ring's data used to detect rings nesting.
+struct RingInfo
+{
+    BoundingBox bbox;
+    // Lazily built set of ring vertices.
+    CoordinateSet vertices;
+};
+
+}
+
 
 struct MultipolygonProcessor::CoordinateSequence
 {
@@ -68,19 +115,12 @@ struct MultipolygonProcessor::CoordinateSequence
         return coordinates.size() > 1 && coordinates[0] == coordinates[coordinates.size() - 1]; 
     }
 
-    inline bool containsRing(const Coords& other) const
-    {
-        return std::all_of(other.begin(), other.end(), [&](const GeoCoordinate& c) {
-            return utymap::utils::GeoUtils::isPointInPolygon(c, coordinates.begin(), coordinates.end());
-        });
-    }
-
-private:
-
     inline GeoCoordinate first() const { return coordinates[0]; }
 
     inline GeoCoordinate last() const { return coordinates[coordinates.size() - 1]; }
 
+private:
+
     inline void addToBegin(const Coords& other) { coordinates.insert(coordinates.begin(), other.begin(), other.end()); }
 
     inline void addToEnd(const Coords& other) { coordinates.insert(coordinates.end(), other.begin(), other.end()); }
@@ -186,33 +226,52 @@ void MultipolygonProcessor::complexCase(CoordinateSequences& sequences)
 
 std::vector<std::shared_ptr<MultipolygonProcessor::CoordinateSequence>> MultipolygonProcessor::createRings(CoordinateSequences& sequences)
 {
+    // NOTE sequences are indexed by their end points to find ring continuation without scanning.
+    CoordinateIndexMap endpoints;
+    endpoints.reserve(sequences.size() * 2);
+    for (std::size_t i = 0; i < sequences.size(); ++i) {
+        endpoints[sequences[i]->first()].push_back(i);
+        if (!sequences[i]->isClosed())
+            endpoints[sequences[i]->last()].push_back(i);
+    }
+
+    std::vector<bool> used(sequences.size(), false);
+    // Finds unused sequence with minimal index which touches given point.
+    auto findNext = [&](const GeoCoordinate& point, std::size_t next) {
+        auto indicesPair = endpoints.find(point);
+        if (indicesPair != endpoints.end()) {
+            for (std::size_t index : indicesPair->second) {
+                if (!used[index] && index < next)
+                    next = index;
+            }
+        }
+        return next;
+    };
+
     CoordinateSequences closedRings;
     std::shared_ptr<MultipolygonProcessor::CoordinateSequence> currentRing = nullptr;
-    while (!sequences.empty()) {
+    std::size_t lastIndex = sequences.size();
+    std::size_t remaining = sequences.size();
+    while (remaining > 0) {
         if (currentRing == nullptr) {
             // start a new ring with any remaining node sequence
-            auto lastIndex = sequences.size() - 1;
+            do { --lastIndex; } while (used[lastIndex]);
             currentRing = sequences[lastIndex];
-            sequences.erase(sequences.begin() + lastIndex);
+            used[lastIndex] = true;
         }
         else {
             // try to continue the ring by appending a node sequence
-            bool isFound = false;
-            for (auto it = sequences.begin(); it != sequences.end(); ++it) {
-                if (!currentRing->tryAdd(**it)) continue;
-                isFound = true;
-                sequences.erase(it);
-                break;
-            }
-
-            if (!isFound) 
+            std::size_t next = findNext(currentRing->first(), findNext(currentRing->last(), sequences.size()));
+            if (next == sequences.size() || !currentRing->tryAdd(*sequences[next]))
                 return CoordinateSequences();
+            used[next] = true;
         }
+        --remaining;
 
         // check whether the ring under construction is closed
-        if (currentRing != nullptr && currentRing->isClosed()) {
+        if (currentRing->isClosed()) {
             // TODO check that it isn't self-intersecting!
-            closedRings.push_back(std::make_shared<CoordinateSequence>(*currentRing));
+            closedRings.push_back(currentRing);
             currentRing = nullptr;
         }
     }
@@ -222,47 +281,75 @@ std::vector<std::shared_ptr<MultipolygonProcessor::CoordinateSequence>> Multipol
 
 void MultipolygonProcessor::fillRelation(CoordinateSequences& rings)
 {
-    while (!rings.empty()) {
-        // find an outer ring
-        std::shared_ptr<CoordinateSequence> outer = nullptr;
-        for (auto candidate = rings.begin(); candidate != rings.end(); ++candidate) {
-            bool containedInOtherRings = false;
-            for (auto other = rings.begin(); other != rings.end(); ++other) {
-                if (other != candidate && (*other)->containsRing((*candidate)->coordinates)) {
-                    containedInOtherRings = true;
-                    break;
-                }
-            }
-            if (containedInOtherRings) continue;
-            outer = *candidate;
-            rings.erase(candidate);
-            break;
+    std::vector<RingInfo> infos(rings.size());
+    for (std::size_t i = 0; i < rings.size(); ++i)
+        infos[i].bbox.expand(rings[i]->coordinates.cbegin(), rings[i]->coordinates.cend());
+
+    // Checks whether inner ring is inside outer one testing single point of inner ring
+    // which is not shared with outer ring.
+    auto containsRing = [&](std::size_t outer, std::size_t inner) {
+        if (!containsBoundingBox(infos[outer].bbox, infos[inner].bbox))
+            return false;
+
+        auto& vertices = infos[outer].vertices;
+        const Coords& outerCoordinates = rings[outer]->coordinates;
+        if (vertices.empty())
+            vertices.insert(outerCoordinates.begin(), outerCoordinates.end());
+
+        for (const GeoCoordinate& coordinate : rings[inner]->coordinates) {
+            if (vertices.find(coordinate) == vertices.end())
+                return utymap::utils::GeoUtils::isPointInPolygon(coordinate, outerCoordinates.begin(), outerCoordinates.end());
+        }
+        return false;
+    };
+
+    // containers[i] contains indices of rings which contain ring i.
+    std::vector<std::vector<std::size_t>> containers(rings.size());
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        for (std::size_t j = 0; j < rings.size(); ++j) {
+            if (i != j && containsRing(j, i))
+                containers[i].push_back(j);
         }
+    }
+
+    std::vector<bool> isUsed(rings.size(), false);
+    auto isContainedInOthers = [&](std::size_t index) {
+        return std::any_of(containers[index].begin(), containers[index].end(), [&](std::size_t c) { return !isUsed[c]; });
+    };
+
+    std::vector<std::size_t> remaining(rings.size());
+    for (std::size_t i = 0; i < remaining.size(); ++i)
+        remaining[i] = i;
+
+    while (!remaining.empty()) {
+        // find an outer ring
+        auto outerIter = std::find_if(remaining.begin(), remaining.end(),
+            [&](std::size_t index) { return !isContainedInOthers(index); });
+        // NOTE cannot happen for valid data: take any ring.
+        if (outerIter == remaining.end())
+            outerIter = remaining.begin();
+        std::size_t outer = *outerIter;
+        isUsed[outer] = true;
+        remaining.erase(outerIter);
 
         // find inner rings of that ring
         CoordinateSequences inners;
-        for (auto ring = rings.begin(); ring != rings.end();) {
-            if (outer->containsRing((*ring)->coordinates)) {
-                bool containedInOthers = false;
-                for (auto other = rings.begin(); other != rings.end(); ++other) {
-                    if (other != ring && (*other)->containsRing((*ring)->coordinates)) {
-                        containedInOthers = true;
-                        break;
-                    }
-                }
-                if (!containedInOthers) {
-                    inners.push_back(*ring);
-                    ring = rings.erase(ring);
-                    continue;
-                }
+        for (auto ring = remaining.begin(); ring != remaining.end();) {
+            const auto& ringContainers = containers[*ring];
+            if (std::find(ringContainers.begin(), ringContainers.end(), outer) != ringContainers.end() &&
+                !isContainedInOthers(*ring)) {
+                inners.push_back(rings[*ring]);
+                isUsed[*ring] = true;
+                ring = remaining.erase(ring);
+                continue;
             }
             ++ring;
         }
 
         // outer
         auto outerArea = std::make_shared<Area>();
-        outerArea->id = outer->id;
-        insertCoordinates(outer->coordinates, outerArea->coordinates, true);
+        outerArea->id = rings[outer]->id;
+        insertCoordinates(rings[outer]->coordinates, outerArea->coordinates, true);
         relation_.elements.push_back(outerArea);
 
         // inner: create a new area and remove the used rings
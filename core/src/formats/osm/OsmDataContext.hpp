@@ -3,8 +3,10 @@
 
 #include "entities/Element.hpp"
 
+#include <cstdint>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace utymap { namespace formats {
 
@@ -20,6 +22,25 @@ struct OsmDataContext
     WayMapType wayMap;
     AreaMapType areaMap;
     RelationMapType relationMap;
+
+    // Stores ids of elements which should be removed from context. Allows to
+    // modify context only when no one reads it.
+    struct Removals
+    {
+        std::vector<std::uint64_t> nodes;
+        std::vector<std::uint64_t> ways;
+        std::vector<std::uint64_t> areas;
+        std::vector<std::uint64_t> relations;
+
+        // Removes elements from given context.
+        void apply(OsmDataContext& context) const
+        {
+            for (auto id : nodes) context.nodeMap.erase(id);
+            for (auto id : ways) context.wayMap.erase(id);
+            for (auto id : areas) context.areaMap.erase(id);
+            for (auto id : relations) context.relationMap.erase(id);
+        }
+    };
 };
 
 }}
@@ -8,6 +8,7 @@
 #include "formats/osm/OsmDataVisitor.hpp"
 #include "utils/ElementUtils.hpp"
 #include "utils/GeometryUtils.hpp"
+#include "utils/ParallelUtils.hpp"
 
 #include <algorithm>
 #include <vector>
@@ -58,6 +59,12 @@ void OsmDataVisitor::visitBounds(BoundingBox bbox)
 
 void OsmDataVisitor::visitNode(std::uint64_t id, GeoCoordinate& coordinate, utymap::formats::Tags& tags)
 {
+    if (filter_ != nullptr) {
+        if (filter_->canMatch(utymap::mapcss::ImportFilter::Node, tags))
+            acceptedNodes_.insert(id);
+        filter_->apply(tags);
+    }
+
     auto node = std::make_shared<Node>();
     node->id = id;
     node->coordinate = coordinate;
@@ -70,10 +77,18 @@ void OsmDataVisitor::visitWay(std::uint64_t id, std::vector<std::uint64_t>& node
     std::vector<GeoCoordinate> coordinates;
     coordinates.reserve(nodeIds.size());
     for (auto nodeId : nodeIds) {
-        coordinates.push_back(context_.nodeMap[nodeId]->coordinate);
+        // NOTE node can be missing when only part of the data is read.
+        auto nodePair = context_.nodeMap.find(nodeId);
+        if (nodePair != context_.nodeMap.end())
+            coordinates.push_back(nodePair->second->coordinate);
     }
 
-    if (coordinates.size() > 2 && isArea(tags)) {
+    // NOTE area detection relies on tags which may be not used by stylesheet.
+    bool isAreaTags = isArea(tags);
+    if (filter_ != nullptr)
+        filter_->apply(tags);
+
+    if (coordinates.size() > 2 && isAreaTags) {
         if (coordinates.at(0) == coordinates.at(coordinates.size() - 1)) {
             // NOTE three coordinates are invalid here: skip.
             // TODO should it be considered as way instead?
@@ -103,6 +118,13 @@ void OsmDataVisitor::visitWay(std::uint64_t id, std::vector<std::uint64_t>& node
 
 void OsmDataVisitor::visitRelation(std::uint64_t id, RelationMembers& members, utymap::formats::Tags& tags)
 {
+    if (filter_ != nullptr) {
+        // NOTE type is required to process relation.
+        tags.erase(std::remove_if(tags.begin(), tags.end(), [&](const utymap::formats::Tag& tag) {
+            return tag.key != "type" && !filter_->isUsed(tag);
+        }), tags.end());
+    }
+
     auto relation = std::make_shared<Relation>();
     relation->id = id;
     relation->tags = utymap::utils::convertTags(stringTable_, tags);
@@ -124,44 +146,99 @@ bool OsmDataVisitor::isArea(const utymap::formats::Tags& tags) const
     return false;
 }
 
-bool OsmDataVisitor::hasTag(const std::string& key, const std::string& value, const std::vector<utymap::entities::Tag>& tags) const
-{
-    return utymap::utils::hasTag(stringTable_.getId(key), stringTable_.getId(value), tags);
-}
-
-void OsmDataVisitor::resolve(Relation& relation)
+void OsmDataVisitor::resolve(Relation& relation, OsmDataContext::Removals& removals)
 {
     auto membersPair = relationMembers_.find(relation.id);
     // already resolved
     if (relation.elements.size() == membersPair->second.size())
         return;
 
-    auto resolveFunc = std::bind(&OsmDataVisitor::resolve, this, std::placeholders::_1);
+    auto resolveFunc = std::bind(&OsmDataVisitor::resolve, this, std::placeholders::_1, std::ref(removals));
 
-    if (hasTag("type", "multipolygon", relation.tags))
+    if (utymap::utils::hasTag(typeKey_, multipolygonValue_, relation.tags))
         MultipolygonProcessor(relation, membersPair->second, context_, resolveFunc).process();
-    else if (hasTag("type", "building", relation.tags))
-        BuildingProcessor(relation, membersPair->second, context_, resolveFunc).process();
+    else if (utymap::utils::hasTag(typeKey_, buildingValue_, relation.tags))
+        BuildingProcessor(relation, membersPair->second, context_, removals, resolveFunc).process();
     else {
         RelationProcessor(relation, membersPair->second, context_, resolveFunc).process();
     }
 }
 
-void OsmDataVisitor::complete()
+std::vector<std::vector<Relation*>> OsmDataVisitor::createRelationGroups() const
 {
-    // All relations are visited can start to resolve them
-    for (auto& membersPair : relationMembers_) {
+    // NOTE relations connected through relation members are put into the same group
+    // using union-find, so different groups can be resolved independently.
+    std::vector<Relation*> relations;
+    std::unordered_map<std::uint64_t, std::size_t> indices;
+    relations.reserve(relationMembers_.size());
+    for (const auto& membersPair : relationMembers_) {
         auto relationPair = context_.relationMap.find(membersPair.first);
-        if (relationPair != context_.relationMap.end())
-            resolve(*relationPair->second);
+        if (relationPair == context_.relationMap.end())
+            continue;
+        indices[membersPair.first] = relations.size();
+        relations.push_back(relationPair->second.get());
     }
 
+    std::vector<std::size_t> parents(relations.size());
+    for (std::size_t i = 0; i < parents.size(); ++i)
+        parents[i] = i;
+
+    auto findRoot = [&](std::size_t i) {
+        while (parents[i] != i)
+            i = parents[i] = parents[parents[i]];
+        return i;
+    };
+
+    for (const auto& membersPair : relationMembers_) {
+        auto indexPair = indices.find(membersPair.first);
+        if (indexPair == indices.end())
+            continue;
+        for (const auto& member : membersPair.second) {
+            if (member.type != "r")
+                continue;
+            auto memberPair = indices.find(member.refId);
+            if (memberPair != indices.end())
+                parents[findRoot(memberPair->second)] = findRoot(indexPair->second);
+        }
+    }
+
+    std::vector<std::vector<Relation*>> groups;
+    std::unordered_map<std::size_t, std::size_t> groupIndices;
+    for (std::size_t i = 0; i < relations.size(); ++i) {
+        auto groupPair = groupIndices.insert(std::make_pair(findRoot(i), groups.size()));
+        if (groupPair.second)
+            groups.push_back(std::vector<Relation*>());
+        groups[groupPair.first->second].push_back(relations[i]);
+    }
+
+    return groups;
+}
+
+void OsmDataVisitor::complete()
+{
+    typeKey_ = stringTable_.getId("type");
+    multipolygonValue_ = stringTable_.getId("multipolygon");
+    buildingValue_ = stringTable_.getId("building");
+
+    // All relations are visited can start to resolve them. Context is only read
+    // while groups are resolved in parallel, removals are applied afterwards.
+    auto groups = createRelationGroups();
+    std::vector<OsmDataContext::Removals> removals(groups.size());
+    utymap::utils::parallelFor(groups.size(), [&](std::size_t i) {
+        for (Relation* relation : groups[i])
+            resolve(*relation, removals[i]);
+    });
+
+    for (const auto& groupRemovals : removals)
+        groupRemovals.apply(context_);
+
     for (const auto& pair : context_.relationMap) {
         add_(*pair.second);
     }
 
     for (const auto& pair : context_.nodeMap) {
-        add_(*pair.second);
+        if (filter_ == nullptr || acceptedNodes_.find(pair.first) != acceptedNodes_.end())
+            add_(*pair.second);
     }
 
     for (const auto& pair : context_.wayMap) {
@@ -174,7 +251,8 @@ void OsmDataVisitor::complete()
   
 }
 
-OsmDataVisitor::OsmDataVisitor(StringTable& stringTable, std::function<bool(Element&)> add) 
-    : stringTable_(stringTable), add_(add), context_()
+OsmDataVisitor::OsmDataVisitor(StringTable& stringTable, std::function<bool(Element&)> add, const utymap::mapcss::ImportFilter* filter)
+    : stringTable_(stringTable), add_(add), filter_(filter), context_(), acceptedNodes_(),
+      typeKey_(0), multipolygonValue_(0), buildingValue_(0)
 {
 }
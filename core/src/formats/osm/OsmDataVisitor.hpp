@@ -7,6 +7,7 @@
 #include "formats/FormatTypes.hpp"
 #include "formats/osm/OsmDataContext.hpp"
 #include "index/StringTable.hpp"
+#include "mapcss/ImportFilter.hpp"
 #include "utils/ElementUtils.hpp"
 
 #include <functional>
@@ -22,8 +23,10 @@ class OsmDataVisitor
 {
 public:
 
+    // Creates visitor. If filter is specified, it is used to skip unused nodes and tags.
     OsmDataVisitor(utymap::index::StringTable& stringTable,
-                   std::function<bool(utymap::entities::Element&)> add);
+                   std::function<bool(utymap::entities::Element&)> add,
+                   const utymap::mapcss::ImportFilter* filter = nullptr);
 
     void visitBounds(utymap::BoundingBox bbox);
 
@@ -38,13 +41,18 @@ public:
 private:
 
     bool isArea(const utymap::formats::Tags& tags) const;
-    bool hasTag(const std::string& key, const std::string& value, const std::vector<utymap::entities::Tag>& tags) const;
-    void resolve(utymap::entities::Relation& relation);
+    void resolve(utymap::entities::Relation& relation, utymap::formats::OsmDataContext::Removals& removals);
+    std::vector<std::vector<utymap::entities::Relation*>> createRelationGroups() const;
     
     utymap::index::StringTable& stringTable_;
     std::function<bool(utymap::entities::Element&)> add_;
+    const utymap::mapcss::ImportFilter* filter_;
     utymap::formats::OsmDataContext context_;
     std::unordered_map<std::uint64_t, utymap::formats::RelationMembers> relationMembers_;
+    // Nodes which can be matched by filter. Other nodes are used only as geometry.
+    std::unordered_set<std::uint64_t> acceptedNodes_;
+    // String ids used to detect relation type.
+    std::uint32_t typeKey_, multipolygonValue_, buildingValue_;
 };
 
 }}
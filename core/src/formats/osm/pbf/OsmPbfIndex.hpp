@@ -0,0 +1,134 @@
+#ifndef FORMATS_PBF_OSMPBFINDEX_HPP_INCLUDED
+#define FORMATS_PBF_OSMPBFINDEX_HPP_INCLUDED
+
+#include "BoundingBox.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <limits>
+#include <vector>
+
+namespace utymap { namespace formats {
+
+// Describes blocks of pbf file: where they are located and what they contain.
+// Built once per file and stored as sidecar file to allow reading of subregions.
+struct OsmPbfIndex
+{
+    // Flags which describe block's content.
+    enum Content : std::uint8_t
+    {
+        Nodes = 1,
+        Ways = 2,
+        Relations = 4
+    };
+
+    struct Block
+    {
+        // Offset of blob header size in source stream.
+        std::uint64_t offset;
+        // Combination of content flags.
+        std::uint8_t content;
+        // Minimal node id in block.
+        std::uint64_t minNodeId;
+        // Maximum node id in block.
+        std::uint64_t maxNodeId;
+        // Bounding box of all nodes in block.
+        utymap::BoundingBox bbox;
+
+        Block() : offset(0), content(0),
+            minNodeId(std::numeric_limits<std::uint64_t>::max()), maxNodeId(0), bbox()
+        {
+        }
+
+        inline bool has(Content flag) const { return (content & flag) != 0; }
+    };
+
+    // Size of source file. Used to detect outdated index.
+    std::uint64_t sourceSize;
+    // Last modification time of source file in seconds since epoch. Used to
+    // detect outdated index if file is replaced with one of the same size.
+    std::int64_t sourceTime;
+    // Data blocks in order of their appearance in source file.
+    std::vector<Block> blocks;
+
+    OsmPbfIndex() : sourceSize(0), sourceTime(0), blocks()
+    {
+    }
+
+    // Writes index to stream.
+    void write(std::ostream& stream) const
+    {
+        stream.write(signature(), SignatureSize);
+        writeValue(stream, static_cast<std::uint32_t>(Version));
+        writeValue(stream, sourceSize);
+        writeValue(stream, sourceTime);
+        writeValue(stream, static_cast<std::uint64_t>(blocks.size()));
+        for (const auto& block : blocks) {
+            writeValue(stream, block.offset);
+            writeValue(stream, block.content);
+            writeValue(stream, block.minNodeId);
+            writeValue(stream, block.maxNodeId);
+            writeValue(stream, block.bbox.minPoint.latitude);
+            writeValue(stream, block.bbox.minPoint.longitude);
+            writeValue(stream, block.bbox.maxPoint.latitude);
+            writeValue(stream, block.bbox.maxPoint.longitude);
+        }
+    }
+
+    // Reads index from stream. Returns false if stream has unexpected content.
+    bool read(std::istream& stream)
+    {
+        char header[SignatureSize];
+        std::uint32_t version = 0;
+        std::uint64_t count = 0;
+
+        if (!stream.read(header, SignatureSize) ||
+            !std::equal(header, header + SignatureSize, signature()))
+            return false;
+
+        if (!readValue(stream, version) || version != Version ||
+            !readValue(stream, sourceSize) || !readValue(stream, sourceTime) ||
+            !readValue(stream, count))
+            return false;
+
+        blocks.clear();
+        blocks.reserve(static_cast<std::size_t>(count));
+        for (std::uint64_t i = 0; i < count; ++i) {
+            Block block;
+            if (!readValue(stream, block.offset) ||
+                !readValue(stream, block.content) ||
+                !readValue(stream, block.minNodeId) ||
+                !readValue(stream, block.maxNodeId) ||
+                !readValue(stream, block.bbox.minPoint.latitude) ||
+                !readValue(stream, block.bbox.minPoint.longitude) ||
+                !readValue(stream, block.bbox.maxPoint.latitude) ||
+                !readValue(stream, block.bbox.maxPoint.longitude))
+                return false;
+            blocks.push_back(block);
+        }
+        return true;
+    }
+
+private:
+    enum { SignatureSize = 4, Version = 2 };
+
+    static const char* signature() { return "UPBI"; }
+
+    template<typename T>
+    static void writeValue(std::ostream& stream, const T& value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    static bool readValue(std::istream& stream, T& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+};
+
+}}
+
+#endif  // FORMATS_PBF_OSMPBFINDEX_HPP_INCLUDED
@@ -3,14 +3,19 @@
 
 #include "BoundingBox.hpp"
 #include "formats/FormatTypes.hpp"
+#include "formats/osm/pbf/OsmPbfIndex.hpp"
 
 #include <fileformat.pb.h>
 #include <osmformat.pb.h>
 #include <zlib.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <istream>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace utymap { namespace formats {
 
@@ -53,6 +58,187 @@ public:
         }
     }
 
+    // Builds index of data blocks in given stream.
+    OsmPbfIndex buildIndex(std::istream& stream)
+    {
+        OsmPbfIndex index;
+        OSMPBF::PrimitiveBlock primblock;
+        finished_ = false;
+
+        while (!stream.eof() && !stream.fail() && !finished_) {
+            std::uint64_t offset = static_cast<std::uint64_t>(stream.tellg());
+            OSMPBF::BlobHeader header = readHeader(stream);
+            if (finished_)
+                break;
+
+            if (header.type() != "OSMData") {
+                stream.seekg(header.datasize(), std::ios::cur);
+                continue;
+            }
+
+            std::int32_t sz = readBlob(header, stream);
+            if (!primblock.ParseFromArray(unpack_buffer_, sz))
+                throw std::domain_error("Unable to parse primitive block");
+
+            OsmPbfIndex::Block block;
+            block.offset = offset;
+            for (int i = 0, l = primblock.primitivegroup_size(); i < l; i++) {
+                const OSMPBF::PrimitiveGroup& pg = primblock.primitivegroup(i);
+                visitNodes(primblock, pg, [&](uint64_t id, const GeoCoordinate& coordinate) {
+                    block.content |= OsmPbfIndex::Nodes;
+                    block.minNodeId = std::min(block.minNodeId, id);
+                    block.maxNodeId = std::max(block.maxNodeId, id);
+                    block.bbox.expand(coordinate);
+                    return false;
+                }, [](uint64_t, GeoCoordinate&, Tags&) {});
+
+                if (pg.ways_size() > 0)
+                    block.content |= OsmPbfIndex::Ways;
+                if (pg.relations_size() > 0)
+                    block.content |= OsmPbfIndex::Relations;
+            }
+            index.blocks.push_back(block);
+        }
+
+        stream.clear();
+        stream.seekg(0, std::ios::end);
+        index.sourceSize = static_cast<std::uint64_t>(stream.tellg());
+
+        return index;
+    }
+
+    // Parses only elements which are related to given bounding box:
+    // nodes inside it, ways which use these nodes and relations which refer to
+    // these ways or nodes together with their parent and member relations. All
+    // nodes and ways referenced by these elements are visited too. Only blocks
+    // which may contain necessary data are read.
+    void parse(std::istream& stream, Visitor& visitor, const OsmPbfIndex& index, const BoundingBox& bbox)
+    {
+        struct WayData { uint64_t id; std::vector<uint64_t> nodeIds; Tags tags; };
+        struct RelationData { uint64_t id; RelationMembers members; Tags tags; };
+
+        OSMPBF::PrimitiveBlock primblock;
+        std::unordered_set<uint64_t> nodeIds;
+        std::unordered_set<uint64_t> wayIds;
+        std::unordered_set<uint64_t> relationIds;
+        std::vector<WayData> ways;
+        std::vector<RelationData> relations;
+
+        // find nodes inside bounding box.
+        forEachBlock(stream, index, primblock, [&](const OsmPbfIndex::Block& block) {
+            return block.has(OsmPbfIndex::Nodes) && bbox.intersects(block.bbox);
+        }, [&](const OSMPBF::PrimitiveGroup& pg) {
+            visitNodes(primblock, pg, [&](uint64_t id, const GeoCoordinate& coordinate) {
+                if (bbox.contains(coordinate))
+                    nodeIds.insert(id);
+                return false;
+            }, [](uint64_t, GeoCoordinate&, Tags&) {});
+        });
+
+        // find ways which use these nodes.
+        std::vector<uint64_t> requiredNodeIds(nodeIds.begin(), nodeIds.end());
+        forEachBlock(stream, index, primblock, [](const OsmPbfIndex::Block& block) {
+            return block.has(OsmPbfIndex::Ways);
+        }, [&](const OSMPBF::PrimitiveGroup& pg) {
+            visitWays(pg, [&](const OSMPBF::Way& w, uint64_t id, std::vector<uint64_t>& refs) {
+                if (std::none_of(refs.begin(), refs.end(), [&](uint64_t ref) { return nodeIds.find(ref) != nodeIds.end(); }))
+                    return;
+                requiredNodeIds.insert(requiredNodeIds.end(), refs.begin(), refs.end());
+                addWay(ways, wayIds, primblock, w, id, refs);
+            });
+        });
+
+        // find relations which refer to already found nodes or ways and collect
+        // relation hierarchy in single pass.
+        std::unordered_map<uint64_t, std::vector<uint64_t>> parentIds;
+        std::unordered_map<uint64_t, std::vector<uint64_t>> childIds;
+        forEachBlock(stream, index, primblock, [](const OsmPbfIndex::Block& block) {
+            return block.has(OsmPbfIndex::Relations);
+        }, [&](const OSMPBF::PrimitiveGroup& pg) {
+            visitRelations(primblock, pg, [&](const OSMPBF::Relation&, uint64_t id, RelationMembers& members) {
+                for (const auto& member : members) {
+                    if (member.type == "r") {
+                        parentIds[member.refId].push_back(id);
+                        childIds[id].push_back(member.refId);
+                    }
+                    else if ((member.type == "n" && nodeIds.find(member.refId) != nodeIds.end()) ||
+                             (member.type == "w" && wayIds.find(member.refId) != wayIds.end()))
+                        relationIds.insert(id);
+                }
+            });
+        });
+
+        // NOTE relation may refer to relation defined later, so hierarchy is closed in
+        // memory: relations which contain found ones are added first, then all their members.
+        std::vector<uint64_t> pendingIds(relationIds.begin(), relationIds.end());
+        addLinkedRelations(pendingIds, relationIds, parentIds);
+        pendingIds.assign(relationIds.begin(), relationIds.end());
+        addLinkedRelations(pendingIds, relationIds, childIds);
+
+        // read found relations.
+        std::unordered_set<uint64_t> missingWayIds;
+        if (!relationIds.empty()) {
+            forEachBlock(stream, index, primblock, [](const OsmPbfIndex::Block& block) {
+                return block.has(OsmPbfIndex::Relations);
+            }, [&](const OSMPBF::PrimitiveGroup& pg) {
+                visitRelations(primblock, pg, [&](const OSMPBF::Relation& rel, uint64_t id, RelationMembers& members) {
+                    if (relationIds.find(id) == relationIds.end())
+                        return;
+
+                    for (const auto& member : members) {
+                        if (member.type == "n")
+                            requiredNodeIds.push_back(member.refId);
+                        else if (member.type == "w" && wayIds.find(member.refId) == wayIds.end())
+                            missingWayIds.insert(member.refId);
+                    }
+
+                    Tags tags;
+                    setTags(rel, primblock, tags);
+                    relations.push_back(RelationData{ id, std::move(members), std::move(tags) });
+                });
+            });
+        }
+
+        // find ways which are used by relations but do not use nodes inside bounding box.
+        if (!missingWayIds.empty()) {
+            forEachBlock(stream, index, primblock, [](const OsmPbfIndex::Block& block) {
+                return block.has(OsmPbfIndex::Ways);
+            }, [&](const OSMPBF::PrimitiveGroup& pg) {
+                visitWays(pg, [&](const OSMPBF::Way& w, uint64_t id, std::vector<uint64_t>& refs) {
+                    if (missingWayIds.find(id) == missingWayIds.end())
+                        return;
+                    requiredNodeIds.insert(requiredNodeIds.end(), refs.begin(), refs.end());
+                    addWay(ways, wayIds, primblock, w, id, refs);
+                });
+            });
+        }
+
+        // visit all required nodes reading only blocks which may contain them.
+        std::sort(requiredNodeIds.begin(), requiredNodeIds.end());
+        requiredNodeIds.erase(std::unique(requiredNodeIds.begin(), requiredNodeIds.end()), requiredNodeIds.end());
+        auto isRequired = [&](uint64_t id) {
+            return std::binary_search(requiredNodeIds.begin(), requiredNodeIds.end(), id);
+        };
+        forEachBlock(stream, index, primblock, [&](const OsmPbfIndex::Block& block) {
+            if (!block.has(OsmPbfIndex::Nodes))
+                return false;
+            auto it = std::lower_bound(requiredNodeIds.begin(), requiredNodeIds.end(), block.minNodeId);
+            return it != requiredNodeIds.end() && *it <= block.maxNodeId;
+        }, [&](const OSMPBF::PrimitiveGroup& pg) {
+            visitNodes(primblock, pg, [&](uint64_t id, const GeoCoordinate&) {
+                return isRequired(id);
+            }, [&](uint64_t id, GeoCoordinate& coordinate, Tags& tags) {
+                visitor.visitNode(id, coordinate, tags);
+            });
+        });
+
+        for (auto& way : ways)
+            visitor.visitWay(way.id, way.nodeIds, way.tags);
+
+        for (auto& relation : relations)
+            visitor.visitRelation(relation.id, relation.members, relation.tags);
+    }
+
 private:
 
     char* buffer_;
@@ -104,7 +290,7 @@ private:
         // uncompressed
         if (blob.has_raw()) {
             sz = static_cast<std::int32_t>(blob.raw().size());
-            memcpy(unpack_buffer_, buffer_, sz);
+            memcpy(unpack_buffer_, blob.raw().data(), sz);
             return sz;
         }
 
@@ -146,90 +332,181 @@ private:
             throw std::domain_error("Unable to parse primitive block");
 
         for (int i = 0, l = primblock.primitivegroup_size(); i < l; i++) {
-            OSMPBF::PrimitiveGroup pg = primblock.primitivegroup(i);
-
-            // simple nodes
-            for (int i = 0; i < pg.nodes_size(); ++i) {
-                OSMPBF::Node n = pg.nodes(i);
-                GeoCoordinate coordinate;
-                coordinate.latitude = 0.000000001 * (primblock.lat_offset() + (primblock.granularity() * n.lat()));
-                coordinate.longitude = 0.000000001 * (primblock.lon_offset() + (primblock.granularity() * n.lon()));
-                uint64_t id = n.id();
+            const OSMPBF::PrimitiveGroup& pg = primblock.primitivegroup(i);
+
+            visitNodes(primblock, pg, [](uint64_t, const GeoCoordinate&) { return true; },
+                [&](uint64_t id, GeoCoordinate& coordinate, Tags& tags) {
+                    visitor.visitNode(id, coordinate, tags);
+                });
+
+            visitWays(pg, [&](const OSMPBF::Way& w, uint64_t id, std::vector<uint64_t>& nodeIds) {
                 Tags tags;
-                setTags(n, primblock, tags);
-                visitor.visitNode(id, coordinate, tags);
+                setTags(w, primblock, tags);
+                visitor.visitWay(id, nodeIds, tags);
+            });
+
+            visitRelations(primblock, pg, [&](const OSMPBF::Relation& rel, uint64_t id, RelationMembers& refs) {
+                Tags tags;
+                setTags(rel, primblock, tags);
+                visitor.visitRelation(id, refs, tags);
+            });
+        }
+    }
+
+    // Reads primitive block located at given offset. Returns false if block has no data.
+    bool readPrimitiveBlock(std::istream& stream, std::uint64_t offset, OSMPBF::PrimitiveBlock& primblock)
+    {
+        stream.clear();
+        stream.seekg(offset);
+        finished_ = false;
+
+        OSMPBF::BlobHeader header = readHeader(stream);
+        if (finished_ || header.type() != "OSMData")
+            return false;
+
+        std::int32_t sz = readBlob(header, stream);
+        if (!primblock.ParseFromArray(unpack_buffer_, sz))
+            throw std::domain_error("Unable to parse primitive block");
+
+        return true;
+    }
+
+    // Reads blocks accepted by predicate and calls function for every primitive group.
+    template<typename Predicate, typename Function>
+    void forEachBlock(std::istream& stream, const OsmPbfIndex& index, OSMPBF::PrimitiveBlock& primblock,
+                      const Predicate& predicate, const Function& function)
+    {
+        for (const auto& block : index.blocks) {
+            if (!predicate(block) || !readPrimitiveBlock(stream, block.offset, primblock))
+                continue;
+
+            for (int i = 0, l = primblock.primitivegroup_size(); i < l; i++)
+                function(primblock.primitivegroup(i));
+        }
+    }
+
+    // Adds to ids relations reachable from pending ones through given links.
+    static void addLinkedRelations(std::vector<uint64_t>& pendingIds, std::unordered_set<uint64_t>& ids,
+                                   const std::unordered_map<uint64_t, std::vector<uint64_t>>& links)
+    {
+        while (!pendingIds.empty()) {
+            auto linkedIds = links.find(pendingIds.back());
+            pendingIds.pop_back();
+            if (linkedIds == links.end())
+                continue;
+
+            for (uint64_t id : linkedIds->second) {
+                if (ids.insert(id).second)
+                    pendingIds.push_back(id);
             }
+        }
+    }
 
-            // dense nodes
-            if (pg.has_dense()) {
-                OSMPBF::DenseNodes dn = pg.dense();
-                uint64_t id = 0;
-                double lon = 0;
-                double lat = 0;
+    template<typename WayData>
+    void addWay(std::vector<WayData>& ways, std::unordered_set<uint64_t>& wayIds, const OSMPBF::PrimitiveBlock& primblock,
+                const OSMPBF::Way& w, uint64_t id, std::vector<uint64_t>& nodeIds)
+    {
+        if (!wayIds.insert(id).second)
+            return;
+        Tags tags;
+        setTags(w, primblock, tags);
+        ways.push_back(WayData{ id, std::move(nodeIds), std::move(tags) });
+    }
 
-                int current_kv = 0;
+    // Visits simple and dense nodes. Tags are decoded only for nodes accepted by predicate.
+    template<typename Predicate, typename Function>
+    void visitNodes(const OSMPBF::PrimitiveBlock& primblock, const OSMPBF::PrimitiveGroup& pg,
+                    const Predicate& predicate, const Function& function)
+    {
+        // simple nodes
+        for (int i = 0; i < pg.nodes_size(); ++i) {
+            const OSMPBF::Node& n = pg.nodes(i);
+            GeoCoordinate coordinate;
+            coordinate.latitude = 0.000000001 * (primblock.lat_offset() + (primblock.granularity() * n.lat()));
+            coordinate.longitude = 0.000000001 * (primblock.lon_offset() + (primblock.granularity() * n.lon()));
+            uint64_t id = n.id();
+            if (!predicate(id, coordinate))
+                continue;
+            Tags tags;
+            setTags(n, primblock, tags);
+            function(id, coordinate, tags);
+        }
 
-                for (int i = 0; i < dn.id_size(); ++i) {
-                    id += dn.id(i);
-                    lat += 0.000000001 * (primblock.lat_offset() + (primblock.granularity() * dn.lat(i)));
-                    lon += 0.000000001 * (primblock.lon_offset() + (primblock.granularity() * dn.lon(i)));
+        // dense nodes
+        if (pg.has_dense()) {
+            const OSMPBF::DenseNodes& dn = pg.dense();
+            uint64_t id = 0;
+            double lon = 0;
+            double lat = 0;
 
-                    Tags tags;
-                    tags.reserve(2);
-                    while (current_kv < dn.keys_vals_size() && dn.keys_vals(current_kv) != 0) {
-                        auto key = dn.keys_vals(current_kv);
-                        auto val = dn.keys_vals(current_kv + 1);
+            int current_kv = 0;
+
+            for (int i = 0; i < dn.id_size(); ++i) {
+                id += dn.id(i);
+                lat += 0.000000001 * (primblock.lat_offset() + (primblock.granularity() * dn.lat(i)));
+                lon += 0.000000001 * (primblock.lon_offset() + (primblock.granularity() * dn.lon(i)));
+
+                GeoCoordinate coordinate(lat, lon);
+                bool isAccepted = predicate(id, coordinate);
+
+                Tags tags;
+                while (current_kv < dn.keys_vals_size() && dn.keys_vals(current_kv) != 0) {
+                    if (isAccepted) {
                         Tag tag;
-                        tag.key = primblock.stringtable().s(key);
-                        tag.value = primblock.stringtable().s(val);
-                        current_kv += 2;
+                        tag.key = primblock.stringtable().s(dn.keys_vals(current_kv));
+                        tag.value = primblock.stringtable().s(dn.keys_vals(current_kv + 1));
                         tags.push_back(tag);
                     }
-                    ++current_kv;
-                    GeoCoordinate coordinate(lat, lon);
-                    visitor.visitNode(id, coordinate, tags);
+                    current_kv += 2;
                 }
-            }
+                ++current_kv;
 
-            for (int i = 0; i < pg.ways_size(); ++i) {
-                OSMPBF::Way w = pg.ways(i);
-
-                uint64_t ref = 0;
-                std::vector<uint64_t> nodeIds;
-                nodeIds.reserve(w.refs_size());
-                for (int j = 0; j < w.refs_size(); ++j) {
-                    ref += w.refs(j);
-                    nodeIds.push_back(ref);
-                }
-                uint64_t id = w.id();
-                Tags tags;
-                setTags(w, primblock, tags);
-                visitor.visitWay(id, nodeIds, tags);
+                if (isAccepted)
+                    function(id, coordinate, tags);
             }
+        }
+    }
 
-            for (int i = 0; i < pg.relations_size(); ++i) {
-                OSMPBF::Relation rel = pg.relations(i);
-                uint64_t id = 0;
-                RelationMembers refs;
-                refs.reserve(rel.memids_size());
-                for (int l = 0; l < rel.memids_size(); ++l) {
-                    id += rel.memids(l);
-                    RelationMember member;
-                    member.refId = id;
-                    member.type = parseType(rel, l);
-                    member.role = primblock.stringtable().s(rel.roles_sid(l));
-                    refs.push_back(member);
-                }
+    // Visits ways with decoded node ids.
+    template<typename Function>
+    void visitWays(const OSMPBF::PrimitiveGroup& pg, const Function& function)
+    {
+        for (int i = 0; i < pg.ways_size(); ++i) {
+            const OSMPBF::Way& w = pg.ways(i);
+
+            uint64_t ref = 0;
+            std::vector<uint64_t> nodeIds;
+            nodeIds.reserve(w.refs_size());
+            for (int j = 0; j < w.refs_size(); ++j) {
+                ref += w.refs(j);
+                nodeIds.push_back(ref);
+            }
+            function(w, w.id(), nodeIds);
+        }
+    }
 
-                uint64_t rel_id = rel.id();
-                Tags tags;
-                setTags(rel, primblock, tags);
-                visitor.visitRelation(rel_id, refs, tags);
+    // Visits relations with decoded members.
+    template<typename Function>
+    void visitRelations(const OSMPBF::PrimitiveBlock& primblock, const OSMPBF::PrimitiveGroup& pg, const Function& function)
+    {
+        for (int i = 0; i < pg.relations_size(); ++i) {
+            const OSMPBF::Relation& rel = pg.relations(i);
+            uint64_t id = 0;
+            RelationMembers refs;
+            refs.reserve(rel.memids_size());
+            for (int l = 0; l < rel.memids_size(); ++l) {
+                id += rel.memids(l);
+                RelationMember member;
+                member.refId = id;
+                member.type = parseType(rel, l);
+                member.role = primblock.stringtable().s(rel.roles_sid(l));
+                refs.push_back(member);
             }
+            function(rel, rel.id(), refs);
         }
     }
 
-    inline std::string parseType(OSMPBF::Relation& rel, int index)
+    inline std::string parseType(const OSMPBF::Relation& rel, int index)
     {
         switch (rel.types(index)) {
         case OSMPBF::Relation::NODE:
@@ -243,7 +520,7 @@ private:
     }
 
     template<typename T>
-    void setTags(T object, const OSMPBF::PrimitiveBlock& primblock, Tags& tags)
+    void setTags(const T& object, const OSMPBF::PrimitiveBlock& primblock, Tags& tags)
     {
         tags.reserve(object.keys_size());
         for (int i = 0; i < object.keys_size(); ++i) {
@@ -10,6 +10,7 @@
 #include "entities/Relation.hpp"
 #include "formats/FormatTypes.hpp"
 #include "index/StringTable.hpp"
+#include "mapcss/ImportFilter.hpp"
 #include "utils/ElementUtils.hpp"
 
 #include <algorithm>
@@ -26,9 +27,13 @@ struct ShapeDataVisitor
     int areas;
     int relations;
 
-    ShapeDataVisitor(utymap::index::StringTable& stringTable, std::function<bool(utymap::entities::Element&)> functor) :
+    // Creates visitor. If filter is specified, it is used to skip unused elements and tags.
+    ShapeDataVisitor(utymap::index::StringTable& stringTable,
+                     std::function<bool(utymap::entities::Element&)> functor,
+                     const utymap::mapcss::ImportFilter* filter = nullptr) :
         stringTable_(stringTable),
         functor_(functor),
+        filter_(filter),
         nodes(0),
         ways(0),
         areas(0),
@@ -38,6 +43,9 @@ struct ShapeDataVisitor
 
     void visitNode(utymap::GeoCoordinate& coordinate, utymap::formats::Tags& tags)
     {
+        if (!accept(utymap::mapcss::ImportFilter::Node, tags))
+            return;
+
         utymap::entities::Node node;
         node.id = 0;
         node.coordinate = coordinate;
@@ -48,6 +56,9 @@ struct ShapeDataVisitor
 
     void visitWay(utymap::formats::Coordinates& coordinates, utymap::formats::Tags& tags, bool isRing)
     {
+        if (!accept(isRing ? utymap::mapcss::ImportFilter::Area : utymap::mapcss::ImportFilter::Way, tags))
+            return;
+
         if (isRing) {
             utymap::entities::Area area;
             area.id = 0;
@@ -68,6 +79,9 @@ struct ShapeDataVisitor
 
     void visitRelation(utymap::formats::PolygonMembers& members, utymap::formats::Tags& tags)
     {
+        if (!accept(utymap::mapcss::ImportFilter::Relation, tags))
+            return;
+
         utymap::entities::Relation relation;
         relation.id = 0;
         utymap::utils::setTags(stringTable_, relation, tags);
@@ -98,8 +112,23 @@ struct ShapeDataVisitor
     void complete() { }
 
 private:
+
+    // Checks whether element can be matched and removes unused tags.
+    bool accept(utymap::mapcss::ImportFilter::ElementType type, utymap::formats::Tags& tags) const
+    {
+        if (filter_ == nullptr)
+            return true;
+
+        if (!filter_->canMatch(type, tags))
+            return false;
+
+        filter_->apply(tags);
+        return true;
+    }
+
     utymap::index::StringTable& stringTable_;
     std::function<bool(utymap::entities::Element&)> functor_;
+    const utymap::mapcss::ImportFilter* filter_;
 };
 
 }}
@@ -4,8 +4,11 @@
 #include "GeoCoordinate.hpp"
 #include "entities/Element.hpp"
 #include "formats/FormatTypes.hpp"
+#include "formats/shape/ShapeReader.hpp"
 #include "shapefile/shapefil.h"
+#include "utils/ParallelUtils.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -17,42 +20,37 @@ namespace utymap { namespace formats {
 template<typename Visitor>
 class ShapeParser
 {
+    // Amount of records decoded by one worker task.
+    static const std::size_t ChunkSize = 256;
+    // Amount of chunks per worker decoded before visiting.
+    static const std::size_t ChunksPerWorker = 4;
+
 public:
 
     void parse(const std::string& path, Visitor& visitor) const
     {
-        SHPHandle shpFile = SHPOpen(path.c_str(), "rb");
-        if (shpFile == NULL)
-            throw std::domain_error("Cannot open shp file.");
-
-        int shapeType, entityCount;
-        double adfMinBound[4], adfMaxBound[4];
-        SHPGetInfo(shpFile, &entityCount, &shapeType, adfMinBound, adfMaxBound);
-
-        DBFHandle dbfFile = DBFOpen(path.c_str(), "rb");
-        if (dbfFile == NULL)
-            throw std::domain_error("Cannot open dbf file.");
-
-        if (DBFGetFieldCount(dbfFile) == 0)
-            throw std::domain_error("There are no fields in dbf table.");
-
-        if (entityCount != DBFGetRecordCount(dbfFile))
-            throw std::domain_error("dbf file has different entity count.");
-
-        for (int k = 0; k < entityCount; k++)
-        {
-            SHPObject* shape = SHPReadObject(shpFile, k);
-            if (shape == NULL)
-                throw std::domain_error("Unable to read shape:" + to_string(k));
-
-            Tags tags = parseTags(dbfFile, k);
-            visitShape(*shape, tags, visitor);
-
-            SHPDestroyObject(shape);
+        ShapeReader reader(path);
+
+        std::size_t entityCount = reader.size();
+        std::size_t batchSize = std::min(entityCount, ChunkSize * ChunksPerWorker * utymap::utils::getWorkerCount());
+        std::vector<ShapeRecord> records(batchSize);
+        std::vector<char> states(batchSize);
+
+        // NOTE records are decoded in parallel but visited in original order.
+        for (std::size_t start = 0; start < entityCount; start += batchSize) {
+            std::size_t count = std::min(batchSize, entityCount - start);
+            utymap::utils::parallelFor((count + ChunkSize - 1) / ChunkSize, [&](std::size_t chunk) {
+                std::size_t end = std::min(count, (chunk + 1) * ChunkSize);
+                for (std::size_t i = chunk * ChunkSize; i < end; ++i)
+                    states[i] = reader.read(start + i, records[i]);
+            });
+
+            for (std::size_t i = 0; i < count; ++i) {
+                if (!states[i])
+                    throw std::domain_error("Unable to read shape:" + to_string(start + i));
+                visitShape(records[i], visitor);
+            }
         }
-
-        DBFClose(dbfFile);
-        SHPClose(shpFile);
     }
 
 private:
@@ -65,116 +63,74 @@ private:
         return sstr.str();
     }
 
-    inline Tags parseTags(DBFHandle dbfFile, int k) const
+    inline void visitShape(ShapeRecord& shape, Visitor& visitor) const
     {
-        char title[12];
-        int fieldCount = DBFGetFieldCount(dbfFile);
-        Tags tags;
-        tags.reserve(fieldCount);
-        for (int i = 0; i < fieldCount; i++)
-        {
-            if (DBFIsAttributeNULL(dbfFile, k, i))
-                continue;
-
-            utymap::formats::Tag tag;
-            int width, decimals;
-            DBFFieldType eType = DBFGetFieldInfo(dbfFile, i, title, &width, &decimals);
-            tag.key = std::string(title);
-            {
-                switch (eType)
-                {
-                    case FTString:
-                        tag.value = DBFReadStringAttribute(dbfFile, k, i);
-                        break;
-                    case FTInteger:
-                        tag.value = to_string(DBFReadIntegerAttribute(dbfFile, k, i));
-                        break;
-                    case FTDouble:
-                        tag.value = to_string(DBFReadDoubleAttribute(dbfFile, k, i));
-                        break;
-                    default:
-                        break;
-                }
-            }
-            tags.push_back(tag);
-        }
-        return std::move(tags);
-    }
-
-    inline void visitShape(const SHPObject& shape, Tags& tags, Visitor& visitor) const
-    {
-        switch (shape.nSHPType)
+        switch (shape.type)
         {
             case SHPT_POINT:
             case SHPT_POINTM:
             case SHPT_POINTZ:
-                visitPoint(shape, tags, visitor);
+                visitPoint(shape, visitor);
                 break;
             case SHPT_ARC:
             case SHPT_ARCZ:
             case SHPT_ARCM:
-                visitArc(shape, tags, visitor);
+                visitArc(shape, visitor);
                 break;
             case SHPT_POLYGON:
             case SHPT_POLYGONZ:
             case SHPT_POLYGONM:
-                visitPolygon(shape, tags, visitor);
+                visitPolygon(shape, visitor);
                 break;
             case SHPT_MULTIPOINT:
             case SHPT_MULTIPOINTZ:
             case SHPT_MULTIPOINTM:
             case SHPT_MULTIPATCH:
-                std::cerr << "Unsupported shape type:" << SHPTypeName(shape.nSHPType);
+                std::cerr << "Unsupported shape type:" << SHPTypeName(shape.type);
                 break;
             default:
-                std::cerr << "Unknown shape type:" << SHPTypeName(shape.nSHPType);
+                std::cerr << "Unknown shape type:" << SHPTypeName(shape.type);
                 break;
         }
     }
 
-    inline void visitPoint(const SHPObject& shape, Tags& tags, Visitor& visitor) const
+    inline void visitPoint(ShapeRecord& shape, Visitor& visitor) const
     {
-        utymap::GeoCoordinate coordinate(shape.padfY[0], shape.padfX[0]);
-        visitor.visitNode(coordinate, tags);
+        visitor.visitNode(shape.coordinates[0], shape.tags);
     }
 
-    inline void visitArc(const SHPObject& shape, Tags& tags, Visitor& visitor) const
+    inline void visitArc(ShapeRecord& shape, Visitor& visitor) const
     {
-        if (shape.nParts > 1) {
+        if (shape.parts.size() > 1) {
             std::cerr << "Arc type has more than one part.";
             return;
         }
 
-        std::vector<utymap::GeoCoordinate> coordinates;
-        coordinates.reserve(shape.nVertices);
-        for (int i = 0; i < shape.nVertices; ++i) {
-            coordinates.push_back(utymap::GeoCoordinate(shape.padfY[i], shape.padfX[i]));
-        }
+        if (shape.coordinates.empty())
+            return;
 
-        visitor.visitWay(coordinates, tags,coordinates[0] == coordinates[coordinates.size() - 1]);
+        bool isRing = shape.coordinates[0] == shape.coordinates[shape.coordinates.size() - 1];
+        visitor.visitWay(shape.coordinates, shape.tags, isRing);
     }
 
-    inline void visitPolygon(const SHPObject& shape, Tags& tags, Visitor& visitor) const
+    inline void visitPolygon(ShapeRecord& shape, Visitor& visitor) const
     {
         PolygonMembers members;
-        members.reserve(shape.nParts);
-        std::vector<GeoCoordinate>* coordinates;
-        for (int i = 0, partNum = 0; i < shape.nVertices; ++i) {
-            int startIndex = shape.panPartStart[partNum];
-            if (partNum < shape.nParts && startIndex == i) {
-                members.push_back(PolygonMember());
-                // TODO check inner/outer? Check whether this flag is true for closed polygon only
-                members[partNum].isRing = shape.panPartType[partNum] == SHPP_RING;
-                coordinates = &members[partNum].coordinates;
-                int endIndex = partNum == shape.nParts - 1
-                    ? shape.nVertices
-                    : shape.panPartStart[partNum + 1];
-                coordinates->reserve(endIndex - startIndex);
-                partNum++;
-            }
-            coordinates->push_back(utymap::GeoCoordinate(shape.padfY[i], shape.padfX[i]));
+        members.reserve(shape.parts.size());
+        for (std::size_t i = 0; i < shape.parts.size(); ++i) {
+            auto begin = shape.coordinates.begin() + shape.parts[i];
+            auto end = i == shape.parts.size() - 1
+                ? shape.coordinates.end()
+                : shape.coordinates.begin() + shape.parts[i + 1];
+            if (begin >= end)
+                break;
+
+            members.push_back(PolygonMember());
+            // TODO check inner/outer? Check whether this flag is true for closed polygon only
+            members.back().isRing = true;
+            members.back().coordinates.assign(begin, end);
         }
-        visitor.visitRelation(members, tags);
+        visitor.visitRelation(members, shape.tags);
     }
 };
 
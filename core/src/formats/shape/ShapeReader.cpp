@@ -0,0 +1,397 @@
+#include "formats/shape/ShapeReader.hpp"
+#include "shapefile/shapefil.h"
+#include "utils/MappedFile.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+using namespace utymap;
+using namespace utymap::formats;
+using namespace utymap::utils;
+
+namespace {
+    const std::size_t ShpHeaderSize = 100;
+    const std::size_t DbfHeaderSize = 32;
+    const std::size_t DbfFieldSize = 32;
+    const int MaxPoints = 50 * 1000 * 1000;
+    const int MaxParts = 10 * 1000 * 1000;
+
+    inline std::int32_t readBigInt32(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<std::int32_t>(
+            (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+            (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]));
+    }
+
+    inline std::uint32_t readLittleUInt32(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    inline std::int32_t readLittleInt32(const char* data)
+    {
+        return static_cast<std::int32_t>(readLittleUInt32(data));
+    }
+
+    inline std::uint16_t readLittleUInt16(const char* data)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+    }
+
+    inline double readLittleDouble(const char* data)
+    {
+        std::uint64_t bits = static_cast<std::uint64_t>(readLittleUInt32(data)) |
+                             (static_cast<std::uint64_t>(readLittleUInt32(data + 4)) << 32);
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    // Strips extension from path as shapelib does.
+    std::string getBasePath(const std::string& path)
+    {
+        std::size_t dot = path.find_last_of('.');
+        std::size_t separator = path.find_last_of("/\\");
+        if (dot != std::string::npos && (separator == std::string::npos || dot > separator))
+            return path.substr(0, dot);
+        return path;
+    }
+
+    // Opens file with given extension trying lower and upper case variants.
+    std::unique_ptr<MappedFile> openFile(const std::string& basePath, const std::string& lower, const std::string& upper)
+    {
+        if (MappedFile::exists(basePath + lower))
+            return std::unique_ptr<MappedFile>(new MappedFile(basePath + lower));
+        if (MappedFile::exists(basePath + upper))
+            return std::unique_ptr<MappedFile>(new MappedFile(basePath + upper));
+        return nullptr;
+    }
+
+    // Describes dbf table column.
+    struct DbfField
+    {
+        std::string name;
+        char type;
+        DBFFieldType fieldType;
+        std::size_t offset;
+        std::size_t size;
+    };
+}
+
+class ShapeReader::ShapeReaderImpl
+{
+public:
+
+    ShapeReaderImpl(const std::string& path) : recordCount_(0), dbfRecordCount_(0), dbfHeaderSize_(0),
+        dbfRecordSize_(0), fields_()
+    {
+        std::string basePath = getBasePath(path);
+
+        shp_ = openFile(basePath, ".shp", ".SHP");
+        shx_ = openFile(basePath, ".shx", ".SHX");
+        if (shp_ == nullptr || shx_ == nullptr || !readShxHeader())
+            throw std::domain_error("Cannot open shp file.");
+
+        dbf_ = openFile(basePath, ".dbf", ".DBF");
+        if (dbf_ == nullptr || !readDbfHeader())
+            throw std::domain_error("Cannot open dbf file.");
+
+        if (fields_.empty())
+            throw std::domain_error("There are no fields in dbf table.");
+
+        if (recordCount_ != dbfRecordCount_)
+            throw std::domain_error("dbf file has different entity count.");
+    }
+
+    std::size_t size() const
+    {
+        return recordCount_;
+    }
+
+    bool read(std::size_t index, ShapeRecord& record) const
+    {
+        record.type = SHPT_NULL;
+        record.parts.clear();
+        record.coordinates.clear();
+        record.tags.clear();
+
+        return index < recordCount_ && readShape(index, record) && readTags(index, record.tags);
+    }
+
+private:
+
+    bool readShxHeader()
+    {
+        const char* data = shx_->data();
+        if (shx_->size() < ShpHeaderSize || shp_->size() < ShpHeaderSize ||
+            data[0] != 0 || data[1] != 0 || data[2] != 0x27 || (data[3] != 0x0a && data[3] != 0x0d))
+            return false;
+
+        std::int64_t count = (static_cast<std::int64_t>(readBigInt32(data + 24)) * 2 -
+                              static_cast<std::int64_t>(ShpHeaderSize)) / 8;
+        if (count < 0 || ShpHeaderSize + static_cast<std::size_t>(count) * 8 > shx_->size())
+            return false;
+
+        recordCount_ = static_cast<std::size_t>(count);
+        return true;
+    }
+
+    bool readDbfHeader()
+    {
+        const char* data = dbf_->data();
+        if (dbf_->size() < DbfHeaderSize)
+            return false;
+
+        dbfRecordCount_ = readLittleUInt32(data + 4);
+        dbfHeaderSize_ = readLittleUInt16(data + 8);
+        dbfRecordSize_ = readLittleUInt16(data + 10);
+        if (dbfHeaderSize_ < DbfHeaderSize || dbfHeaderSize_ > dbf_->size())
+            return false;
+
+        std::size_t fieldCount = (dbfHeaderSize_ - DbfHeaderSize) / DbfFieldSize;
+        fields_.reserve(fieldCount);
+        std::size_t offset = 1;
+        for (std::size_t i = 0; i < fieldCount; ++i) {
+            const char* info = data + DbfHeaderSize + i * DbfFieldSize;
+            DbfField field;
+
+            char name[12];
+            std::strncpy(name, info, 11);
+            name[11] = '\0';
+            for (int j = 10; j > 0 && name[j] == ' '; --j)
+                name[j] = '\0';
+            field.name = name;
+
+            field.type = info[11];
+            field.size = static_cast<unsigned char>(info[16]);
+            int decimals = field.type == 'N' || field.type == 'F' ? static_cast<unsigned char>(info[17]) : 0;
+            if (field.type == 'L')
+                field.fieldType = FTLogical;
+            else if (field.type == 'N' || field.type == 'F')
+                field.fieldType = decimals > 0 || field.size > 10 ? FTDouble : FTInteger;
+            else
+                field.fieldType = FTString;
+
+            field.offset = offset;
+            offset += field.size;
+            fields_.push_back(field);
+        }
+        return true;
+    }
+
+    bool readShape(std::size_t index, ShapeRecord& record) const
+    {
+        const char* entry = shx_->data() + ShpHeaderSize + index * 8;
+        std::int64_t offset = static_cast<std::int64_t>(readBigInt32(entry)) * 2;
+        std::int64_t size = static_cast<std::int64_t>(readBigInt32(entry + 4)) * 2 + 8;
+        if (offset < 0 || size < 12 || offset + size > static_cast<std::int64_t>(shp_->size()))
+            return false;
+
+        const char* data = shp_->data() + offset;
+        record.type = readLittleInt32(data + 8);
+
+        switch (record.type)
+        {
+            case SHPT_ARC:
+            case SHPT_ARCZ:
+            case SHPT_ARCM:
+            case SHPT_POLYGON:
+            case SHPT_POLYGONZ:
+            case SHPT_POLYGONM:
+            case SHPT_MULTIPATCH:
+                return readParts(data, size, record);
+            case SHPT_MULTIPOINT:
+            case SHPT_MULTIPOINTZ:
+            case SHPT_MULTIPOINTM:
+                return readMultiPoint(data, size, record);
+            case SHPT_POINT:
+            case SHPT_POINTZ:
+            case SHPT_POINTM:
+                if (20 + 8 + (record.type == SHPT_POINTZ ? 8 : 0) > size)
+                    return false;
+                record.coordinates.push_back(GeoCoordinate(readLittleDouble(data + 20), readLittleDouble(data + 12)));
+                return true;
+            default:
+                return true;
+        }
+    }
+
+    bool readParts(const char* data, std::int64_t size, ShapeRecord& record) const
+    {
+        if (40 + 8 + 4 > size)
+            return false;
+
+        std::int32_t pointCount = readLittleInt32(data + 48);
+        std::int32_t partCount = readLittleInt32(data + 44);
+        if (pointCount < 0 || partCount < 0 || pointCount > MaxPoints || partCount > MaxParts)
+            return false;
+
+        std::int64_t requiredSize = 44 + 8 + 4 * static_cast<std::int64_t>(partCount) + 16 * static_cast<std::int64_t>(pointCount);
+        if (record.type == SHPT_POLYGONZ || record.type == SHPT_ARCZ || record.type == SHPT_MULTIPATCH)
+            requiredSize += 16 + 8 * static_cast<std::int64_t>(pointCount);
+        if (record.type == SHPT_MULTIPATCH)
+            requiredSize += 4 * static_cast<std::int64_t>(partCount);
+        if (requiredSize > size)
+            return false;
+
+        record.parts.reserve(partCount);
+        for (std::int32_t i = 0; i < partCount; ++i) {
+            int start = readLittleInt32(data + 52 + 4 * i);
+            if (start < 0 || (start >= pointCount && pointCount > 0) ||
+                (i > 0 && start <= record.parts.back()))
+                return false;
+            record.parts.push_back(start);
+        }
+
+        const char* points = data + 52 + 4 * partCount;
+        if (record.type == SHPT_MULTIPATCH)
+            points += 4 * partCount;
+
+        readPoints(points, pointCount, record);
+        return true;
+    }
+
+    bool readMultiPoint(const char* data, std::int64_t size, ShapeRecord& record) const
+    {
+        if (44 + 4 > size)
+            return false;
+
+        std::int32_t pointCount = readLittleInt32(data + 44);
+        if (pointCount < 0 || pointCount > MaxPoints)
+            return false;
+
+        std::int64_t requiredSize = 48 + 16 * static_cast<std::int64_t>(pointCount);
+        if (record.type == SHPT_MULTIPOINTZ)
+            requiredSize += 16 + 8 * static_cast<std::int64_t>(pointCount);
+        if (requiredSize > size)
+            return false;
+
+        readPoints(data + 48, pointCount, record);
+        return true;
+    }
+
+    void readPoints(const char* points, std::int32_t pointCount, ShapeRecord& record) const
+    {
+        record.coordinates.reserve(pointCount);
+        for (std::int32_t i = 0; i < pointCount; ++i) {
+            const char* point = points + 16 * i;
+            record.coordinates.push_back(GeoCoordinate(readLittleDouble(point + 8), readLittleDouble(point)));
+        }
+    }
+
+    bool readTags(std::size_t index, Tags& tags) const
+    {
+        std::size_t offset = dbfHeaderSize_ + dbfRecordSize_ * index;
+        if (offset + dbfRecordSize_ > dbf_->size())
+            return false;
+
+        const char* data = dbf_->data() + offset;
+        tags.reserve(fields_.size());
+        for (const auto& field : fields_) {
+            if (field.offset + field.size > dbfRecordSize_)
+                return false;
+
+            const char* begin = data + field.offset;
+            const char* end = static_cast<const char*>(std::memchr(begin, '\0', field.size));
+            if (end == nullptr)
+                end = begin + field.size;
+
+            // NOTE values are trimmed as shapelib does it with TRIM_DBF_WHITESPACE.
+            while (begin < end && *begin == ' ') ++begin;
+            while (end > begin && *(end - 1) == ' ') --end;
+
+            if (isNull(field.type, begin, end))
+                continue;
+
+            Tag tag;
+            tag.key = field.name;
+            switch (field.fieldType)
+            {
+                case FTString:
+                    tag.value.assign(begin, end);
+                    break;
+                case FTInteger:
+                    tag.value = formatValue("%d", static_cast<int>(parseDouble(begin, end)));
+                    break;
+                case FTDouble:
+                    tag.value = formatValue("%g", parseDouble(begin, end));
+                    break;
+                default:
+                    break;
+            }
+            tags.push_back(std::move(tag));
+        }
+        return true;
+    }
+
+    static bool isNull(char type, const char* begin, const char* end)
+    {
+        switch (type)
+        {
+            case 'N':
+            case 'F':
+                return begin == end || *begin == '*';
+            case 'D':
+                return end - begin >= 8 && std::strncmp(begin, "00000000", 8) == 0;
+            case 'L':
+                return begin != end && *begin == '?';
+            default:
+                return begin == end;
+        }
+    }
+
+    static double parseDouble(const char* begin, const char* end)
+    {
+        char buffer[256];
+        std::size_t length = std::min(static_cast<std::size_t>(end - begin), sizeof(buffer) - 1);
+        std::memcpy(buffer, begin, length);
+        buffer[length] = '\0';
+        return std::strtod(buffer, nullptr);
+    }
+
+    template <typename T>
+    static std::string formatValue(const char* format, T value)
+    {
+        char buffer[32];
+        int length = std::snprintf(buffer, sizeof(buffer), format, value);
+        return std::string(buffer, length > 0 ? static_cast<std::size_t>(length) : 0);
+    }
+
+    std::unique_ptr<MappedFile> shp_;
+    std::unique_ptr<MappedFile> shx_;
+    std::unique_ptr<MappedFile> dbf_;
+
+    std::size_t recordCount_;
+    std::size_t dbfRecordCount_;
+    std::size_t dbfHeaderSize_;
+    std::size_t dbfRecordSize_;
+    std::vector<DbfField> fields_;
+};
+
+ShapeReader::ShapeReader(const std::string& path) :
+    pimpl_(new ShapeReaderImpl(path))
+{
+}
+
+ShapeReader::~ShapeReader()
+{
+}
+
+std::size_t ShapeReader::size() const
+{
+    return pimpl_->size();
+}
+
+bool ShapeReader::read(std::size_t index, ShapeRecord& record) const
+{
+    return pimpl_->read(index, record);
+}
@@ -0,0 +1,54 @@
+#ifndef FORMATS_SHAPE_SHAPEREADER_HPP_INCLUDED
+#define FORMATS_SHAPE_SHAPEREADER_HPP_INCLUDED
+
+#include "GeoCoordinate.hpp"
+#include "formats/FormatTypes.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace utymap { namespace formats {
+
+// Represents decoded shape with its attributes.
+struct ShapeRecord
+{
+    // Shape type as defined by shapefile specification.
+    int type;
+    // Start indices of parts in coordinates.
+    std::vector<int> parts;
+    // Shape coordinates.
+    std::vector<utymap::GeoCoordinate> coordinates;
+    // Attributes from dbf table.
+    Tags tags;
+
+    ShapeRecord() : type(0), parts(), coordinates(), tags()
+    {
+    }
+};
+
+// Reads shapes and their attributes from memory mapped shp, shx and dbf files.
+// Records are decoded independently, so read can be called from different threads.
+class ShapeReader
+{
+public:
+    // Opens shapefile with given path. Extension is optional.
+    explicit ShapeReader(const std::string& path);
+
+    ~ShapeReader();
+
+    // Returns amount of records.
+    std::size_t size() const;
+
+    // Reads record with given index. Returns false if record is corrupted.
+    bool read(std::size_t index, ShapeRecord& record) const;
+
+private:
+    class ShapeReaderImpl;
+    std::unique_ptr<ShapeReaderImpl> pimpl_;
+};
+
+}}
+
+#endif  // FORMATS_SHAPE_SHAPEREADER_HPP_INCLUDED
@@ -12,11 +12,14 @@
 #include <stdexcept>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <iomanip>
 
 namespace utymap { namespace heightmap {
 
 // Provides the way to get elevation for given location from SRTM data.
+// Cells are loaded on demand under lock, so provider can be used by
+// several threads at the same time.
 class SrtmElevationProvider : public ElevationProvider
 {
     struct HgtCellKey
@@ -62,6 +65,8 @@ public:
 
     void preload(const utymap::BoundingBox& bbox)
     {
+        std::lock_guard<std::mutex> lock(lock_);
+
         int minLat = (int)bbox.minPoint.latitude;
         int minLon = (int)bbox.minPoint.longitude;
 
@@ -72,17 +77,8 @@ public:
         int lonDiff = maxLon - minLon;
 
         for (int j = 0; j <= latDiff; j++)
-            for (int i = 0; i <= lonDiff; i++) {
-                HgtCellKey cellKey(minLat + j, minLon + i);
-
-                if (cells_.find(cellKey) != cells_.end()) 
-                    continue;
-
-                std::string path = getFilePath(cellKey);
-                CellPtr cell = readCell(path);
-                // TODO limit loaded cells.
-                cells_[cellKey] = cell;
-            }
+            for (int i = 0; i <= lonDiff; i++)
+                findCell(HgtCellKey(minLat + j, minLon + i));
     }
 
     double getElevation(const utymap::GeoCoordinate& coordinate) const { return getElevationImpl(coordinate.latitude, coordinate.longitude); };
@@ -99,7 +95,11 @@ private:
         double secondsLat = (latitude - latDec) * 3600;
         double secondsLon = (longitude - lonDec) * 3600;
 
-        auto cell = cells_.find(HgtCellKey(latDec, lonDec))->second;
+        CellPtr cell;
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            cell = findCell(HgtCellKey(latDec, lonDec));
+        }
 
         // load tile
         //X coresponds to x/y values,
@@ -138,6 +138,19 @@ private:
         return height0*dy*(1 - dx) + height1*dy*(dx)+height2*(1 - dy)*(1 - dx) + height3*(1 - dy)*dx;
     }
 
+    // Finds cell or loads it if it is not loaded yet. Should be called under lock.
+    CellPtr findCell(const HgtCellKey& cellKey) const
+    {
+        auto pair = cells_.find(cellKey);
+        if (pair != cells_.end())
+            return pair->second;
+
+        CellPtr cell = readCell(getFilePath(cellKey));
+        // TODO limit loaded cells.
+        cells_[cellKey] = cell;
+        return cell;
+    }
+
     inline int readPx(CellPtr cell, int y, int x) const
     {
         int pos = cell->offset + 2 * (x - cell->totalPx*y);
@@ -189,7 +202,8 @@ private:
         return stream.str();
     }
 
-    std::map<HgtCellKey, CellPtr> cells_;
+    mutable std::map<HgtCellKey, CellPtr> cells_;
+    mutable std::mutex lock_;
     std::string dataDirectory_;
     int maxCacheSize_;
 };
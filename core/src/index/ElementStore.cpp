@@ -8,12 +8,34 @@
 #include "formats/FormatTypes.hpp"
 #include "index/ElementGeometryClipper.hpp"
 
+#include <algorithm>
+
 using namespace utymap;
 using namespace utymap::entities;
 using namespace utymap::formats;
 using namespace utymap::mapcss;
 
 namespace {
+    // Reports copy of visited element.
+    class ElementCopyVisitor : public ElementVisitor
+    {
+    public:
+        ElementCopyVisitor(const utymap::index::ElementStore::ElementCallback& callback) : callback_(callback)
+        {
+        }
+
+        void visitNode(const Node& node) { callback_(std::make_shared<Node>(node)); }
+
+        void visitWay(const Way& way) { callback_(std::make_shared<Way>(way)); }
+
+        void visitArea(const Area& area) { callback_(std::make_shared<Area>(area)); }
+
+        void visitRelation(const Relation& relation) { callback_(std::make_shared<Relation>(relation)); }
+
+    private:
+        const utymap::index::ElementStore::ElementCallback& callback_;
+    };
+
     const static std::string ClipKey = "clip";
     const static std::string SkipKey = "skip";
     const static std::string SizeKey = "size";
@@ -53,7 +75,8 @@ namespace utymap { namespace index {
 ElementStore::ElementStore(StringTable& stringTable) :
     clipKeyId_(stringTable.getId(ClipKey)),
     skipKeyId_(stringTable.getId(SkipKey)),
-    sizeKeyId_(stringTable.getId(SizeKey))
+    sizeKeyId_(stringTable.getId(SizeKey)),
+    revision_(14695981039346656037ULL)
 {
 }
 
@@ -61,6 +84,45 @@ ElementStore::~ElementStore()
 {
 }
 
+void ElementStore::hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const
+{
+    for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+        if (hasData(quadKeys[i]))
+            results[i] = true;
+    }
+}
+
+void ElementStore::search(const utymap::QuadKey& quadKey, const ElementCallback& callback)
+{
+    ElementCopyVisitor visitor(callback);
+    search(quadKey, visitor);
+}
+
+std::uint64_t ElementStore::getRevision() const
+{
+    return revision_;
+}
+
+void ElementStore::updateRevision(const std::string& change)
+{
+    std::uint64_t revision = revision_;
+    for (char c : change) {
+        revision ^= static_cast<unsigned char>(c);
+        revision *= 1099511628211ULL;
+    }
+    revision_ = revision;
+    saveRevision(revision);
+}
+
+void ElementStore::setRevision(std::uint64_t revision)
+{
+    revision_ = revision;
+}
+
+void ElementStore::saveRevision(std::uint64_t)
+{
+}
+
 bool ElementStore::store(const Element& element, const utymap::LodRange& range, const StyleProvider& styleProvider)
 {
     return store(element, range, styleProvider, [&](const BoundingBox&, const BoundingBox&) {
@@ -95,10 +157,14 @@ bool ElementStore::store(const Element& element, const LodRange& range, const St
     ElementGeometryClipper geometryClipper(std::bind(&ElementStore::storeImpl, this, _1, _2));
     bool wasStored = false;
     double size = -1; // match all by default
+    auto styles = styleProvider.forLevelsOfDetails(element);
     for (int lod = range.start; lod <= range.end; ++lod) {
-        if (!styleProvider.hasStyle(element, lod))
+        std::uint32_t lodBit = 1u << lod;
+        auto lodStyle = std::find_if(styles.begin(), styles.end(),
+            [lodBit](const StyleProvider::LodStyle& s) { return (s.lodMask & lodBit) != 0; });
+        if (lodStyle == styles.end())
             continue;
-        Style style = styleProvider.forElement(element, lod);
+        const Style& style = lodStyle->style;
         if (style.has(skipKeyId_, "true")) continue;
 
         // initialize bounding box and size only once
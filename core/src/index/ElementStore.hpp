@@ -9,8 +9,12 @@
 #include "formats/FormatTypes.hpp"
 #include "mapcss/StyleProvider.hpp"
 
+#include <atomic>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace utymap { namespace index {
 
@@ -18,17 +22,30 @@ namespace utymap { namespace index {
 class ElementStore
 {
 public:
+    // Called for found element. Element is shared, so it can be kept after search.
+    typedef std::function<void(const std::shared_ptr<const utymap::entities::Element>&)> ElementCallback;
+
     ElementStore(utymap::index::StringTable& stringTable);
 
     virtual ~ElementStore();
 
-    // Searches for elements for given quadKey
+    // Searches for elements for given quadKey. Can be called concurrently
+    // with other searches, but not with storing.
     virtual void search(const utymap::QuadKey& quadKey,
                         utymap::entities::ElementVisitor& visitor) = 0;
 
+    // Searches for elements for given quadKey and reports them as shared elements.
+    // Copies visited elements by default as they may be temporary.
+    virtual void search(const utymap::QuadKey& quadKey,
+                        const ElementCallback& callback);
+
     // Checks whether there is data for given quadkey.
     virtual bool hasData(const utymap::QuadKey& quadKey) const = 0;
 
+    // Checks whether there is data for every quadkey sorted in ascending order.
+    // Result is set to true if there is data, otherwise it is not changed.
+    virtual void hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const;
+
     // Stores element in storage in all affected tiles at given level of details range.
     bool store(const utymap::entities::Element& element, 
                const utymap::LodRange& range,
@@ -48,10 +65,24 @@ public:
     // Commits changes done in element store.
     virtual void commit() = 0;
 
+    // Returns revision of stored data. It can be used to validate data built
+    // from the store as it is changed on every add.
+    std::uint64_t getRevision() const;
+
+    // Changes revision using description of added data. The same sequence
+    // of descriptions gives the same revision.
+    void updateRevision(const std::string& change);
+
 protected:
     // Stores element in given quadkey.
     virtual void storeImpl(const utymap::entities::Element& element, const utymap::QuadKey& quadKey) = 0;
 
+    // Sets revision without saving it, e.g. when it is restored.
+    void setRevision(std::uint64_t revision);
+
+    // Saves revision. Called on every change, does nothing by default.
+    virtual void saveRevision(std::uint64_t revision);
+
 private:
     template <typename Visitor>
     bool store(const utymap::entities::Element& element,
@@ -64,6 +95,7 @@ private:
                    double minSize) const;
 
     std::uint32_t clipKeyId_, skipKeyId_, sizeKeyId_;
+    std::atomic<std::uint64_t> revision_;
 };
 
 }}
@@ -3,55 +3,68 @@
 #include "formats/shape/ShapeDataVisitor.hpp"
 #include "formats/shape/ShapeParser.hpp"
 #include "formats/osm/xml/OsmXmlParser.hpp"
+#include "formats/osm/pbf/OsmPbfIndex.hpp"
 #include "formats/osm/pbf/OsmPbfParser.hpp"
 #include "formats/osm/OsmDataVisitor.hpp"
 #include "index/GeoStore.hpp"
 #include "index/InMemoryElementStore.hpp"
 #include "index/PersistentElementStore.hpp"
 #include "utils/CoreUtils.hpp"
-
+#include "utils/GeoUtils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
 #include <set>
 #include <map>
 #include <memory>
+#include <sstream>
+#include <thread>
 
 using namespace utymap::entities;
 using namespace utymap::formats;
 using namespace utymap::index;
 using namespace utymap::mapcss;
+using namespace utymap::utils;
 
 class GeoStore::GeoStoreImpl
 {
-    // Prevents to visit element twice if it exists in multiply stores.
-    class FilterElementVisitor : public ElementVisitor
+    // Prevents to report element twice if it exists in multiply stores and
+    // reports element with its style if it has one.
+    class ElementFilter
     {
     public:
-        FilterElementVisitor(const QuadKey& quadKey, const StyleProvider& styleProvider, ElementVisitor& visitor)
-                : visitor_(visitor), quadKey_(quadKey), styleProvider_(styleProvider), ids_()
+        ElementFilter(const QuadKey& quadKey, const StyleProvider& styleProvider, const StyledElementCallback& callback,
+                      const CancellationToken& cancelToken)
+                : quadKey_(quadKey), styleProvider_(styleProvider), callback_(callback), cancelToken_(cancelToken), ids_()
         {
         }
 
-        void visitNode(const Node& node) { visitIfNecessary(node); }
-
-        void visitWay(const Way& way)  { visitIfNecessary(way); }
-
-        void visitArea(const Area& area)  { visitIfNecessary(area); }
+        void operator()(const std::shared_ptr<const Element>& element)
+        {
+            // NOTE store cannot be interrupted, so the rest of elements is just skipped.
+            if (cancelToken_.isCancelled())
+                return;
 
-        void visitRelation(const Relation& relation)  { visitIfNecessary(relation); }
+            if (element->id != 0 && ids_.find(element->id) != ids_.end())
+                return;
 
-    private:
+            Style style = styleProvider_.forElement(*element, quadKey_.levelOfDetail);
+            if (style.empty())
+                return;
 
-        inline void visitIfNecessary(const Element& element)
-        {
-            if (element.id == 0 || ids_.find(element.id) == ids_.end() ||
-                    styleProvider_.hasStyle(element, quadKey_.levelOfDetail)) {
-                element.accept(visitor_);
-                ids_.insert(element.id);
-            }
+            ids_.insert(element->id);
+            callback_(element, style);
         }
 
+    private:
         const QuadKey& quadKey_;
         const StyleProvider& styleProvider_;
-        ElementVisitor& visitor_;
+        const StyledElementCallback& callback_;
+        const CancellationToken& cancelToken_;
 
         std::set<std::uint64_t> ids_;
     };
@@ -63,14 +76,21 @@ public:
     {
     }
 
-    void registerStore(const std::string& storeKey, const std::shared_ptr<ElementStore>& store)
+    void registerStore(const std::string& storeKey, const std::shared_ptr<ElementStore>& store, bool isFiltered)
     {
         storeMap_[storeKey] = store;
+        if (isFiltered)
+            filteredStores_.insert(storeKey);
+        else
+            filteredStores_.erase(storeKey);
     }
 
     void add(const std::string& storeKey, const Element& element, const LodRange& range, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
+        // NOTE element content is not described, so revision is made unique for every add.
+        elementStore->updateRevision("element;" + toString(element.id) + ";" +
+            toString(std::chrono::system_clock::now().time_since_epoch().count()));
         elementStore->store(element, range, styleProvider);
         elementStore->commit();
     }
@@ -78,7 +98,10 @@ public:
     void add(const std::string& storeKey, const std::string& path, const QuadKey& quadKey, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
+        updateRevision(*elementStore, path, GeoUtils::quadKeyToString(quadKey));
+        LodRange range(quadKey.levelOfDetail, quadKey.levelOfDetail);
+        auto filter = getImportFilter(storeKey, range, styleProvider);
+        add(path, filter.get(), [&](Element& element) {
             return elementStore->store(element, quadKey, styleProvider);
         });
         elementStore->commit();
@@ -87,7 +110,9 @@ public:
     void add(const std::string& storeKey, const std::string& path, const LodRange& range, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
+        updateRevision(*elementStore, path, toString(range.start) + ";" + toString(range.end));
+        auto filter = getImportFilter(storeKey, range, styleProvider);
+        add(path, filter.get(), [&](Element& element) {
             return elementStore->store(element, range, styleProvider);
         });
         elementStore->commit();
@@ -96,18 +121,22 @@ public:
     void add(const std::string& storeKey, const std::string& path, const BoundingBox& bbox, const LodRange& range, const StyleProvider& styleProvider)
     {
         auto elementStore = storeMap_[storeKey];
-        add(path, styleProvider, [&](Element& element) {
+        updateRevision(*elementStore, path, toString(bbox.minPoint.latitude) + ";" + toString(bbox.minPoint.longitude) + ";" +
+            toString(bbox.maxPoint.latitude) + ";" + toString(bbox.maxPoint.longitude) + ";" +
+            toString(range.start) + ";" + toString(range.end));
+        auto filter = getImportFilter(storeKey, range, styleProvider);
+        add(path, bbox, filter.get(), [&](Element& element) {
             return elementStore->store(element, bbox, range, styleProvider);
         });
         elementStore->commit();
     }
 
-    void add(const std::string& path, const StyleProvider& styleProvider, const std::function<bool(Element&)>& functor)
+    void add(const std::string& path, const ImportFilter* filter, const std::function<bool(Element&)>& functor)
     {
         switch (getFormatTypeFromPath(path)) {
             case FormatType::Shape: {
                 ShapeParser<ShapeDataVisitor> parser;
-                ShapeDataVisitor visitor(stringTable_, functor);
+                ShapeDataVisitor visitor(stringTable_, functor, filter);
                 parser.parse(path, visitor);
                 visitor.complete();
                 break;
@@ -115,7 +144,7 @@ public:
             case FormatType::Xml: {
                 OsmXmlParser<OsmDataVisitor> parser;
                 std::ifstream xmlFile(path);
-                OsmDataVisitor visitor(stringTable_, functor);
+                OsmDataVisitor visitor(stringTable_, functor, filter);
                 parser.parse(xmlFile, visitor);
                 visitor.complete();
                 break;
@@ -123,7 +152,7 @@ public:
             case FormatType::Pbf: {
                 OsmPbfParser<OsmDataVisitor> parser;
                 std::ifstream pbfFile(path, std::ios::in | std::ios::binary);
-                OsmDataVisitor visitor(stringTable_, functor);
+                OsmDataVisitor visitor(stringTable_, functor, filter);
                 parser.parse(pbfFile, visitor);
                 visitor.complete();
                 break;
@@ -133,11 +162,33 @@ public:
         }
     }
 
-    void search(const QuadKey& quadKey, const utymap::mapcss::StyleProvider& styleProvider, ElementVisitor& visitor)
+    void add(const std::string& path, const BoundingBox& bbox, const ImportFilter* filter, const std::function<bool(Element&)>& functor)
+    {
+        // NOTE only pbf format supports reading of data subset, for others elements
+        // outside of bounding box are filtered by element store. Please note, that
+        // pbf subset contains only elements which have at least one node inside bbox.
+        if (getFormatTypeFromPath(path) != FormatType::Pbf) {
+            add(path, filter, functor);
+            return;
+        }
+
+        OsmPbfParser<OsmDataVisitor> parser;
+        std::ifstream pbfFile(path, std::ios::in | std::ios::binary);
+        OsmPbfIndex index = getPbfIndex(path, pbfFile, parser);
+        OsmDataVisitor visitor(stringTable_, functor, filter);
+        parser.parse(pbfFile, visitor, index, bbox);
+        visitor.complete();
+    }
+
+    void search(const QuadKey& quadKey, const utymap::mapcss::StyleProvider& styleProvider, const StyledElementCallback& callback,
+                const CancellationToken& cancelToken)
     {
-        FilterElementVisitor filter(quadKey, styleProvider, visitor);
+        ElementFilter filter(quadKey, styleProvider, callback, cancelToken);
+        ElementStore::ElementCallback filterCallback = std::ref(filter);
         for (const auto& pair : storeMap_) {
-            pair.second->search(quadKey, filter);
+            if (cancelToken.isCancelled())
+                return;
+            pair.second->search(quadKey, filterCallback);
         }
     }
 
@@ -155,9 +206,105 @@ public:
         return false;
     }
 
+    void hasData(const std::vector<QuadKey>& quadKeys, bool* results)
+    {
+        // NOTE stores expect sorted quadkeys, so results are mapped back to original order.
+        std::vector<std::size_t> order(quadKeys.size());
+        for (std::size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+            return quadKeys[lhs] < quadKeys[rhs];
+        });
+
+        std::vector<QuadKey> sorted;
+        sorted.reserve(quadKeys.size());
+        for (std::size_t i : order)
+            sorted.push_back(quadKeys[i]);
+
+        std::unique_ptr<bool[]> sortedResults(new bool[sorted.size()]());
+        for (const auto& pair : storeMap_)
+            pair.second->hasData(sorted, sortedResults.get());
+
+        for (std::size_t i = 0; i < order.size(); ++i)
+            results[order[i]] = sortedResults[i];
+    }
+
+    std::uint64_t getRevision() const
+    {
+        std::uint64_t revision = 14695981039346656037ULL;
+        for (const auto& pair : storeMap_)
+            revision = (revision ^ std::hash<std::string>()(pair.first) ^ pair.second->getRevision()) * 1099511628211ULL;
+        return revision;
+    }
+
 private:
+
+    // Describes file import by its source state, so the same data gives the same revision.
+    static void updateRevision(ElementStore& elementStore, const std::string& path, const std::string& area)
+    {
+        elementStore.updateRevision("file;" + path + ";" + toString(getFileSize(path)) + ";" +
+            toString(getFileModificationTime(path)) + ";" + area);
+    }
+
     StringTable& stringTable_;
     std::map<std::string, std::shared_ptr<ElementStore>> storeMap_;
+    std::set<std::string> filteredStores_;
+
+    // Returns filter of stylesheet if store is filtered, otherwise nullptr.
+    std::unique_ptr<ImportFilter> getImportFilter(const std::string& storeKey, const LodRange& range, const StyleProvider& styleProvider) const
+    {
+        if (filteredStores_.find(storeKey) == filteredStores_.end())
+            return nullptr;
+        return std::unique_ptr<ImportFilter>(new ImportFilter(styleProvider.getImportFilter(range)));
+    }
+
+    // Reads index of pbf file from sidecar file or builds and saves it if it is missing or outdated.
+    OsmPbfIndex getPbfIndex(const std::string& path, std::ifstream& pbfFile, OsmPbfParser<OsmDataVisitor>& parser)
+    {
+        pbfFile.seekg(0, std::ios::end);
+        auto sourceSize = static_cast<std::uint64_t>(pbfFile.tellg());
+        pbfFile.seekg(0, std::ios::beg);
+
+        auto sourceTime = getFileModificationTime(path);
+
+        const std::string indexPath = path + ".idx";
+        OsmPbfIndex index;
+        std::ifstream indexFile(indexPath, std::ios::in | std::ios::binary);
+        if (index.read(indexFile) && index.sourceSize == sourceSize && index.sourceTime == sourceTime)
+            return index;
+        indexFile.close();
+
+        index = parser.buildIndex(pbfFile);
+        index.sourceTime = sourceTime;
+        writePbfIndex(indexPath, index);
+        return index;
+    }
+
+    // Saves index to sidecar file. Failure is not fatal: index is built again next time.
+    void writePbfIndex(const std::string& indexPath, const OsmPbfIndex& index) const
+    {
+        // NOTE write to temporary file first, so readers never see partially written index.
+        std::stringstream ss;
+        ss << indexPath << "." << std::hash<std::thread::id>()(std::this_thread::get_id()) << ".tmp";
+        std::string tempPath = ss.str();
+        {
+            std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (file.good())
+                index.write(file);
+            if (!file.good()) {
+                std::cerr << "Unable to write pbf index:" << indexPath << std::endl;
+                file.close();
+                std::remove(tempPath.c_str());
+                return;
+            }
+        }
+
+        std::remove(indexPath.c_str());
+        if (std::rename(tempPath.c_str(), indexPath.c_str()) != 0) {
+            std::cerr << "Unable to write pbf index:" << indexPath << std::endl;
+            std::remove(tempPath.c_str());
+        }
+    }
 
     FormatType getFormatTypeFromPath(const std::string& path)
     {
@@ -180,9 +327,9 @@ GeoStore::~GeoStore()
     google::protobuf::ShutdownProtobufLibrary();
 }
 
-void utymap::index::GeoStore::registerStore(const std::string& storeKey, const std::shared_ptr<ElementStore>& store)
+void utymap::index::GeoStore::registerStore(const std::string& storeKey, const std::shared_ptr<ElementStore>& store, bool isFiltered)
 {
-    pimpl_->registerStore(storeKey, store);
+    pimpl_->registerStore(storeKey, store, isFiltered);
 }
 
 void utymap::index::GeoStore::add(const std::string& storeKey, const Element& element, const LodRange& range, const StyleProvider& styleProvider)
@@ -205,9 +352,10 @@ void utymap::index::GeoStore::add(const std::string &storeKey, const std::string
     pimpl_->add(storeKey, path, bbox, range, styleProvider);
 }
 
-void utymap::index::GeoStore::search(const QuadKey& quadKey, const utymap::mapcss::StyleProvider& styleProvider, ElementVisitor& visitor)
+void utymap::index::GeoStore::search(const QuadKey& quadKey, const utymap::mapcss::StyleProvider& styleProvider, const StyledElementCallback& callback,
+                                     const CancellationToken& cancelToken)
 {
-    pimpl_->search(quadKey, styleProvider, visitor);
+    pimpl_->search(quadKey, styleProvider, callback, cancelToken);
 }
 
 void utymap::index::GeoStore::search(const GeoCoordinate& coordinate, double radius, const StyleProvider& styleProvider, ElementVisitor& visitor)
@@ -219,3 +367,13 @@ bool utymap::index::GeoStore::hasData(const QuadKey& quadKey)
 {
     return pimpl_->hasData(quadKey);
 }
+
+void utymap::index::GeoStore::hasData(const std::vector<QuadKey>& quadKeys, bool* results)
+{
+    pimpl_->hasData(quadKeys, results);
+}
+
+std::uint64_t utymap::index::GeoStore::getRevision() const
+{
+    return pimpl_->getRevision();
+}
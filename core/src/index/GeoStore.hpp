@@ -13,9 +13,12 @@
 
 #include "mapcss/StyleSheet.hpp"
 #include "mapcss/StyleProvider.hpp"
+#include "utils/CancellationToken.hpp"
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace utymap { namespace index {
 
@@ -23,13 +26,21 @@ namespace utymap { namespace index {
 class GeoStore
 {
 public:
+    // Called for found element with its style at level of details of searched quadkey.
+    // Element is shared, so it can be kept with its style after search.
+    typedef std::function<void(const std::shared_ptr<const utymap::entities::Element>&,
+                               const utymap::mapcss::Style&)> StyledElementCallback;
+
     GeoStore(utymap::index::StringTable& stringTable);
 
     ~GeoStore();
 
-    // Adds underlying element store for usage.
+    // Adds underlying element store for usage. Data imported from files into filtered
+    // store is reduced to elements and tags used by stylesheet of the import, so such
+    // store should not be used with other stylesheets.
     void registerStore(const std::string& storeKey, 
-                       const std::shared_ptr<ElementStore>& store);
+                       const std::shared_ptr<ElementStore>& store,
+                       bool isFiltered = false);
 
     // Adds element to selected store.
     void add(const std::string& storeKey, 
@@ -50,16 +61,20 @@ public:
              const utymap::mapcss::StyleProvider& styleProvider);
 
     // Adds all data from file to selected store in given boundging box.
+    // For pbf files, sidecar index is used to read only blocks related to bounding box.
     void add(const std::string& storeKey,
              const std::string& path,
              const utymap::BoundingBox& bbox,
              const utymap::LodRange& range,
              const utymap::mapcss::StyleProvider& styleProvider);
 
-    // Searches for elements inside quadkey.
+    // Searches for elements inside quadkey. Only elements with style are reported,
+    // style is computed once for every element. Safe to call from several threads
+    // when stores are not modified. Elements are not reported once search is cancelled.
     void search(const QuadKey& quadKey,
                 const utymap::mapcss::StyleProvider& styleProvider,
-                utymap::entities::ElementVisitor& visitor);
+                const StyledElementCallback& callback,
+                const utymap::utils::CancellationToken& cancelToken);
 
     // Searches for elements inside circle with given parameters.
     void search(const GeoCoordinate& coordinate,
@@ -70,6 +85,14 @@ public:
     // Checks whether there is data for given quadkey.
     bool hasData(const QuadKey& quadKey);
 
+    // Checks whether there is data for every quadkey. Every store is asked
+    // once for all quadkeys.
+    void hasData(const std::vector<QuadKey>& quadKeys, bool* results);
+
+    // Returns revision of data in all registered stores. It is changed when
+    // data is added and stays the same between runs for the same data.
+    std::uint64_t getRevision() const;
+
 private:
     class GeoStoreImpl;
     std::unique_ptr<GeoStoreImpl> pimpl_;
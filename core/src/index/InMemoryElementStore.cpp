@@ -13,22 +13,8 @@ using namespace utymap::entities;
 using namespace utymap::mapcss;
 
 namespace {
-    struct QuadKeyComparator
-    {
-        bool operator() (const QuadKey& lhs, const QuadKey& rhs) const
-        {
-            if (lhs.levelOfDetail == rhs.levelOfDetail) {
-                if (lhs.tileX == rhs.tileX) {
-                    return lhs.tileY < rhs.tileY;
-                }
-                return lhs.tileX < rhs.tileX;
-            }
-            return lhs.levelOfDetail < rhs.levelOfDetail;
-        }
-    };
-
-    typedef std::vector<std::shared_ptr<Element>> Elements;
-    typedef std::map<QuadKey, Elements, QuadKeyComparator> ElementMap;
+    typedef std::vector<std::shared_ptr<const Element>> Elements;
+    typedef std::map<QuadKey, Elements> ElementMap;
 
     class ElementMapVisitor : public ElementVisitor
     {
@@ -82,6 +68,18 @@ class InMemoryElementStore::InMemoryElementStoreImpl
     {
         return elementsMap.find(quadKey) != elementsMap.end();
     }  
+
+    // Walks map once as quadkeys are in the same order as map keys.
+    inline void hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const
+    {
+        auto it = elementsMap.begin();
+        for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+            while (it != elementsMap.end() && it->first < quadKeys[i])
+                ++it;
+            if (it != elementsMap.end() && it->first == quadKeys[i])
+                results[i] = true;
+        }
+    }
 };
 
 InMemoryElementStore::InMemoryElementStore(StringTable& stringTable) :
@@ -104,6 +102,11 @@ bool InMemoryElementStore::hasData(const utymap::QuadKey& quadKey) const
     return pimpl_->hasData(quadKey);
 }
 
+void InMemoryElementStore::hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const
+{
+    pimpl_->hasData(quadKeys, results);
+}
+
 void InMemoryElementStore::search(const utymap::QuadKey& quadKey, utymap::entities::ElementVisitor& visitor)
 {
     auto it = pimpl_->begin(quadKey);
@@ -117,6 +120,17 @@ void InMemoryElementStore::search(const utymap::QuadKey& quadKey, utymap::entiti
     }
 }
 
+void InMemoryElementStore::search(const utymap::QuadKey& quadKey, const ElementCallback& callback)
+{
+    auto it = pimpl_->begin(quadKey);
+    if (it == pimpl_->end())
+        return;
+
+    // NOTE stored elements are not changed, so they are shared without copying.
+    for (const auto& element : it->second)
+        callback(element);
+}
+
 void InMemoryElementStore::commit()
 {
 
@@ -21,8 +21,13 @@ public:
     void search(const utymap::QuadKey& quadKey, 
                 utymap::entities::ElementVisitor& visitor);
 
+    void search(const utymap::QuadKey& quadKey,
+                const ElementCallback& callback);
+
     bool hasData(const utymap::QuadKey& quadKey) const;
 
+    void hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const;
+
     void commit();
 
 protected:
@@ -6,7 +6,16 @@
 #include "index/PersistentElementStore.hpp"
 
 #include <fstream>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
 
 using namespace utymap;
 using namespace utymap::index;
@@ -40,6 +49,32 @@ namespace {
     //------------------------------------------------------------------------------------------------------|
     const std::string DataFileExtension = ".dat";
 
+    // Keeps revision of stored data as text in the root of data directory.
+    const std::string RevisionFileName = "revision.txt";
+
+    // Adds names of files in given directory. Does nothing if directory does not exist.
+    void listFiles(const std::string& directory, std::unordered_set<std::string>& names)
+    {
+#ifdef _WIN32
+        WIN32_FIND_DATAA data;
+        HANDLE handle = ::FindFirstFileA((directory + "*").c_str(), &data);
+        if (handle == INVALID_HANDLE_VALUE)
+            return;
+        do {
+            if ((data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) == 0)
+                names.insert(data.cFileName);
+        } while (::FindNextFileA(handle, &data));
+        ::FindClose(handle);
+#else
+        DIR* dir = ::opendir(directory.c_str());
+        if (dir == nullptr)
+            return;
+        while (struct dirent* entry = ::readdir(dir))
+            names.insert(entry->d_name);
+        ::closedir(dir);
+#endif
+    }
+
     // Writes element to file stream.
     class ElementWriter : public ElementVisitor
     {
@@ -120,7 +155,7 @@ namespace {
     class ElementReader
     {
     public:
-        ElementReader(std::fstream& dataFile) : dataFile_(dataFile)
+        ElementReader(std::istream& dataFile) : dataFile_(dataFile)
         {
         }
 
@@ -231,7 +266,7 @@ namespace {
             return std::move(tags);
         }
 
-        std::fstream& dataFile_;
+        std::istream& dataFile_;
     };
 }
 
@@ -245,6 +280,7 @@ public:
 
     void store(const Element& element, const QuadKey& quadKey)
     {
+        std::lock_guard<std::mutex> lock(lock_);
         ensureFiles(quadKey);
 
         // write element data
@@ -259,23 +295,36 @@ public:
         indexFile_.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
     }
 
-    void search(const QuadKey& quadKey, ElementVisitor& visitor)
+    // NOTE uses own file streams, so can be called concurrently.
+    void search(const QuadKey& quadKey, const ElementCallback& callback)
     {
-        ensureFiles(quadKey);
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            if (quadKey == currentQuadKey_) {
+                dataFile_.flush();
+                indexFile_.flush();
+            }
+        }
+
+        using std::ios;
+        std::ifstream dataFile(getFilePath(quadKey, DataFileExtension), ios::in | ios::binary);
+        std::ifstream indexFile(getFilePath(quadKey, IndexFileExtension), ios::in | ios::binary | ios::ate);
+        if (!dataFile.good() || !indexFile.good())
+            return;
 
-        std::uint32_t count = static_cast<std::uint32_t>(indexFile_.tellg() /
+        std::uint32_t count = static_cast<std::uint32_t>(indexFile.tellg() /
                 (sizeof(std::uint64_t) + sizeof(std::uint32_t)));
 
-        ElementReader reader(dataFile_);
+        ElementReader reader(dataFile);
 
-        indexFile_.seekg(0, std::ios::beg);
+        indexFile.seekg(0, std::ios::beg);
         for (std::uint32_t i = 0; i < count; ++i) {
             std::uint64_t id;
             std::uint32_t offset;
-            indexFile_.read(reinterpret_cast<char*>(&id), sizeof(id));
-            indexFile_.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+            indexFile.read(reinterpret_cast<char*>(&id), sizeof(id));
+            indexFile.read(reinterpret_cast<char*>(&offset), sizeof(offset));
 
-            reader.readElement(id, offset)->accept(visitor);
+            callback(reader.readElement(id, offset));
         }
     }
 
@@ -285,18 +334,52 @@ public:
         return file.good();
     }
 
+    // NOTE quadkeys are sorted by level of details, so directory of every level is listed once.
+    void hasData(const std::vector<QuadKey>& quadKeys, bool* results) const
+    {
+        std::unordered_set<std::string> names;
+        for (std::size_t i = 0; i < quadKeys.size(); ++i) {
+            if (i == 0 || quadKeys[i].levelOfDetail != quadKeys[i - 1].levelOfDetail) {
+                names.clear();
+                listFiles(getDirectoryPath(quadKeys[i].levelOfDetail), names);
+            }
+            if (names.find(GeoUtils::quadKeyToString(quadKeys[i]) + DataFileExtension) != names.end())
+                results[i] = true;
+        }
+    }
+
     void commit()
     {
+        std::lock_guard<std::mutex> lock(lock_);
         closeFiles();
         currentQuadKey_ = QuadKey();
     }
 
+    bool readRevision(std::uint64_t& revision) const
+    {
+        std::ifstream file(dataPath_ + RevisionFileName);
+        return static_cast<bool>(file >> revision);
+    }
+
+    void writeRevision(std::uint64_t revision) const
+    {
+        // NOTE revision is written before data, so it is changed even if adding fails.
+        std::ofstream file(dataPath_ + RevisionFileName, std::ios::out | std::ios::trunc);
+        file << revision;
+    }
+
 private:
     // gets full file path for given quadkey
     inline std::string getFilePath(const QuadKey& quadKey, const std::string& extension) const
+    {
+        return getDirectoryPath(quadKey.levelOfDetail) + GeoUtils::quadKeyToString(quadKey) + extension;
+    }
+
+    // gets path of directory with files of given level of details
+    inline std::string getDirectoryPath(int levelOfDetail) const
     {
         std::stringstream ss;
-        ss << dataPath_ << quadKey.levelOfDetail << "/" << GeoUtils::quadKeyToString(quadKey) << extension;
+        ss << dataPath_ << levelOfDetail << "/";
         return ss.str();
     }
 
@@ -327,11 +410,18 @@ private:
 
     std::fstream indexFile_;
     std::fstream dataFile_;
+    std::mutex lock_;
 };
 
 PersistentElementStore::PersistentElementStore(const std::string& dataPath, StringTable& stringTable) :
         ElementStore(stringTable), pimpl_(new PersistentElementStore::PersistentElementStoreImpl(dataPath))
 {
+    // NOTE data stored before revision was introduced gets initial one.
+    std::uint64_t revision;
+    if (pimpl_->readRevision(revision))
+        setRevision(revision);
+    else
+        pimpl_->writeRevision(getRevision());
 }
 
 PersistentElementStore::~PersistentElementStore()
@@ -345,7 +435,14 @@ void PersistentElementStore::storeImpl(const Element& element, const QuadKey& qu
 
 void PersistentElementStore::search(const QuadKey& quadKey, ElementVisitor& visitor)
 {
-    pimpl_->search(quadKey, visitor);
+    pimpl_->search(quadKey, [&](const std::shared_ptr<const Element>& element) {
+        element->accept(visitor);
+    });
+}
+
+void PersistentElementStore::search(const QuadKey& quadKey, const ElementCallback& callback)
+{
+    pimpl_->search(quadKey, callback);
 }
 
 bool PersistentElementStore::hasData(const QuadKey& quadKey) const
@@ -353,7 +450,17 @@ bool PersistentElementStore::hasData(const QuadKey& quadKey) const
     return pimpl_->hasData(quadKey);
 }
 
+void PersistentElementStore::hasData(const std::vector<QuadKey>& quadKeys, bool* results) const
+{
+    pimpl_->hasData(quadKeys, results);
+}
+
 void PersistentElementStore::commit()
 {
     pimpl_->commit();
 }
+
+void PersistentElementStore::saveRevision(std::uint64_t revision)
+{
+    pimpl_->writeRevision(revision);
+}
@@ -7,6 +7,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 
 namespace utymap { namespace index {
 
@@ -22,13 +23,20 @@ public:
     void search(const utymap::QuadKey& quadKey, 
                 utymap::entities::ElementVisitor& visitor);
 
+    void search(const utymap::QuadKey& quadKey,
+                const ElementCallback& callback);
+
     bool hasData(const utymap::QuadKey& quadKey) const;
 
+    void hasData(const std::vector<utymap::QuadKey>& quadKeys, bool* results) const;
+
     void commit();
 
 protected:
     void storeImpl(const utymap::entities::Element& element, const utymap::QuadKey& quadKey);
 
+    void saveRevision(std::uint64_t revision);
+
 private:
     class PersistentElementStoreImpl;
     std::unique_ptr<PersistentElementStoreImpl> pimpl_;
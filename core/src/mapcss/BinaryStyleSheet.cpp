@@ -0,0 +1,253 @@
+#include "mapcss/BinaryStyleSheet.hpp"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace utymap::mapcss;
+
+namespace {
+    const std::uint32_t Signature = 0x53534d55; // UMSS
+    const std::uint32_t Version = 1;
+
+    // Calculates FNV-1a hash of file content. Returns zero if file cannot be read.
+    std::uint64_t getFileHash(const std::string& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.good())
+            return 0;
+
+        std::uint64_t hash = 14695981039346656037ULL;
+        std::istreambuf_iterator<char> it(file), end;
+        for (; it != end; ++it) {
+            hash ^= static_cast<unsigned char>(*it);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    class Writer
+    {
+    public:
+        Writer(std::ofstream& file) : file_(file) {}
+
+        template <typename T>
+        void write(const T& value)
+        {
+            file_.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void write(const std::string& str)
+        {
+            write(static_cast<std::uint32_t>(str.size()));
+            file_.write(str.data(), str.size());
+        }
+
+        void write(const Selector& selector)
+        {
+            write(static_cast<std::uint32_t>(selector.names.size()));
+            for (const auto& name : selector.names)
+                write(name);
+            write(selector.zoom.start);
+            write(selector.zoom.end);
+            write(static_cast<std::uint32_t>(selector.conditions.size()));
+            for (const auto& condition : selector.conditions) {
+                write(condition.key);
+                write(condition.operation);
+                write(condition.value);
+            }
+        }
+
+        void write(const Rule& rule)
+        {
+            write(static_cast<std::uint32_t>(rule.selectors.size()));
+            for (const auto& selector : rule.selectors)
+                write(selector);
+            write(static_cast<std::uint32_t>(rule.declarations.size()));
+            for (const auto& declaration : rule.declarations) {
+                write(declaration.key);
+                write(declaration.value);
+            }
+        }
+
+        void write(const ColorGradient& gradient)
+        {
+            write(static_cast<std::uint32_t>(gradient.data().size()));
+            for (const auto& pair : gradient.data()) {
+                write(pair.first);
+                write(static_cast<std::uint32_t>(pair.second));
+            }
+        }
+
+    private:
+        std::ofstream& file_;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(std::ifstream& file) : file_(file) {}
+
+        bool good() const { return file_.good(); }
+
+        template <typename T>
+        void read(T& value)
+        {
+            file_.read(reinterpret_cast<char*>(&value), sizeof(value));
+        }
+
+        void read(std::string& str)
+        {
+            str.resize(readSize());
+            if (!str.empty())
+                file_.read(&str[0], str.size());
+        }
+
+        void read(Selector& selector)
+        {
+            selector.names.resize(readSize());
+            for (auto& name : selector.names)
+                read(name);
+            read(selector.zoom.start);
+            read(selector.zoom.end);
+            selector.conditions.resize(readSize());
+            for (auto& condition : selector.conditions) {
+                read(condition.key);
+                read(condition.operation);
+                read(condition.value);
+            }
+        }
+
+        void read(Rule& rule)
+        {
+            rule.selectors.resize(readSize());
+            for (auto& selector : rule.selectors)
+                read(selector);
+            rule.declarations.resize(readSize());
+            for (auto& declaration : rule.declarations) {
+                read(declaration.key);
+                read(declaration.value);
+            }
+        }
+
+        std::shared_ptr<const ColorGradient> readGradient()
+        {
+            ColorGradient::GradientData data(readSize());
+            for (auto& pair : data) {
+                std::uint32_t color;
+                read(pair.first);
+                read(color);
+                pair.second = Color(static_cast<int>(color));
+            }
+            return std::make_shared<const ColorGradient>(data);
+        }
+
+        // Reads size of collection and fails stream if it exceeds remaining data.
+        std::uint32_t readSize()
+        {
+            std::uint32_t size = 0;
+            read(size);
+            if (!file_.good() || size > remaining_)
+                file_.setstate(std::ios::failbit);
+            return file_.good() ? size : 0;
+        }
+
+        void setRemaining(std::uint64_t remaining) { remaining_ = remaining; }
+
+    private:
+        std::ifstream& file_;
+        std::uint64_t remaining_ = 0;
+    };
+}
+
+bool BinaryStyleSheet::read(const std::string& path,
+                            const std::string& sourcePath,
+                            StyleSheet& stylesheet,
+                            StyleProvider::Gradients& gradients)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.good())
+        return false;
+
+    Reader reader(file);
+    reader.setRemaining(static_cast<std::uint64_t>(file.tellg()));
+    file.seekg(0);
+
+    std::uint32_t signature = 0, version = 0;
+    reader.read(signature);
+    reader.read(version);
+    if (!reader.good() || signature != Signature || version != Version)
+        return false;
+
+    // validate source files: main one is stored first.
+    std::uint32_t fileCount = reader.readSize();
+    if (fileCount == 0)
+        return false;
+
+    StyleSheet result;
+    result.imports.resize(fileCount - 1);
+    for (std::uint32_t i = 0; i < fileCount; ++i) {
+        std::string filePath;
+        std::uint64_t hash;
+        reader.read(filePath);
+        reader.read(hash);
+        if (!reader.good() || (i == 0 && filePath != sourcePath) || getFileHash(filePath) != hash)
+            return false;
+        if (i > 0)
+            result.imports[i - 1] = filePath;
+    }
+
+    result.rules.resize(reader.readSize());
+    for (auto& rule : result.rules)
+        reader.read(rule);
+
+    StyleProvider::Gradients resultGradients;
+    std::uint32_t gradientCount = reader.readSize();
+    for (std::uint32_t i = 0; i < gradientCount && reader.good(); ++i) {
+        std::string key;
+        reader.read(key);
+        resultGradients[key] = reader.readGradient();
+    }
+
+    if (!reader.good())
+        return false;
+
+    stylesheet = std::move(result);
+    gradients = std::move(resultGradients);
+    return true;
+}
+
+bool BinaryStyleSheet::write(const std::string& path,
+                             const std::string& sourcePath,
+                             const StyleSheet& stylesheet,
+                             const StyleProvider::Gradients& gradients)
+{
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.good())
+        return false;
+
+    Writer writer(file);
+    writer.write(Signature);
+    writer.write(Version);
+
+    writer.write(static_cast<std::uint32_t>(stylesheet.imports.size() + 1));
+    writer.write(sourcePath);
+    writer.write(getFileHash(sourcePath));
+    for (const auto& import : stylesheet.imports) {
+        writer.write(import);
+        writer.write(getFileHash(import));
+    }
+
+    writer.write(static_cast<std::uint32_t>(stylesheet.rules.size()));
+    for (const auto& rule : stylesheet.rules)
+        writer.write(rule);
+
+    writer.write(static_cast<std::uint32_t>(gradients.size()));
+    for (const auto& pair : gradients) {
+        writer.write(pair.first);
+        writer.write(*pair.second);
+    }
+
+    return file.good();
+}
@@ -0,0 +1,34 @@
+#ifndef MAPCSS_BINARYSTYLESHEET_HPP_DEFINED
+#define MAPCSS_BINARYSTYLESHEET_HPP_DEFINED
+
+#include "mapcss/StyleProvider.hpp"
+#include "mapcss/StyleSheet.hpp"
+
+#include <string>
+
+namespace utymap { namespace mapcss {
+
+// Provides the way to keep parsed stylesheet with its color gradients in compact
+// binary file, so mapcss parsing can be skipped when source files are not changed.
+class BinaryStyleSheet
+{
+public:
+
+    // Reads stylesheet and gradients from binary file. Returns false if file does
+    // not exist, has unsupported format or any of source files was changed.
+    static bool read(const std::string& path,
+                     const std::string& sourcePath,
+                     utymap::mapcss::StyleSheet& stylesheet,
+                     utymap::mapcss::StyleProvider::Gradients& gradients);
+
+    // Writes stylesheet parsed from given source file and its gradients
+    // to binary file. Returns false if file cannot be written.
+    static bool write(const std::string& path,
+                      const std::string& sourcePath,
+                      const utymap::mapcss::StyleSheet& stylesheet,
+                      const utymap::mapcss::StyleProvider::Gradients& gradients);
+};
+
+}}
+
+#endif // MAPCSS_BINARYSTYLESHEET_HPP_DEFINED
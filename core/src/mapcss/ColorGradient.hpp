@@ -3,13 +3,16 @@
 
 #include "mapcss/Color.hpp"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 #include <utility>
 
 namespace utymap { namespace mapcss {
 
-// Represents color gradient.
+// Represents color gradient. Colors are precomputed into lookup table, so
+// evaluation is a table lookup.
 class ColorGradient
 {
 public:
@@ -17,14 +20,42 @@ public:
     // gradient data: first - time, second - color.
     typedef std::vector<std::pair<double, utymap::mapcss::Color>> GradientData;
 
+    // Amount of lookup table intervals: stop times which are multiple
+    // of 1/LookupSize are reproduced exactly.
+    static const std::size_t LookupSize = 256;
+
     ColorGradient() {}
 
     ColorGradient(const GradientData& colors) :
         colors_(colors)
     {
+        if (colors_.empty())
+            return;
+
+        lookup_.reserve(LookupSize + 1);
+        for (std::size_t i = 0; i <= LookupSize; ++i)
+            lookup_.push_back(interpolate(static_cast<double>(i) / LookupSize));
     }
 
     inline utymap::mapcss::Color evaluate(double time) const
+    {
+        if (lookup_.empty())
+            return utymap::mapcss::Color();
+
+        double position = std::max(0.0, std::min(time, 1.0)) * LookupSize;
+        return lookup_[static_cast<std::size_t>(position + 0.5)];
+    }
+
+    // Returns true if there is no color specified.
+    inline bool empty() const { return colors_.empty(); }
+
+    // Returns gradient data.
+    inline const GradientData& data() const { return colors_; }
+
+private:
+
+    // Calculates color between gradient stops.
+    utymap::mapcss::Color interpolate(double time) const
     {
         GradientData::size_type index = 0;
         while (index < colors_.size() - 1 && colors_[index].first < time)
@@ -40,11 +71,6 @@ public:
         return interpolate(pairA.second, pairB.second, mu);
     }
 
-    // Returns true if there is no color specified.
-    inline bool empty() const { return colors_.empty(); }
-
-private:
-
     // So far, use linear interpolation algorithm as the fastest.
     inline utymap::mapcss::Color interpolate(const utymap::mapcss::Color& a,
                                              const utymap::mapcss::Color& b,
@@ -54,6 +80,7 @@ private:
     }
 
     GradientData colors_;
+    std::vector<utymap::mapcss::Color> lookup_;
 };
 
 }}
@@ -0,0 +1,117 @@
+#ifndef MAPCSS_IMPORTFILTER_HPP_INCLUDED
+#define MAPCSS_IMPORTFILTER_HPP_INCLUDED
+
+#include "formats/FormatTypes.hpp"
+#include "mapcss/StyleSheet.hpp"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace utymap { namespace mapcss {
+
+// Describes elements and tags which can be matched by stylesheet in some level of
+// details range. Allows to skip data which is not used by stylesheet before it is stored.
+class ImportFilter
+{
+    typedef std::unordered_map<std::string, std::unordered_set<std::string>> ValueMap;
+
+    // Conditions which element should satisfy to have a chance to be matched.
+    struct ElementConditions
+    {
+        // True if there is selector without conditions which require tag presence.
+        bool matchesAll;
+        // Keys which presence is required by some selector.
+        std::unordered_set<std::string> keys;
+        // Key-value pairs which presence is required by some selector.
+        ValueMap values;
+
+        ElementConditions() : matchesAll(false), keys(), values()
+        {
+        }
+    };
+
+public:
+    enum ElementType { Node = 0, Way, Area, Relation };
+
+    ImportFilter() : conditions_(), keys_(), values_()
+    {
+    }
+
+    // Adds selector's conditions for given element type.
+    void addSelector(ElementType type, const std::vector<Condition>& conditions)
+    {
+        ElementConditions& elementConditions = conditions_[type];
+        bool hasRequired = false;
+        for (const Condition& condition : conditions) {
+            if (condition.operation == "") {
+                elementConditions.keys.insert(condition.key);
+                keys_.insert(condition.key);
+                hasRequired = true;
+            }
+            else if (condition.operation == "=") {
+                elementConditions.values[condition.key].insert(condition.value);
+                values_[condition.key].insert(condition.value);
+                hasRequired = true;
+            }
+            else {
+                // NOTE tag should be present as for matching, but any value can be used for comparison.
+                elementConditions.keys.insert(condition.key);
+                keys_.insert(condition.key);
+                hasRequired = true;
+            }
+        }
+        elementConditions.matchesAll |= !hasRequired;
+    }
+
+    // Adds key which values are used by stylesheet.
+    void addKey(const std::string& key)
+    {
+        keys_.insert(key);
+    }
+
+    // Checks whether element of given type with given tags can be matched by some selector.
+    bool canMatch(ElementType type, const utymap::formats::Tags& tags) const
+    {
+        const ElementConditions& elementConditions = conditions_[type];
+        if (elementConditions.matchesAll)
+            return true;
+
+        return std::any_of(tags.begin(), tags.end(), [&](const utymap::formats::Tag& tag) {
+            return elementConditions.keys.find(tag.key) != elementConditions.keys.end() ||
+                   contains(elementConditions.values, tag);
+        });
+    }
+
+    // Checks whether tag is used by stylesheet.
+    bool isUsed(const utymap::formats::Tag& tag) const
+    {
+        return keys_.find(tag.key) != keys_.end() || contains(values_, tag);
+    }
+
+    // Removes tags which are not used by stylesheet.
+    void apply(utymap::formats::Tags& tags) const
+    {
+        tags.erase(std::remove_if(tags.begin(), tags.end(),
+            [&](const utymap::formats::Tag& tag) { return !isUsed(tag); }), tags.end());
+    }
+
+private:
+
+    static bool contains(const ValueMap& values, const utymap::formats::Tag& tag)
+    {
+        auto valuesPair = values.find(tag.key);
+        return valuesPair != values.end() && valuesPair->second.find(tag.value) != valuesPair->second.end();
+    }
+
+    ElementConditions conditions_[4];
+    // Keys which any value is used.
+    std::unordered_set<std::string> keys_;
+    // Keys which only specific values are used.
+    ValueMap values_;
+};
+
+}}
+#endif  // MAPCSS_IMPORTFILTER_HPP_INCLUDED
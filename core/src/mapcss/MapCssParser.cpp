@@ -208,6 +208,7 @@ private:
 
     void readImport(const std::string& url)
     {
+        stylesheet.imports.push_back(directory + url);
         std::ifstream importFile(directory + url);
         std::string content((std::istreambuf_iterator<char>(importFile)), std::istreambuf_iterator<char>());
         // NOTE indirected recursion: caller must ensure that there is no recursive import.
@@ -8,70 +8,127 @@
 #include "utils/CoreUtils.hpp"
 #include "utils/GeoUtils.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <forward_list>
 #include <string>
 #include <memory>
-#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace utymap { namespace mapcss {
 
-// Represents style for element.
-struct Style
+// Represents style for element. Declarations are sorted by key and shared between
+// styles, element tags are referenced, so style is cheap to copy but it should not
+// outlive tags it is created for.
+class Style
 {
+public:
     typedef std::uint32_t key_type;
-    typedef std::shared_ptr<utymap::mapcss::StyleDeclaration> value_type;
-
-    std::unordered_map<key_type, value_type> declarations;
+    typedef std::shared_ptr<const utymap::mapcss::StyleDeclaration> value_type;
+    typedef std::vector<value_type> Declarations;
 
     Style(const std::vector<utymap::entities::Tag>& tags,
-          utymap::index::StringTable& stringTable)
-        : tags_(tags), stringTable_(stringTable), declarations()
+          utymap::index::StringTable& stringTable,
+          const std::shared_ptr<const Declarations>& declarations = nullptr)
+        : tags_(&tags), stringTable_(stringTable), declarations_(declarations), ownTags_(), evaluated_()
     {
     }
 
-    inline bool has(key_type key) const
+    // Returns copy of style with own copy of tags, so it can outlive element.
+    Style detached() const
     {
-        return declarations.find(key) != declarations.end();
+        Style style(*this);
+        style.ownTags_ = std::make_shared<const std::vector<utymap::entities::Tag>>(*tags_);
+        style.tags_ = style.ownTags_.get();
+        return style;
     }
 
-    inline bool has(key_type key, const std::string& value) const
+    // Returns style with the same declarations which references given tags,
+    // e.g. tags of element copy.
+    Style withTags(const std::vector<utymap::entities::Tag>& tags) const
+    {
+        return Style(tags, stringTable_, declarations_);
+    }
+
+    // Sorts declarations by key keeping the last one for duplicate keys.
+    static void normalize(Declarations& declarations)
     {
-        auto it = declarations.find(key);
-        return it != declarations.end() && *it->second->value() == value;
+        std::stable_sort(declarations.begin(), declarations.end(),
+            [](const value_type& d1, const value_type& d2) { return d1->key() < d2->key(); });
+        auto last = std::unique(declarations.rbegin(), declarations.rend(),
+            [](const value_type& d1, const value_type& d2) { return d1->key() == d2->key(); });
+        declarations.erase(declarations.begin(), last.base());
     }
 
-    inline void put(const value_type& declaration)
+    // Returns declarations sorted by key.
+    inline const Declarations& declarations() const
     {
-        declarations[declaration->key()] = declaration;
+        return declarations_ != nullptr ? *declarations_ : emptyDeclarations();
     }
 
-    inline value_type get(key_type key) const
+    inline bool empty() const
+    {
+        return declarations().empty();
+    }
+
+    inline bool has(key_type key) const
     {
-        auto it = declarations.find(key);
-        if (it == declarations.end())
+        return find(key) != nullptr;
+    }
+
+    inline bool has(key_type key, const std::string& value) const
+    {
+        const value_type* declaration = find(key);
+        return declaration != nullptr && (*declaration)->value() == value;
+    }
+
+    inline const value_type& get(key_type key) const
+    {
+        const value_type* declaration = find(key);
+        if (declaration == nullptr)
             throw MapCssException(std::string("Cannot find declaration with the key: ") + stringTable_.getString(key));
 
-        return it->second;
+        return *declaration;
     }
 
     // Gets string by given key. Empty string by default
-    inline std::shared_ptr<std::string> getString(const std::string& key) const
+    inline const std::string& getString(const std::string& key) const
     {
         key_type keyId = stringTable_.getId(key);
         return getString(keyId);
     }
-    
+
     // Gets string by given key. Empty string by default
-    inline std::shared_ptr<std::string> getString(key_type keyId) const
+    inline const std::string& getString(key_type keyId) const
     {
-        if (!has(keyId))
-            return std::make_shared<std::string>("");
+        const value_type* declaration = find(keyId);
+        if (declaration == nullptr)
+            return emptyString();
 
-        auto declaration = get(keyId);
+        if (!(*declaration)->isEval())
+            return (*declaration)->value();
 
-        return declaration->isEval()
-               ? std::make_shared<std::string>(declaration->evaluate<std::string>(tags_, stringTable_))
-               : declaration->value();
+        // NOTE evaluated values are kept to return reference on them.
+        for (const auto& value : evaluated_) {
+            if (value.first == keyId)
+                return value.second;
+        }
+        evaluated_.push_front(std::make_pair(keyId, (*declaration)->evaluate<std::string>(*tags_, stringTable_)));
+        return evaluated_.front().second;
+    }
+
+    // Gets gradient parsed from raw value by given key. Null by default.
+    inline std::shared_ptr<const ColorGradient> getGradient(const std::string& key) const
+    {
+        return getGradient(stringTable_.getId(key));
+    }
+
+    // Gets gradient parsed from raw value by given key. Null by default.
+    inline std::shared_ptr<const ColorGradient> getGradient(key_type keyId) const
+    {
+        const value_type* declaration = find(keyId);
+        return declaration != nullptr ? (*declaration)->gradient() : nullptr;
     }
 
     // Gets double value or zero.
@@ -88,34 +145,52 @@ struct Style
                            double size = 1,
                            const utymap::GeoCoordinate& coordinate = GeoCoordinate()) const
     {
-        if (!has(keyId))
+        const value_type* declaration = find(keyId);
+        if (declaration == nullptr)
             return 0;
 
-        auto declaration = get(keyId);
-        auto rawValue = declaration->value();
-        char dimen = (*rawValue)[rawValue->size() - 1];
-
-        if (dimen == 'm') {
-            double value = utymap::utils::parseDouble(rawValue->substr(0, rawValue->size() - 1));
-            return coordinate.isValid()
-                ? utymap::utils::GeoUtils::getOffset(coordinate, value)
-                : value;
+        switch ((*declaration)->unit()) {
+            case StyleDeclaration::Unit::Meters:
+                return coordinate.isValid()
+                    ? utymap::utils::GeoUtils::getOffset(coordinate, (*declaration)->number())
+                    : (*declaration)->number();
+            // relative to size
+            case StyleDeclaration::Unit::Percent:
+                return size * (*declaration)->number() * 0.01;
+            default:
+                return (*declaration)->isEval()
+                    ? (*declaration)->evaluate<double>(*tags_, stringTable_)
+                    : (*declaration)->number();
         }
+    }
 
-        // relative to size
-        if (dimen == '%') {
-            double value = utymap::utils::parseDouble(rawValue->substr(0, rawValue->size() - 1));
-            return size * value * 0.01;
-        }
+private:
 
-        return  declaration->isEval()
-                ? declaration->evaluate<double>(tags_, stringTable_)
-                : utymap::utils::parseDouble(*rawValue);
+    inline const value_type* find(key_type key) const
+    {
+        const Declarations& items = declarations();
+        auto it = std::lower_bound(items.begin(), items.end(), key,
+            [](const value_type& declaration, key_type k) { return declaration->key() < k; });
+        return it != items.end() && (*it)->key() == key ? &*it : nullptr;
     }
 
-private:
+    static const Declarations& emptyDeclarations()
+    {
+        static const Declarations declarations;
+        return declarations;
+    }
+
+    static const std::string& emptyString()
+    {
+        static const std::string value;
+        return value;
+    }
+
+    const std::vector<utymap::entities::Tag>* tags_;
     utymap::index::StringTable& stringTable_;
-    const std::vector<utymap::entities::Tag> tags_;
+    std::shared_ptr<const Declarations> declarations_;
+    std::shared_ptr<const std::vector<utymap::entities::Tag>> ownTags_;
+    mutable std::forward_list<std::pair<key_type, std::string>> evaluated_;
 };
 
 }}
@@ -0,0 +1,165 @@
+#ifndef MAPCSS_STYLECACHE_HPP_INCLUDED
+#define MAPCSS_STYLECACHE_HPP_INCLUDED
+
+#include "entities/Element.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace utymap { namespace mapcss {
+
+// Bounded thread safe cache of style matching results keyed by element type,
+// level of details and element tags. Split into shards with own lock and
+// least recently used eviction to reduce contention between threads.
+template <typename Value>
+class StyleCache
+{
+    typedef std::vector<utymap::entities::Tag> Tags;
+
+    struct Entry
+    {
+        std::size_t hash;
+        int type;
+        int levelOfDetails;
+        Tags tags;
+        std::shared_ptr<const Value> value;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    struct Shard
+    {
+        std::mutex lock;
+        EntryList entries;
+        std::unordered_multimap<std::size_t, typename EntryList::iterator> index;
+    };
+
+public:
+    typedef std::shared_ptr<const Value> ValuePtr;
+
+    StyleCache(std::size_t capacity = 16384, std::size_t shardCount = 16) :
+        shardCapacity_(std::max<std::size_t>(1, capacity / std::max<std::size_t>(1, shardCount))),
+        shards_(std::max<std::size_t>(1, shardCount))
+    {
+    }
+
+    // Returns cached value or null if there is no one.
+    ValuePtr get(int type, int levelOfDetails, const Tags& tags)
+    {
+        std::size_t hash = getHash(type, levelOfDetails, tags);
+        Shard& shard = getShard(hash);
+
+        std::lock_guard<std::mutex> lock(shard.lock);
+        auto entry = find(shard, hash, type, levelOfDetails, tags);
+        if (entry == shard.entries.end())
+            return nullptr;
+
+        shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+        return entry->value;
+    }
+
+    // Stores value and returns cached one: if value was added by another thread
+    // in between, existing value is kept.
+    ValuePtr put(int type, int levelOfDetails, const Tags& tags, const ValuePtr& value)
+    {
+        std::size_t hash = getHash(type, levelOfDetails, tags);
+        Shard& shard = getShard(hash);
+
+        std::lock_guard<std::mutex> lock(shard.lock);
+        auto entry = find(shard, hash, type, levelOfDetails, tags);
+        if (entry != shard.entries.end())
+            return entry->value;
+
+        if (shard.entries.size() >= shardCapacity_)
+            evict(shard);
+
+        shard.entries.push_front(Entry{ hash, type, levelOfDetails, tags, value });
+        shard.index.insert(std::make_pair(hash, shard.entries.begin()));
+        return value;
+    }
+
+    // Removes all cached values.
+    void clear()
+    {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.lock);
+            shard.index.clear();
+            shard.entries.clear();
+        }
+    }
+
+    // Returns amount of cached values.
+    std::size_t size()
+    {
+        std::size_t count = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.lock);
+            count += shard.entries.size();
+        }
+        return count;
+    }
+
+private:
+
+    static std::size_t getHash(int type, int levelOfDetails, const Tags& tags)
+    {
+        std::size_t seed = static_cast<std::size_t>(type) * 31 + static_cast<std::size_t>(levelOfDetails);
+        for (const auto& tag : tags) {
+            std::uint64_t value = (static_cast<std::uint64_t>(tag.key) << 32) | tag.value;
+            seed ^= std::hash<std::uint64_t>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        }
+        return seed;
+    }
+
+    inline Shard& getShard(std::size_t hash)
+    {
+        return shards_[(hash >> 8) % shards_.size()];
+    }
+
+    static typename EntryList::iterator find(Shard& shard, std::size_t hash, int type, int levelOfDetails, const Tags& tags)
+    {
+        auto range = shard.index.equal_range(hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            const Entry& entry = *it->second;
+            if (entry.type == type && entry.levelOfDetails == levelOfDetails && equals(entry.tags, tags))
+                return it->second;
+        }
+        return shard.entries.end();
+    }
+
+    static bool equals(const Tags& first, const Tags& second)
+    {
+        return first.size() == second.size() &&
+            std::equal(first.begin(), first.end(), second.begin(),
+                [](const utymap::entities::Tag& t1, const utymap::entities::Tag& t2) {
+                    return t1.key == t2.key && t1.value == t2.value;
+            });
+    }
+
+    static void evict(Shard& shard)
+    {
+        auto last = std::prev(shard.entries.end());
+        auto range = shard.index.equal_range(last->hash);
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == last) {
+                shard.index.erase(it);
+                break;
+            }
+        }
+        shard.entries.erase(last);
+    }
+
+    const std::size_t shardCapacity_;
+    std::vector<Shard> shards_;
+};
+
+}}
+
+#endif  // MAPCSS_STYLECACHE_HPP_INCLUDED
@@ -4,27 +4,48 @@
 #include "Exceptions.hpp"
 #include "entities/Element.hpp"
 #include "index/StringTable.hpp"
+#include "mapcss/ColorGradient.hpp"
 #include "mapcss/StyleEvaluator.hpp"
+#include "utils/CoreUtils.hpp"
 #include "utils/ElementUtils.hpp"
 
-#include <boost/variant/recursive_variant.hpp>
-#include <boost/variant/apply_visitor.hpp>
-
 #include <cstdint>
 #include <string>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace utymap { namespace mapcss {
 
-// Represents style declaration which support evaluation.
+// Represents style declaration which support evaluation. Value is parsed once
+// on creation, so it can be used without parsing raw string.
 struct StyleDeclaration
 {
-    StyleDeclaration(std::uint32_t key, const std::string& value) :
+    // Specifies unit of numeric value.
+    enum class Unit { None, Meters, Percent };
+
+    StyleDeclaration(std::uint32_t key, const std::string& value,
+                     const std::shared_ptr<const ColorGradient>& gradient = nullptr) :
         key_(key), 
-        value_(std::make_shared<std::string>(value)), 
-        tree_(StyleEvaluator::parse(value))
+        value_(value), 
+        tree_(StyleEvaluator::parse(value)),
+        program_(),
+        compileFlag_(),
+        builders_(),
+        gradient_(gradient),
+        number_(0),
+        unit_(Unit::None)
     {
+        if (tree_ != nullptr || value_.empty())
+            return;
+
+        std::size_t size = value_.size();
+        char dimen = value_[size - 1];
+        if (dimen == 'm' || dimen == '%') {
+            unit_ = dimen == 'm' ? Unit::Meters : Unit::Percent;
+            --size;
+        }
+        number_ = utymap::utils::parseDouble(value_.data(), size);
     }
 
     ~StyleDeclaration() {}
@@ -33,11 +54,35 @@ struct StyleDeclaration
     inline std::uint32_t key() const { return key_; };
 
     // Gets declaration value.
-    inline std::shared_ptr<std::string> value() const { return value_; };
+    inline const std::string& value() const { return value_; };
+
+    // Gets numeric value without unit. Zero if value is not a number.
+    inline double number() const { return number_; }
+
+    // Gets unit of numeric value.
+    inline Unit unit() const { return unit_; }
+
+    // Gets color gradient if value represents color or gradient.
+    inline const std::shared_ptr<const ColorGradient>& gradient() const { return gradient_; }
 
     // Gets true if declaration should be evaluated
     inline bool isEval() const { return tree_ != nullptr; }
 
+    // Gets indices of builders listed by value in builder names of style provider.
+    // Empty if declaration does not list builders or should be evaluated.
+    inline const std::vector<std::uint16_t>& builders() const { return builders_; }
+
+    // Sets indices of builders listed by value. Called only on stylesheet load.
+    inline void setBuilders(const std::vector<std::uint16_t>& builders) { builders_ = builders; }
+
+    // Compiles expression resolving its tag keys. Called once on stylesheet load,
+    // otherwise on first evaluation.
+    inline void compile(utymap::index::StringTable& stringTable) const
+    {
+        if (isEval())
+            std::call_once(compileFlag_, [&]() { program_ = StyleEvaluator::Program::compile(*tree_, stringTable); });
+    }
+
     // Evaluates expression using tags
     template <typename T>
     inline T evaluate(const std::vector<utymap::entities::Tag>& tags,
@@ -46,14 +91,21 @@ struct StyleDeclaration
         if (!isEval())
             throw utymap::MapCssException("Cannot evaluate raw value.");
 
-        return StyleEvaluator::evaluate<T>(*tree_, tags, stringTable);
+        compile(stringTable);
+        return StyleEvaluator::evaluate<T>(*program_, tags, stringTable);
     }
 
 private:
 
     const std::uint32_t key_;
-    std::shared_ptr<std::string> value_;
+    const std::string value_;
     std::shared_ptr<StyleEvaluator::Tree> tree_;
+    mutable std::shared_ptr<const StyleEvaluator::Program> program_;
+    mutable std::once_flag compileFlag_;
+    std::vector<std::uint16_t> builders_;
+    std::shared_ptr<const ColorGradient> gradient_;
+    double number_;
+    Unit unit_;
 };
 
 }}
@@ -1,10 +1,15 @@
 #include "mapcss/StyleEvaluator.hpp"
+#include "utils/CoreUtils.hpp"
 
 #include <boost/config/warning_disable.hpp>
 #include <boost/spirit/include/qi.hpp>
 #include <boost/fusion/include/adapt_struct.hpp>
+#include <boost/variant/apply_visitor.hpp>
+#include <boost/variant/static_visitor.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <stdexcept>
 
 using namespace utymap::entities;
 using namespace utymap::index;
@@ -91,4 +96,195 @@ std::shared_ptr<Tree> StyleEvaluator::parse(const std::string& expression)
         tree.reset();
     
     return tree;
-}
\ No newline at end of file
+}
+
+namespace {
+
+    typedef StyleEvaluator::Program::Instruction Instruction;
+    typedef StyleEvaluator::Program::OpCode OpCode;
+
+    // Emits bytecode for AST tracking required stack size.
+    struct Compiler : public boost::static_visitor<void>
+    {
+        Compiler(std::vector<Instruction>& instructions, StringTable& stringTable) :
+            instructions(instructions), stringTable(stringTable), depth(0), maxDepth(0)
+        {
+        }
+
+        void operator()(Nil) { push(Instruction{ OpCode::Number, 0, 0 }); }
+
+        void operator()(double n) { push(Instruction{ OpCode::Number, 0, n }); }
+
+        void operator()(const std::string& tagKey) { push(Instruction{ OpCode::Tag, stringTable.getId(tagKey), 0 }); }
+
+        void operator()(const Signed& s)
+        {
+            boost::apply_visitor(*this, s.operand);
+            if (s.sign == '-')
+                instructions.push_back(Instruction{ OpCode::Negate, 0, 0 });
+        }
+
+        void operator()(const Tree& tree)
+        {
+            boost::apply_visitor(*this, tree.first);
+            for (const Operation& operation : tree.rest) {
+                boost::apply_visitor(*this, operation.operand);
+                --depth;
+                switch (operation.operator_) {
+                    case '+': instructions.push_back(Instruction{ OpCode::Add, 0, 0 }); break;
+                    case '-': instructions.push_back(Instruction{ OpCode::Subtract, 0, 0 }); break;
+                    case '*': instructions.push_back(Instruction{ OpCode::Multiply, 0, 0 }); break;
+                    case '/': instructions.push_back(Instruction{ OpCode::Divide, 0, 0 }); break;
+                    default:
+                        throw std::domain_error(std::string("Evaluator: unsupported operator ") + operation.operator_);
+                }
+            }
+        }
+
+        std::vector<Instruction>& instructions;
+        StringTable& stringTable;
+        std::size_t depth;
+        std::size_t maxDepth;
+
+    private:
+        void push(const Instruction& instruction)
+        {
+            instructions.push_back(instruction);
+            maxDepth = std::max(maxDepth, ++depth);
+        }
+    };
+
+    // Finds tag key used as string value: first operand of expression.
+    struct StringKeyFinder : public boost::static_visitor<const std::string*>
+    {
+        const std::string* operator()(const std::string& tagKey) const { return &tagKey; }
+        const std::string* operator()(const Tree& tree) const { return boost::apply_visitor(*this, tree.first); }
+
+        template <typename T>
+        const std::string* operator()(const T&) const { return nullptr; }
+    };
+
+    // Stack size which is allocated on call stack.
+    const std::size_t LocalStackSize = 32;
+    // Amount of cached numbers per thread, should be power of two.
+    const std::size_t CachedNumberCount = 1024;
+    // Amount of slots checked for cached number before one is replaced.
+    const std::size_t CachedNumberProbes = 4;
+
+    // Number parsed from tag value by specific program.
+    struct CachedNumber
+    {
+        std::uint64_t key;
+        double value;
+        bool isSet;
+    };
+
+    // Source of unique program ids.
+    std::atomic<std::uint32_t> nextProgramId(0);
+
+    // Finds tag with given key using binary search.
+    const Tag* findTag(std::uint32_t key, const std::vector<Tag>& tags)
+    {
+        auto begin = tags.begin();
+        auto end = tags.end();
+        while (begin < end) {
+            const auto middle = begin + (std::distance(begin, end) / 2);
+            if (middle->key == key)
+                return &*middle;
+            else if (middle->key > key)
+                end = middle;
+            else
+                begin = middle + 1;
+        }
+        return nullptr;
+    }
+
+    const Tag& getTag(std::uint32_t key, const std::vector<Tag>& tags, StringTable& stringTable)
+    {
+        const Tag* tag = findTag(key, tags);
+        if (tag == nullptr)
+            throw std::domain_error("Cannot find tag:" + stringTable.getString(key));
+        return *tag;
+    }
+}
+
+std::shared_ptr<const StyleEvaluator::Program> StyleEvaluator::Program::compile(const Tree& tree, StringTable& stringTable)
+{
+    std::shared_ptr<Program> program(new Program());
+    program->id_ = nextProgramId++;
+
+    Compiler compiler(program->instructions_, stringTable);
+    compiler(tree);
+    program->stackSize_ = compiler.maxDepth;
+
+    const std::string* stringKey = StringKeyFinder()(tree);
+    if (stringKey != nullptr) {
+        program->hasStringKey_ = true;
+        program->stringKey_ = stringTable.getId(*stringKey);
+    }
+
+    return program;
+}
+
+double StyleEvaluator::Program::evaluateDouble(const std::vector<Tag>& tags, StringTable& stringTable) const
+{
+    double localStack[LocalStackSize];
+    std::vector<double> heapStack;
+    double* stack = localStack;
+    if (stackSize_ > LocalStackSize) {
+        heapStack.resize(stackSize_);
+        stack = heapStack.data();
+    }
+
+    std::size_t top = 0;
+    for (const Instruction& instruction : instructions_) {
+        switch (instruction.code) {
+            case OpCode::Number: stack[top++] = instruction.number; break;
+            case OpCode::Tag: stack[top++] = getNumber(instruction.key, tags, stringTable); break;
+            case OpCode::Negate: stack[top - 1] = -stack[top - 1]; break;
+            case OpCode::Add: --top; stack[top - 1] += stack[top]; break;
+            case OpCode::Subtract: --top; stack[top - 1] -= stack[top]; break;
+            case OpCode::Multiply: --top; stack[top - 1] *= stack[top]; break;
+            case OpCode::Divide: --top; stack[top - 1] /= stack[top]; break;
+        }
+    }
+    return top > 0 ? stack[top - 1] : 0;
+}
+
+std::string StyleEvaluator::Program::evaluateString(const std::vector<Tag>& tags, StringTable& stringTable) const
+{
+    if (!hasStringKey_)
+        throw std::domain_error("Evaluator: unsupported operation.");
+
+    return stringTable.getString(getTag(stringKey_, tags, stringTable).value);
+}
+
+double StyleEvaluator::Program::getNumber(std::uint32_t key, const std::vector<Tag>& tags, StringTable& stringTable) const
+{
+    // NOTE cache is per thread to avoid locking on hot path and is preallocated to avoid
+    // allocations. Program id is used instead of string table address as table can be
+    // recreated at the same place with other ids.
+    static thread_local CachedNumber numbers[CachedNumberCount];
+
+    std::uint32_t valueId = getTag(key, tags, stringTable).value;
+    std::uint64_t cacheKey = (static_cast<std::uint64_t>(id_) << 32) | valueId;
+    std::size_t start = static_cast<std::size_t>((cacheKey * 11400714819323198485ULL) >> 32);
+
+    CachedNumber* freeSlot = nullptr;
+    for (std::size_t i = 0; i < CachedNumberProbes; ++i) {
+        CachedNumber& cached = numbers[(start + i) & (CachedNumberCount - 1)];
+        if (!cached.isSet) {
+            freeSlot = &cached;
+            break;
+        }
+        if (cached.key == cacheKey)
+            return cached.value;
+    }
+
+    double number = utymap::utils::parseDouble(stringTable.getString(valueId));
+
+    // NOTE first probed slot is replaced when all of them are used.
+    CachedNumber& slot = freeSlot != nullptr ? *freeSlot : numbers[start & (CachedNumberCount - 1)];
+    slot = CachedNumber{ cacheKey, number, true };
+    return number;
+}
@@ -3,17 +3,13 @@
 
 #include "entities/Element.hpp"
 #include "index/StringTable.hpp"
-#include "utils/CoreUtils.hpp"
-#include "utils/ElementUtils.hpp"
 
 #include <boost/variant/recursive_variant.hpp>
-#include <boost/variant/apply_visitor.hpp>
 
 #include <cstdint>
 #include <string>
 #include <list>
 #include <memory>
-#include <type_traits>
 #include <vector>
 
 namespace utymap { namespace mapcss {
@@ -48,109 +44,77 @@ struct StyleEvaluator
     // Parses expression into AST.
     static std::shared_ptr<Tree> parse(const std::string& expression);
 
-    // Evaluates expression using tags.
-    template <typename T>
-    static T evaluate(const Tree& tree,
-                      const std::vector<utymap::entities::Tag>& tags,
-                      utymap::index::StringTable& stringTable)
-    {
-        typedef typename std::conditional<std::is_same<T, std::string>::value, StringEvaluator, DoubleEvaluator>::type EvaluatorType;
-        return EvaluatorType(tags, stringTable)(tree);
-    }
-
-private:
-
-    // Specifies default AST evaluator behaviour.
-    template <typename T>
-    struct Evaluator
+    // Represents expression compiled into flat stack machine bytecode.
+    class Program
     {
-        typedef T result_type;
+    public:
+        enum class OpCode : std::uint8_t { Number, Tag, Negate, Add, Subtract, Multiply, Divide };
 
-        Evaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : tags_(tags), stringTable_(stringTable)  { }
+        struct Instruction
+        {
+            OpCode code;
+            // Tag key id for Tag operation.
+            std::uint32_t key;
+            // Constant for Number operation.
+            double number;
+        };
 
-    protected:
-        std::string throwException() const { throw std::domain_error("Evaluator: unsupported operation."); }
+        // Compiles AST resolving tag keys using string table.
+        static std::shared_ptr<const Program> compile(const Tree& tree, utymap::index::StringTable& stringTable);
 
-        const std::vector<utymap::entities::Tag>& tags_;
-        utymap::index::StringTable& stringTable_;
-    };
+        // Evaluates expression as number.
+        double evaluateDouble(const std::vector<utymap::entities::Tag>& tags,
+                              utymap::index::StringTable& stringTable) const;
 
-    // Evaluates double from AST.
-    struct DoubleEvaluator : public Evaluator<double>
-    {
-        DoubleEvaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : Evaluator(tags, stringTable) { }
+        // Evaluates expression as string: only single tag is supported.
+        std::string evaluateString(const std::vector<utymap::entities::Tag>& tags,
+                                   utymap::index::StringTable& stringTable) const;
 
-        double operator()(Nil) const { return 0; }
-        double operator()(double n) const { return n; }
+        inline const std::vector<Instruction>& instructions() const { return instructions_; }
 
-        double operator()(const Operation& o, double lhs) const
+    private:
+        Program() : instructions_(), stackSize_(0), hasStringKey_(false), stringKey_(0), id_(0)
         {
-            double rhs = boost::apply_visitor(*this, o.operand);
-            switch (o.operator_) {
-            case '+': return lhs + rhs;
-            case '-': return lhs - rhs;
-            case '*': return lhs * rhs;
-            case '/': return lhs / rhs;
-            }
-            return 0;
         }
 
-        double operator()(const std::string& tagKey) const
-        {
-            auto keyId = stringTable_.getId(tagKey);
-            return utymap::utils::parseDouble(utymap::utils::getTagValue(keyId, tags_, stringTable_));
-        }
+        // Returns numeric value of tag with given key.
+        double getNumber(std::uint32_t key,
+                         const std::vector<utymap::entities::Tag>& tags,
+                         utymap::index::StringTable& stringTable) const;
 
-        double operator()(const Signed& s) const
-        {
-            double rhs = boost::apply_visitor(*this, s.operand);
-            switch (s.sign) {
-            case '-': return -rhs;
-            case '+': return +rhs;
-            }
-            return 0;
-        }
+        std::vector<Instruction> instructions_;
+        std::size_t stackSize_;
+        bool hasStringKey_;
+        std::uint32_t stringKey_;
 
-        double operator()(const Tree& tree) const
-        {
-            double state = boost::apply_visitor(*this, tree.first);
-            for (const Operation& oper : tree.rest)
-                state = (*this)(oper, state);
-            return state;
-        }
+        // Unique program id: keys parsed numbers in per thread cache.
+        std::uint32_t id_;
     };
 
-    // Evaluates string from AST.
-    struct StringEvaluator : public Evaluator<std::string>
+    // Evaluates compiled expression using tags.
+    template <typename T>
+    static T evaluate(const Program& program,
+                      const std::vector<utymap::entities::Tag>& tags,
+                      utymap::index::StringTable& stringTable)
     {
-        StringEvaluator(const std::vector<utymap::entities::Tag>& tags,
-            utymap::index::StringTable& stringTable)
-            : Evaluator(tags, stringTable) { }
-
-        std::string operator()(Nil) const { return throwException(); }
-        std::string operator()(double n) const { return throwException(); }
-
-        std::string operator()(const Operation& o, double lhs) const { return throwException(); }
-
-        std::string operator()(const std::string& tagKey) const
-        {
-            return utymap::utils::getTagValue(stringTable_.getId(tagKey), tags_, stringTable_);
-        }
+        return evaluate(program, tags, stringTable, static_cast<T*>(nullptr));
+    }
 
-        std::string operator()(const Signed& s) const { return throwException(); }
+private:
 
-        std::string operator()(const Tree& tree) const
-        {
-            return boost::apply_visitor(*this, tree.first);
-        }
-    };
+    static double evaluate(const Program& program,
+                           const std::vector<utymap::entities::Tag>& tags,
+                           utymap::index::StringTable& stringTable, double*)
+    {
+        return program.evaluateDouble(tags, stringTable);
+    }
 
-    std::shared_ptr<std::string> value_;
-    std::shared_ptr<Tree> tree_;
+    static std::string evaluate(const Program& program,
+                                const std::vector<utymap::entities::Tag>& tags,
+                                utymap::index::StringTable& stringTable, std::string*)
+    {
+        return program.evaluateString(tags, stringTable);
+    }
 };
 
 } }
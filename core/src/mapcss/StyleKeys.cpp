@@ -0,0 +1,90 @@
+#include "mapcss/StyleKeys.hpp"
+
+#include <sstream>
+
+using namespace utymap::index;
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string TerrainLayerKey = "terrain-layer";
+    const std::string LayerPriorityKey = "layer-priority";
+}
+
+StyleKeys::StyleKeys(const StyleSheet& stylesheet, StringTable& stringTable) :
+    building(stringTable.getId("building")),
+    multipolygon(stringTable.getId("multipolygon")),
+    height(stringTable.getId("height")),
+    minHeight(stringTable.getId("min-height")),
+    roofType(stringTable.getId("roof-type")),
+    roofHeight(stringTable.getId("roof-height")),
+    roofColor(stringTable.getId("roof-color")),
+    facadeType(stringTable.getId("facade-type")),
+    facadeColor(stringTable.getId("facade-color")),
+    color(stringTable.getId("color")),
+    offset(stringTable.getId("offset")),
+    width(stringTable.getId("width")),
+    terrainLayer(stringTable.getId(TerrainLayerKey)),
+    layerPriority(stringTable.getId(LayerPriorityKey)),
+    gridCellSize(stringTable.getId("grid-cell-size")),
+    foliageColor(stringTable.getId("foliage-color")),
+    foliageRadius(stringTable.getId("foliage-radius")),
+    trunkColor(stringTable.getId("trunk-color")),
+    trunkRadius(stringTable.getId("trunk-radius")),
+    trunkHeight(stringTable.getId("trunk-height")),
+    builders(stringTable.getId("builders")),
+    stringTable_(stringTable),
+    terrainKeys_(),
+    otherKeys_(),
+    lock_()
+{
+    terrainKeys_.insert(std::make_pair("", resolve("")));
+
+    for (const Rule& rule : stylesheet.rules) {
+        for (const Declaration& declaration : rule.declarations) {
+            if (declaration.key == TerrainLayerKey || declaration.key == LayerPriorityKey)
+                addLayers(declaration.value);
+        }
+    }
+}
+
+const StyleKeys::TerrainKeys& StyleKeys::terrain(const std::string& prefix) const
+{
+    auto keys = terrainKeys_.find(prefix);
+    if (keys != terrainKeys_.end())
+        return keys->second;
+
+    // NOTE layer can be defined by evaluated value, so resolve it on demand.
+    std::lock_guard<std::mutex> lock(lock_);
+    keys = otherKeys_.find(prefix);
+    if (keys == otherKeys_.end())
+        keys = otherKeys_.insert(std::make_pair(prefix, resolve(prefix))).first;
+    return keys->second;
+}
+
+StyleKeys::TerrainKeys StyleKeys::resolve(const std::string& prefix) const
+{
+    return TerrainKeys {
+        stringTable_.getId(prefix + "max-area"),
+        stringTable_.getId(prefix + "ele-noise-freq"),
+        stringTable_.getId(prefix + "color-noise-freq"),
+        stringTable_.getId(prefix + "height-offset"),
+        stringTable_.getId(prefix + "color"),
+        stringTable_.getId(prefix + "mesh-name"),
+        stringTable_.getId(prefix + "mesh-extras")
+    };
+}
+
+void StyleKeys::addLayers(const std::string& names)
+{
+    std::stringstream ss(names);
+    while (ss.good()) {
+        std::string name;
+        getline(ss, name, ',');
+        if (name.empty())
+            continue;
+
+        std::string prefix = name + "-";
+        if (terrainKeys_.find(prefix) == terrainKeys_.end())
+            terrainKeys_.insert(std::make_pair(prefix, resolve(prefix)));
+    }
+}
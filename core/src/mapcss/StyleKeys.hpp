@@ -0,0 +1,77 @@
+#ifndef MAPCSS_STYLEKEYS_HPP_INCLUDED
+#define MAPCSS_STYLEKEYS_HPP_INCLUDED
+
+#include "index/StringTable.hpp"
+#include "mapcss/StyleSheet.hpp"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace utymap { namespace mapcss {
+
+// Registry of well known style keys used by builders. Keys are resolved
+// to string ids once, so builders do not access string table per element.
+class StyleKeys
+{
+public:
+    typedef std::uint32_t key_type;
+
+    // Keys of terrain region options which are prefixed by layer name.
+    struct TerrainKeys
+    {
+        key_type maxArea;
+        key_type eleNoiseFreq;
+        key_type colorNoiseFreq;
+        key_type heightOffset;
+        key_type color;
+        key_type meshName;
+        key_type meshExtras;
+    };
+
+    // Resolves keys including terrain keys of all layers found in stylesheet.
+    StyleKeys(const utymap::mapcss::StyleSheet& stylesheet, utymap::index::StringTable& stringTable);
+
+    // Returns terrain keys for given layer prefix, e.g. "water-". Empty
+    // prefix is used for background and regions without layer.
+    const TerrainKeys& terrain(const std::string& prefix) const;
+
+    const key_type building;
+    const key_type multipolygon;
+    const key_type height;
+    const key_type minHeight;
+    const key_type roofType;
+    const key_type roofHeight;
+    const key_type roofColor;
+    const key_type facadeType;
+    const key_type facadeColor;
+    const key_type color;
+    const key_type offset;
+    const key_type width;
+    const key_type terrainLayer;
+    const key_type layerPriority;
+    const key_type gridCellSize;
+    const key_type foliageColor;
+    const key_type foliageRadius;
+    const key_type trunkColor;
+    const key_type trunkRadius;
+    const key_type trunkHeight;
+    const key_type builders;
+
+private:
+    TerrainKeys resolve(const std::string& prefix) const;
+
+    void addLayers(const std::string& names);
+
+    utymap::index::StringTable& stringTable_;
+    // Keys of layers known from stylesheet: not modified after construction.
+    std::unordered_map<std::string, TerrainKeys> terrainKeys_;
+    // Keys of layers which are not mentioned in stylesheet.
+    mutable std::unordered_map<std::string, TerrainKeys> otherKeys_;
+    mutable std::mutex lock_;
+};
+
+}}
+
+#endif  // MAPCSS_STYLEKEYS_HPP_INCLUDED
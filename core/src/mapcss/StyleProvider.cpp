@@ -4,9 +4,18 @@
 #include "entities/Area.hpp"
 #include "entities/Relation.hpp"
 #include "mapcss/Style.hpp"
+#include "mapcss/StyleCache.hpp"
 #include "mapcss/StyleProvider.hpp"
 #include "utils/GradientUtils.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
 using namespace utymap::entities;
 using namespace utymap::index;
 using namespace utymap::mapcss;
@@ -26,11 +35,109 @@ struct ConditionType
 struct Filter
 {
     std::vector<ConditionType> conditions;
-    std::unordered_map<uint32_t, Style::value_type> declarations;
+    Style::Declarations declarations;
+    // Bit per level of details where filter is defined.
+    std::uint32_t lodMask;
+};
+
+// Filters for specific element type and level of details indexed by their most
+// selective condition: element is checked only against filters which can match it.
+class FilterIndex
+{
+public:
+
+    FilterIndex() : filters_(), byValue_(), byKey_(), unconditional_()
+    {
+    }
+
+    void add(const Filter& filter)
+    {
+        std::uint32_t index = static_cast<std::uint32_t>(filters_.size());
+        filters_.push_back(filter);
+
+        auto equals = std::find_if(filter.conditions.begin(), filter.conditions.end(),
+            [](const ConditionType& c) { return c.type == OpType::Equals; });
+        if (equals != filter.conditions.end()) {
+            byValue_[makeKey(equals->key, equals->value)].push_back(index);
+            return;
+        }
+
+        auto exists = std::find_if(filter.conditions.begin(), filter.conditions.end(),
+            [](const ConditionType& c) { return c.type == OpType::Exists; });
+        if (exists != filter.conditions.end())
+            byKey_[exists->key].push_back(index);
+        else
+            unconditional_.push_back(index);
+    }
+
+    // Collects indices of filters which may match given tags. When ordered is set,
+    // indices are sorted to keep declaration order of filters.
+    void findCandidates(const std::vector<Tag>& tags, std::vector<std::uint32_t>& candidates, bool ordered) const
+    {
+        candidates.insert(candidates.end(), unconditional_.begin(), unconditional_.end());
+        for (const Tag& tag : tags) {
+            if (!byValue_.empty()) {
+                auto valuePair = byValue_.find(makeKey(tag.key, tag.value));
+                if (valuePair != byValue_.end())
+                    candidates.insert(candidates.end(), valuePair->second.begin(), valuePair->second.end());
+            }
+            if (!byKey_.empty()) {
+                auto keyPair = byKey_.find(tag.key);
+                if (keyPair != byKey_.end())
+                    candidates.insert(candidates.end(), keyPair->second.begin(), keyPair->second.end());
+            }
+        }
+
+        if (ordered) {
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        }
+    }
+
+    inline const Filter& get(std::uint32_t index) const { return filters_[index]; }
+
+    inline const std::vector<Filter>& filters() const { return filters_; }
+
+private:
+
+    static inline std::uint64_t makeKey(std::uint32_t key, std::uint32_t value)
+    {
+        return (static_cast<std::uint64_t>(key) << 32) | value;
+    }
+
+    std::vector<Filter> filters_;
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> byValue_;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> byKey_;
+    std::vector<std::uint32_t> unconditional_;
 };
 
 // key: level of detais, value: filters for specific element type.
-typedef std::unordered_map<int, std::vector<Filter>> FilterMap;
+typedef std::unordered_map<int, FilterIndex> FilterMap;
+
+// Keeps selector's data required to build import filter.
+struct SelectorInfo
+{
+    ImportFilter::ElementType type;
+    Zoom zoom;
+    std::vector<Condition> conditions;
+    std::vector<std::string> tagKeys;
+};
+
+// Limits amount of gradients which are not defined in stylesheet but requested at runtime.
+const std::size_t MaxRuntimeGradients = 256;
+
+// Finds keys of tags used by eval expressions: tag('key').
+void addTagKeys(const std::string& value, std::vector<std::string>& keys)
+{
+    const std::string prefix = "tag('";
+    for (auto start = value.find(prefix); start != std::string::npos; start = value.find(prefix, start)) {
+        start += prefix.size();
+        auto end = value.find('\'', start);
+        if (end == std::string::npos)
+            break;
+        keys.push_back(value.substr(start, end - start));
+    }
+}
 
 struct FilterCollection
 {
@@ -39,125 +146,190 @@ struct FilterCollection
     FilterMap areas;
     FilterMap relations;
     FilterMap canvases;
+
+    // Filters of all level of details: each filter is stored once with its
+    // level of details mask, so element is matched for all of them in one pass.
+    FilterIndex lodNodes;
+    FilterIndex lodWays;
+    FilterIndex lodAreas;
+    FilterIndex lodRelations;
 };
 
-class StyleBuilder : public ElementVisitor
+// Result of matching tags against filters. Does not depend on element itself,
+// so it is shared between elements of the same type with the same tags.
+struct MatchResult
 {
-    typedef std::vector<Tag>::const_iterator TagIterator;
-public:
+    bool isMatched;
+    std::shared_ptr<const Style::Declarations> declarations;
 
-    StyleBuilder(std::vector<Tag> tags, StringTable& stringTable,
-                 const FilterCollection& filters, int levelOfDetails, bool onlyCheck = false) :
-            filters_(filters),
-            levelOfDetails_(levelOfDetails),
-            onlyCheck_(onlyCheck),
-            canBuild_(false),
-            style_(tags, stringTable)
+    MatchResult() : isMatched(false), declarations()
     {
     }
+};
+
+// Result of matching tags against filters of all level of details: level of
+// details matched by the same filters are grouped and share declarations.
+struct LodMatchResult
+{
+    struct Group
+    {
+        std::uint32_t lodMask;
+        std::shared_ptr<const Style::Declarations> declarations;
+    };
+
+    std::vector<Group> groups;
+};
 
-    void visitNode(const Node& node) { checkOrBuild(node.tags, filters_.nodes); }
+// Selects filters for visited element type.
+class FilterSelector : public ElementVisitor
+{
+public:
 
-    void visitWay(const Way& way) { checkOrBuild(way.tags, filters_.ways); }
+    FilterSelector(const FilterCollection& filters) :
+        type(ImportFilter::Node),
+        filterMap(nullptr),
+        lodFilters(nullptr),
+        filters_(filters)
+    {
+    }
 
-    void visitArea(const Area& area) { checkOrBuild(area.tags, filters_.areas); }
+    void visitNode(const Node&) { select(ImportFilter::Node, filters_.nodes, filters_.lodNodes); }
 
-    void visitRelation(const Relation& relation) { checkOrBuild(relation.tags, filters_.relations); }
+    void visitWay(const Way&) { select(ImportFilter::Way, filters_.ways, filters_.lodWays); }
 
-    inline bool canBuild() { return canBuild_; }
+    void visitArea(const Area&) { select(ImportFilter::Area, filters_.areas, filters_.lodAreas); }
 
-    inline Style build()
-    {
-        if (onlyCheck_)
-            throw std::domain_error("Cannot build feature for check mode.");
+    void visitRelation(const Relation&) { select(ImportFilter::Relation, filters_.relations, filters_.lodRelations); }
 
-        return style_;
-    }
+    ImportFilter::ElementType type;
+    const FilterMap* filterMap;
+    const FilterIndex* lodFilters;
 
 private:
 
-    inline void checkOrBuild(const std::vector<Tag>& tags, const FilterMap& filters)
+    inline void select(ImportFilter::ElementType elementType, const FilterMap& filters, const FilterIndex& lods)
     {
-        if (onlyCheck_)
-            check(tags, filters);
+        type = elementType;
+        filterMap = &filters;
+        lodFilters = &lods;
+    }
+
+    const FilterCollection &filters_;
+};
+
+// checks tag's value assuming that the key is already checked.
+inline bool match_tag(const Tag& tag, const ConditionType& condition)
+{
+    switch (condition.type) {
+        case OpType::Exists:
+            return true;
+        case OpType::Equals:
+            return tag.value == condition.value;
+        case OpType::NotEquals:
+            return tag.value != condition.value;
+    }
+    return false;
+}
+
+// tries to find tag which satisfy condition using binary search.
+bool match_tags(std::vector<Tag>::const_iterator begin, std::vector<Tag>::const_iterator end, const ConditionType& condition)
+{
+    while (begin < end) {
+        const auto middle = begin + (std::distance(begin, end) / 2);
+        if (middle->key == condition.key)
+            return match_tag(*middle, condition);
+        else if (middle->key > condition.key)
+            end = middle;
         else
-            build(tags, filters);
+            begin = middle + 1;
     }
+    return false;
+}
 
-    // checks tag's value assuming that the key is already checked.
-    inline bool match_tag(const Tag& tag, const ConditionType& condition)
-    {
-        switch (condition.type) {
-            case OpType::Exists:
-                return true;
-            case OpType::Equals:
-                return tag.value == condition.value;
-            case OpType::NotEquals:
-                return tag.value != condition.value;
-        }
-        return false;
+inline bool match_filter(const std::vector<Tag>& tags, const Filter& filter)
+{
+    for (const auto& condition : filter.conditions) {
+        if (!match_tags(tags.cbegin(), tags.cend(), condition))
+            return false;
     }
+    return true;
+}
 
-    // tries to find tag which satisfy condition using binary search.
-    bool match_tags(TagIterator begin, TagIterator end, const ConditionType& condition)
-    {
-        while (begin < end) {
-            const TagIterator middle = begin + (std::distance(begin, end) / 2);
-            if (middle->key == condition.key)
-                return match_tag(*middle, condition);
-            else if (middle->key > condition.key)
-                end = middle;
-            else
-                begin = middle + 1;
+// Merges declarations of all matched filters in their declaration order.
+std::shared_ptr<const MatchResult> match(const std::vector<Tag>& tags, const FilterIndex& filters)
+{
+    std::vector<std::uint32_t> candidates;
+    filters.findCandidates(tags, candidates, true);
+
+    auto result = std::make_shared<MatchResult>();
+    auto declarations = std::make_shared<Style::Declarations>();
+    for (std::uint32_t index : candidates) {
+        const Filter& filter = filters.get(index);
+        if (match_filter(tags, filter)) {
+            result->isMatched = true;
+            declarations->insert(declarations->end(), filter.declarations.begin(), filter.declarations.end());
         }
-        return false;
     }
+    Style::normalize(*declarations);
+    result->declarations = declarations;
+    return result;
+}
 
-    // Builds style object. More expensive to call than check.
-    void build(const std::vector<Tag>& tags, const FilterMap& filters)
-    {
-        FilterMap::const_iterator iter = filters.find(levelOfDetails_);
-        if (iter != filters.end()) {
-            for (const Filter& filter : iter->second) {
-                bool isMatched = true;
-                for (auto it = filter.conditions.cbegin(); it != filter.conditions.cend() && isMatched; ++it) {
-                    isMatched &= match_tags(tags.cbegin(), tags.cend(), *it);
-                }
-                // merge declarations to style
-                if (isMatched) {
-                    canBuild_ = true;
-                    for (const auto& d : filter.declarations) {
-                        style_.put(d.second);
-                    }
-                }
-            }
+// Matches tags against filters of all level of details and groups level of
+// details by the set of matched filters.
+std::shared_ptr<const LodMatchResult> match_lods(const std::vector<Tag>& tags, const FilterIndex& filters)
+{
+    std::vector<std::uint32_t> candidates;
+    filters.findCandidates(tags, candidates, true);
+
+    std::vector<const Filter*> matched;
+    std::uint32_t lodMask = 0;
+    for (std::uint32_t index : candidates) {
+        const Filter& filter = filters.get(index);
+        if (match_filter(tags, filter)) {
+            matched.push_back(&filter);
+            lodMask |= filter.lodMask;
         }
     }
 
-    // Just checks whether style can be created without constructing actual style.
-    void check(const std::vector<Tag>& tags, const FilterMap& filters)
-    {
-        FilterMap::const_iterator iter = filters.find(levelOfDetails_);
-        if (iter != filters.end()) {
-            for (const Filter& filter : iter->second) {
-                bool isMatched = true;
-                for (auto it = filter.conditions.cbegin(); it != filter.conditions.cend() && isMatched; ++it) {
-                    isMatched &= match_tags(tags.cbegin(), tags.cend(), *it);
-                }
-                if (isMatched) {
-                    canBuild_ = true;
-                    return;
-                }
-            }
+    auto result = std::make_shared<LodMatchResult>();
+    std::vector<std::vector<const Filter*>> groupFilters;
+    for (int lod = 0; lod < 32 && (lodMask >> lod) != 0; ++lod) {
+        std::uint32_t lodBit = 1u << lod;
+        if ((lodMask & lodBit) == 0)
+            continue;
+
+        std::vector<const Filter*> lodFilters;
+        for (const Filter* filter : matched) {
+            if (filter->lodMask & lodBit)
+                lodFilters.push_back(filter);
         }
+
+        auto group = std::find(groupFilters.begin(), groupFilters.end(), lodFilters);
+        if (group != groupFilters.end()) {
+            result->groups[std::distance(groupFilters.begin(), group)].lodMask |= lodBit;
+            continue;
+        }
+
+        auto declarations = std::make_shared<Style::Declarations>();
+        for (const Filter* filter : lodFilters)
+            declarations->insert(declarations->end(), filter->declarations.begin(), filter->declarations.end());
+        Style::normalize(*declarations);
+
+        result->groups.push_back(LodMatchResult::Group{ lodBit, declarations });
+        groupFilters.push_back(std::move(lodFilters));
     }
+    return result;
+}
 
-    const FilterCollection &filters_;
-    int levelOfDetails_;
-    bool onlyCheck_;
-    bool canBuild_;
-    Style style_;
-};
+// Converts zoom range to level of details mask.
+inline std::uint32_t toLodMask(const Zoom& zoom)
+{
+    std::uint32_t mask = 0;
+    for (int i = zoom.start; i <= zoom.end && i < 32; ++i)
+        mask |= 1u << i;
+    return mask;
+}
 
 }
 
@@ -168,12 +340,25 @@ public:
 
     FilterCollection filters;
     StringTable& stringTable;
-    std::unordered_map<std::string, std::shared_ptr<const ColorGradient>> gradients;
-
-    StyleProviderImpl(const StyleSheet& stylesheet, StringTable& stringTable) :
+    std::vector<SelectorInfo> selectors;
+    StyleCache<MatchResult> cache;
+    StyleCache<LodMatchResult> lodCache;
+    const std::shared_ptr<const MatchResult> noMatch;
+    const StyleKeys keys;
+    std::vector<std::string> builderNames;
+
+    StyleProviderImpl(const StyleSheet& stylesheet, StringTable& stringTable, const Gradients& gradients) :
         stringTable(stringTable),
         filters(),
-        gradients()
+        selectors(),
+        cache(),
+        lodCache(),
+        noMatch(std::make_shared<MatchResult>()),
+        keys(stylesheet, stringTable),
+        builderNames(),
+        stylesheetGradients(),
+        runtimeGradients(),
+        gradientLock()
     {
         filters.nodes.reserve(24);
         filters.ways.reserve(24);
@@ -182,17 +367,31 @@ public:
         filters.canvases.reserve(24);
 
         for (const Rule& rule : stylesheet.rules) {
+            std::vector<std::string> tagKeys;
+            Style::Declarations declarations;
+            declarations.reserve(rule.declarations.size());
+            for (const Declaration& declaration : rule.declarations) {
+                addTagKeys(declaration.value, tagKeys);
+                declarations.push_back(createDeclaration(declaration, gradients));
+            }
+            Style::normalize(declarations);
+
             for (const Selector& selector : rule.selectors) {
                 for (const std::string& name : selector.names) {
                     FilterMap* filtersPtr = nullptr;
-                    if (name == "node") filtersPtr = &filters.nodes;
-                    else if (name == "way") filtersPtr = &filters.ways;
-                    else if (name == "area") filtersPtr = &filters.areas;
-                    else if (name == "relation") filtersPtr = &filters.relations;
+                    FilterIndex* lodFiltersPtr = nullptr;
+                    ImportFilter::ElementType type = ImportFilter::Node;
+                    if (name == "node") { filtersPtr = &filters.nodes; lodFiltersPtr = &filters.lodNodes; type = ImportFilter::Node; }
+                    else if (name == "way") { filtersPtr = &filters.ways; lodFiltersPtr = &filters.lodWays; type = ImportFilter::Way; }
+                    else if (name == "area") { filtersPtr = &filters.areas; lodFiltersPtr = &filters.lodAreas; type = ImportFilter::Area; }
+                    else if (name == "relation") { filtersPtr = &filters.relations; lodFiltersPtr = &filters.lodRelations; type = ImportFilter::Relation; }
                     else if (name == "canvas") filtersPtr = &filters.canvases;
                     else
                         throw std::domain_error("Unexpected selector name:" + name);
 
+                    if (filtersPtr != &filters.canvases)
+                        selectors.push_back(SelectorInfo{ type, selector.zoom, selector.conditions, tagKeys });
+
                     Filter filter = Filter();
                     filter.conditions.reserve(selector.conditions.size());
                     for (const Condition& condition : selector.conditions) {
@@ -208,52 +407,163 @@ public:
                         filter.conditions.push_back(c);
                     }
 
-                    filter.declarations.reserve(rule.declarations.size());
-                    for (auto i = 0; i < rule.declarations.size(); ++i) {
-                        Declaration declaration = rule.declarations[i];
-                        uint32_t key = stringTable.getId(declaration.key);
-
-                        if (utymap::utils::GradientUtils::isGradient(declaration.value))
-                            addGradient(declaration.value);
-
-                        filter.declarations[key] = Style::value_type(new StyleDeclaration(key, declaration.value));
-                    }
+                    filter.declarations = declarations;
 
                     std::sort(filter.conditions.begin(), filter.conditions.end(),
                         [](const ConditionType& c1, const ConditionType& c2) { return c1.key > c2.key; });
                     for (int i = selector.zoom.start; i <= selector.zoom.end; ++i) {
-                        (*filtersPtr)[i].push_back(filter);
+                        (*filtersPtr)[i].add(filter);
+                    }
+
+                    if (lodFiltersPtr != nullptr) {
+                        filter.lodMask = toLodMask(selector.zoom);
+                        lodFiltersPtr->add(filter);
                     }
                 }
             }
         }
     }
 
-    inline void addGradient(const std::string& key)
+    // Returns result of matching element at given level of details using cache.
+    std::shared_ptr<const MatchResult> match(const Element& element, int levelOfDetails)
     {
-        if (gradients.find(key) == gradients.end()) {
-            auto gradient = utymap::utils::GradientUtils::parseGradient(key);
-            if (!gradient->empty())
-                gradients[key] = gradient;
+        FilterSelector selector(filters);
+        element.accept(selector);
+        if (selector.filterMap == nullptr)
+            return noMatch;
+
+        auto filterPair = selector.filterMap->find(levelOfDetails);
+        if (filterPair == selector.filterMap->end())
+            return noMatch;
+
+        auto result = cache.get(selector.type, levelOfDetails, element.tags);
+        if (result != nullptr)
+            return result;
+
+        return cache.put(selector.type, levelOfDetails, element.tags, ::match(element.tags, filterPair->second));
+    }
+
+    // Returns result of matching element at all level of details using cache.
+    std::shared_ptr<const LodMatchResult> matchLods(const Element& element)
+    {
+        FilterSelector selector(filters);
+        element.accept(selector);
+        if (selector.lodFilters == nullptr)
+            return std::make_shared<LodMatchResult>();
+
+        // NOTE result does not depend on level of details, so it is cached with invalid one.
+        auto result = lodCache.get(selector.type, -1, element.tags);
+        if (result != nullptr)
+            return result;
+
+        return lodCache.put(selector.type, -1, element.tags, match_lods(element.tags, *selector.lodFilters));
+    }
+
+    ImportFilter getImportFilter(const LodRange& range) const
+    {
+        ImportFilter filter;
+        for (const SelectorInfo& selector : selectors) {
+            if (selector.zoom.end < range.start || selector.zoom.start > range.end)
+                continue;
+
+            filter.addSelector(selector.type, selector.conditions);
+            for (const std::string& key : selector.tagKeys)
+                filter.addKey(key);
+        }
+        return filter;
+    }
+
+    // Creates declaration with parsed value shared by all filters of the rule.
+    Style::value_type createDeclaration(const Declaration& declaration, const Gradients& gradients)
+    {
+        uint32_t key = stringTable.getId(declaration.key);
+        std::shared_ptr<const ColorGradient> gradient = nullptr;
+        if (utymap::utils::GradientUtils::isGradient(declaration.value))
+            gradient = addGradient(declaration.value, gradients);
+
+        auto styleDeclaration = std::make_shared<StyleDeclaration>(key, declaration.value, gradient);
+        styleDeclaration->compile(stringTable);
+        if (key == keys.builders && !styleDeclaration->isEval())
+            styleDeclaration->setBuilders(getBuilderIndices(declaration.value));
+        return styleDeclaration;
+    }
+
+    // Resolves comma separated builder names into indices in builder names.
+    std::vector<std::uint16_t> getBuilderIndices(const std::string& names)
+    {
+        std::vector<std::uint16_t> indices;
+        std::stringstream ss(names);
+        while (ss.good()) {
+            std::string name;
+            getline(ss, name, ',');
+            auto it = std::find(builderNames.begin(), builderNames.end(), name);
+            if (it == builderNames.end())
+                it = builderNames.insert(builderNames.end(), name);
+            indices.push_back(static_cast<std::uint16_t>(it - builderNames.begin()));
         }
+        return indices;
     }
 
-    inline std::shared_ptr<const ColorGradient> getGradient(const std::string& key)
+    // Adds gradient defined in stylesheet. Called only from constructor.
+    std::shared_ptr<const ColorGradient> addGradient(const std::string& key, const Gradients& gradients)
     {
-        auto gradientPair = gradients.find(key);
-        if (gradientPair == gradients.end()) {
-            auto gradient = utymap::utils::GradientUtils::parseGradient(key);
-            if (gradient->empty())
-                throw MapCssException("Invalid gradient: " + key);
-            // TODO store it in map in thread safe way
-            return gradient;
+        auto gradientPair = stylesheetGradients.find(key);
+        if (gradientPair != stylesheetGradients.end())
+            return gradientPair->second;
+
+        auto previousPair = gradients.find(key);
+        auto gradient = previousPair != gradients.end()
+            ? previousPair->second
+            : utymap::utils::GradientUtils::parseGradient(key);
+        if (gradient->empty())
+            return nullptr;
+
+        stylesheetGradients[key] = gradient;
+        return gradient;
+    }
+
+    std::shared_ptr<const ColorGradient> getGradient(const std::string& key)
+    {
+        // NOTE stylesheet gradients are not modified after construction, so no lock is needed.
+        auto gradientPair = stylesheetGradients.find(key);
+        if (gradientPair != stylesheetGradients.end())
+            return gradientPair->second;
+
+        {
+            std::lock_guard<std::mutex> lock(gradientLock);
+            gradientPair = runtimeGradients.find(key);
+            if (gradientPair != runtimeGradients.end())
+                return gradientPair->second;
         }
-        return gradientPair->second;
+
+        auto gradient = utymap::utils::GradientUtils::parseGradient(key);
+        if (gradient->empty())
+            throw MapCssException("Invalid gradient: " + key);
+
+        std::lock_guard<std::mutex> lock(gradientLock);
+        if (runtimeGradients.size() >= MaxRuntimeGradients)
+            runtimeGradients.clear();
+        return runtimeGradients.insert(std::make_pair(key, gradient)).first->second;
     }
+
+    Gradients getGradients() const
+    {
+        Gradients gradients = stylesheetGradients;
+        std::lock_guard<std::mutex> lock(gradientLock);
+        gradients.insert(runtimeGradients.begin(), runtimeGradients.end());
+        return gradients;
+    }
+
+private:
+    // Gradients used by stylesheet declarations.
+    Gradients stylesheetGradients;
+    // Bounded cache of gradients requested by key which is not in stylesheet.
+    Gradients runtimeGradients;
+    mutable std::mutex gradientLock;
 };
 
-StyleProvider::StyleProvider(const StyleSheet& stylesheet, StringTable& stringTable) :
-    pimpl_(new StyleProvider::StyleProviderImpl(stylesheet, stringTable))
+StyleProvider::StyleProvider(const StyleSheet& stylesheet, StringTable& stringTable, const Gradients& gradients) :
+    pimpl_(new StyleProvider::StyleProviderImpl(stylesheet, stringTable, gradients))
 {
 }
 
@@ -263,30 +573,61 @@ StyleProvider::~StyleProvider()
 
 bool StyleProvider::hasStyle(const utymap::entities::Element& element, int levelOfDetails) const
 {
-    StyleBuilder builder(element.tags, pimpl_->stringTable, pimpl_->filters, levelOfDetails, true);
-    element.accept(builder);
-    return builder.canBuild();
+    return pimpl_->match(element, levelOfDetails)->isMatched;
 }
 
 Style StyleProvider::forElement(const Element& element, int levelOfDetails) const
 {
-    StyleBuilder builder(element.tags, pimpl_->stringTable, pimpl_->filters, levelOfDetails);
-    element.accept(builder);
-    return std::move(builder.build());
+    return Style(element.tags, pimpl_->stringTable, pimpl_->match(element, levelOfDetails)->declarations);
 }
 
 Style StyleProvider::forCanvas(int levelOfDetails) const
 {
-    Style style({}, pimpl_->stringTable);
-    for (const auto &filter : pimpl_->filters.canvases[levelOfDetails]) {
-        for (const auto &declaration : filter.declarations) {
-            style.put(declaration.second);
-        }
+    static const std::vector<Tag> noTags;
+    auto declarations = std::make_shared<Style::Declarations>();
+    // NOTE called concurrently, so map should not be modified here.
+    auto canvas = pimpl_->filters.canvases.find(levelOfDetails);
+    if (canvas == pimpl_->filters.canvases.end())
+        return Style(noTags, pimpl_->stringTable);
+
+    for (const auto &filter : canvas->second.filters()) {
+        declarations->insert(declarations->end(), filter.declarations.begin(), filter.declarations.end());
     }
-    return std::move(style);
+    Style::normalize(*declarations);
+    return Style(noTags, pimpl_->stringTable, declarations);
+}
+
+std::vector<StyleProvider::LodStyle> StyleProvider::forLevelsOfDetails(const Element& element) const
+{
+    auto result = pimpl_->matchLods(element);
+    std::vector<LodStyle> styles;
+    styles.reserve(result->groups.size());
+    for (const auto& group : result->groups)
+        styles.push_back(LodStyle{ group.lodMask, Style(element.tags, pimpl_->stringTable, group.declarations) });
+    return styles;
+}
+
+ImportFilter StyleProvider::getImportFilter(const utymap::LodRange& range) const
+{
+    return pimpl_->getImportFilter(range);
 }
 
 std::shared_ptr<const ColorGradient> StyleProvider::getGradient(const std::string& key) const
 {
     return pimpl_->getGradient(key);
 }
+
+StyleProvider::Gradients StyleProvider::getGradients() const
+{
+    return pimpl_->getGradients();
+}
+
+const StyleKeys& StyleProvider::getKeys() const
+{
+    return pimpl_->keys;
+}
+
+const std::vector<std::string>& StyleProvider::getBuilderNames() const
+{
+    return pimpl_->builderNames;
+}
@@ -1,14 +1,20 @@
 #ifndef INDEX_STYLEPROVIDER_HPP_DEFINED
 #define INDEX_STYLEPROVIDER_HPP_DEFINED
 
+#include "LodRange.hpp"
 #include "index/StringTable.hpp"
 #include "entities/Element.hpp"
 #include "mapcss/ColorGradient.hpp"
+#include "mapcss/ImportFilter.hpp"
+#include "mapcss/StyleKeys.hpp"
 #include "mapcss/StyleSheet.hpp"
 #include "mapcss/Style.hpp"
 
+#include <cstdint>
 #include <string>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 namespace utymap { namespace mapcss {
 
@@ -16,8 +22,20 @@ namespace utymap { namespace mapcss {
 class StyleProvider
 {
 public:
+    // Style of element shared by all level of details from the mask.
+    struct LodStyle
+    {
+        std::uint32_t lodMask;
+        utymap::mapcss::Style style;
+    };
 
-    StyleProvider(const utymap::mapcss::StyleSheet&, utymap::index::StringTable&);
+    // Color gradients by their raw values.
+    typedef std::unordered_map<std::string, std::shared_ptr<const ColorGradient>> Gradients;
+
+    // Creates provider for stylesheet. Gradients parsed earlier are reused.
+    StyleProvider(const utymap::mapcss::StyleSheet&,
+                  utymap::index::StringTable&,
+                  const Gradients& gradients = Gradients());
 
     ~StyleProvider();
 
@@ -27,12 +45,30 @@ public:
     // Returs style for given element at given level of details.
     utymap::mapcss::Style forElement(const utymap::entities::Element&, int levelOfDetails) const;
 
+    // Returns styles for element at all level of details where it has style. Level of
+    // details matched by the same rules share one style. Matched in single pass.
+    std::vector<LodStyle> forLevelsOfDetails(const utymap::entities::Element&) const;
+
     // Returs style for canvas at given level of details.
     utymap::mapcss::Style forCanvas(int levelOfDetails) const;
 
+    // Returns filter which describes elements and tags used by stylesheet
+    // in given level of details range.
+    utymap::mapcss::ImportFilter getImportFilter(const utymap::LodRange& range) const;
+
     // Returns color gradient for given key.
     std::shared_ptr<const ColorGradient> getGradient(const std::string& key) const;
 
+    // Returns snapshot of color gradients known by provider.
+    Gradients getGradients() const;
+
+    // Returns well known style keys resolved for this style provider.
+    const utymap::mapcss::StyleKeys& getKeys() const;
+
+    // Returns names of builders listed by stylesheet. Builders of declarations
+    // are resolved to indices in this list on stylesheet load.
+    const std::vector<std::string>& getBuilderNames() const;
+
 private:
     class StyleProviderImpl;
     std::unique_ptr<StyleProviderImpl> pimpl_;
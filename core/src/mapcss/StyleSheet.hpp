@@ -48,6 +48,8 @@ struct Rule
 struct StyleSheet
 {
     std::vector<Rule> rules;
+    // Paths of imported files.
+    std::vector<std::string> imports;
 };
 
 std::ostream& operator<<(std::ostream &stream, const Condition &c);
@@ -0,0 +1,81 @@
+#include "mapcss/StyleSheetDiff.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace utymap::mapcss;
+
+namespace {
+    // Selector with declarations of its rule.
+    struct Entry
+    {
+        Zoom zoom;
+        std::string selector;
+        std::string content;
+    };
+
+    std::vector<Entry> getEntries(const StyleSheet& stylesheet)
+    {
+        std::vector<Entry> entries;
+        for (const Rule& rule : stylesheet.rules) {
+            std::stringstream declarations;
+            for (const Declaration& declaration : rule.declarations)
+                declarations << declaration << ";";
+
+            for (const Selector& selector : rule.selectors) {
+                std::stringstream ss;
+                ss << selector;
+                entries.push_back(Entry{ selector.zoom, ss.str(), ss.str() + "{" + declarations.str() + "}" });
+            }
+        }
+        return entries;
+    }
+
+    void addChanges(std::vector<Entry>::const_iterator begin,
+                    std::vector<Entry>::const_iterator end,
+                    StyleSheetDiff& diff)
+    {
+        for (auto it = begin; it != end; ++it) {
+            for (int lod = it->zoom.start; lod <= it->zoom.end && lod < 32; ++lod)
+                diff.lodMask |= 1u << lod;
+            if (std::find(diff.selectors.begin(), diff.selectors.end(), it->selector) == diff.selectors.end())
+                diff.selectors.push_back(it->selector);
+        }
+    }
+}
+
+std::vector<std::uint64_t> StyleSheetDiff::getLodHashes(const StyleSheet& stylesheet)
+{
+    // NOTE FNV-1a over content of rules in their order.
+    std::vector<std::uint64_t> hashes(32, 14695981039346656037ULL);
+    for (const Entry& entry : getEntries(stylesheet)) {
+        for (int lod = entry.zoom.start; lod <= entry.zoom.end && lod < 32; ++lod) {
+            for (char c : entry.content) {
+                hashes[lod] ^= static_cast<unsigned char>(c);
+                hashes[lod] *= 1099511628211ULL;
+            }
+        }
+    }
+    return hashes;
+}
+
+StyleSheetDiff StyleSheetDiff::create(const StyleSheet& oldStylesheet, const StyleSheet& newStylesheet)
+{
+    std::vector<Entry> oldEntries = getEntries(oldStylesheet);
+    std::vector<Entry> newEntries = getEntries(newStylesheet);
+
+    std::size_t head = 0;
+    while (head < oldEntries.size() && head < newEntries.size() &&
+           oldEntries[head].content == newEntries[head].content)
+        ++head;
+
+    std::size_t tail = 0;
+    while (tail < oldEntries.size() - head && tail < newEntries.size() - head &&
+           oldEntries[oldEntries.size() - tail - 1].content == newEntries[newEntries.size() - tail - 1].content)
+        ++tail;
+
+    StyleSheetDiff diff;
+    addChanges(oldEntries.begin() + head, oldEntries.end() - tail, diff);
+    addChanges(newEntries.begin() + head, newEntries.end() - tail, diff);
+    return diff;
+}
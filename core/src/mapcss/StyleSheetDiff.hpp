@@ -0,0 +1,38 @@
+#ifndef MAPCSS_STYLESHEETDIFF_HPP_DEFINED
+#define MAPCSS_STYLESHEETDIFF_HPP_DEFINED
+
+#include "mapcss/StyleSheet.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace utymap { namespace mapcss {
+
+// Describes difference between two versions of the same stylesheet.
+struct StyleSheetDiff
+{
+    // Bit per level of details affected by changed rules.
+    std::uint32_t lodMask;
+    // Changed selectors of both versions in mapcss notation.
+    std::vector<std::string> selectors;
+
+    StyleSheetDiff() : lodMask(0), selectors()
+    {
+    }
+
+    // Returns true if stylesheets define the same rules.
+    bool empty() const { return selectors.empty(); }
+
+    // Compares rules of stylesheets selector by selector. As later rules override
+    // earlier ones, everything between common head and common tail is changed.
+    static StyleSheetDiff create(const utymap::mapcss::StyleSheet& oldStylesheet,
+                                 const utymap::mapcss::StyleSheet& newStylesheet);
+
+    // Returns hash of rules for every level of details from 0 to 31. Hash of level
+    // is changed when diff of stylesheet versions includes this level.
+    static std::vector<std::uint64_t> getLodHashes(const utymap::mapcss::StyleSheet& stylesheet);
+};
+
+}}
+#endif // MAPCSS_STYLESHEETDIFF_HPP_DEFINED
@@ -13,11 +13,14 @@ class MeshBuilder::MeshBuilderImpl
 {
 public:
 
-    MeshBuilderImpl(const ElevationProvider& eleProvider)
-    : eleProvider_(eleProvider) { }
+    MeshBuilderImpl(const ElevationProvider& eleProvider, const CancellationToken& cancelToken)
+    : eleProvider_(eleProvider), cancelToken_(cancelToken) { }
      
     void addPolygon(Mesh& mesh, Polygon& polygon, const MeshBuilder::Options& options) const
     {
+        if (cancelToken_.isCancelled())
+            return;
+
         triangulateio in, mid;
 
         in.numberofpoints = static_cast<int>(polygon.points.size() / 2);
@@ -181,10 +184,11 @@ private:
     }
 
     const ElevationProvider& eleProvider_;
+    const CancellationToken& cancelToken_;
 };
 
-MeshBuilder::MeshBuilder(const ElevationProvider& eleProvider) :
-    pimpl_(new MeshBuilder::MeshBuilderImpl(eleProvider))
+MeshBuilder::MeshBuilder(const ElevationProvider& eleProvider, const CancellationToken& cancelToken) :
+    pimpl_(new MeshBuilder::MeshBuilderImpl(eleProvider, cancelToken))
 {
 }
 
@@ -6,6 +6,7 @@
 #include "mapcss/ColorGradient.hpp"
 #include "meshing/MeshTypes.hpp"
 #include "meshing/Polygon.hpp"
+#include "utils/CancellationToken.hpp"
 
 #include <limits>
 #include <memory>
@@ -55,8 +56,10 @@ public:
         }
     };
 
-    // Creates builder with given elevation provider.
-    MeshBuilder(const utymap::heightmap::ElevationProvider& eleProvider);
+    // Creates builder with given elevation provider. Polygons are not
+    // triangulated once cancellation token is cancelled.
+    MeshBuilder(const utymap::heightmap::ElevationProvider& eleProvider,
+                const utymap::utils::CancellationToken& cancelToken = utymap::utils::CancellationToken::none());
     ~MeshBuilder();
 
     // Adds polygon to existing mesh using options provided.
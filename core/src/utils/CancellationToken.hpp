@@ -0,0 +1,37 @@
+#ifndef UTILS_CANCELLATIONTOKEN_HPP_DEFINED
+#define UTILS_CANCELLATIONTOKEN_HPP_DEFINED
+
+#include <atomic>
+
+namespace utymap { namespace utils {
+
+// Allows to stop long running operation from another thread. Operation checks
+// token at element or polygon granularity and returns early without result.
+class CancellationToken
+{
+public:
+    CancellationToken() : isCancelled_(false)
+    {
+    }
+
+    // Returns token which is never cancelled.
+    static const CancellationToken& none()
+    {
+        static const CancellationToken token;
+        return token;
+    }
+
+    void cancel() { isCancelled_ = true; }
+
+    bool isCancelled() const { return isCancelled_; }
+
+private:
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    std::atomic<bool> isCancelled_;
+};
+
+}}
+
+#endif // UTILS_CANCELLATIONTOKEN_HPP_DEFINED
@@ -2,9 +2,13 @@
 #define UTILS_COREUTILS_HPP_DEFINED
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <sstream>
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #include <boost/lexical_cast.hpp>
 
 namespace utymap { namespace utils {
@@ -34,6 +38,27 @@ inline double parseDouble(const std::string& value, double defaultValue = 0)
     }
 }
 
+// Parses double from given amount of chars without creating temporary string.
+inline double parseDouble(const char* chars, std::size_t count, double defaultValue = 0)
+{
+    double value;
+    return boost::conversion::try_lexical_convert(chars, count, value) ? value : defaultValue;
+}
+
+// Returns size of file in bytes or zero if file does not exist.
+inline std::uint64_t getFileSize(const std::string& path)
+{
+    struct stat fileStat;
+    return ::stat(path.c_str(), &fileStat) == 0 ? static_cast<std::uint64_t>(fileStat.st_size) : 0;
+}
+
+// Returns last modification time of file in seconds since epoch or zero if file does not exist.
+inline std::int64_t getFileModificationTime(const std::string& path)
+{
+    struct stat fileStat;
+    return ::stat(path.c_str(), &fileStat) == 0 ? static_cast<std::int64_t>(fileStat.st_mtime) : 0;
+}
+
 template<typename TimeT = std::chrono::milliseconds>
 struct measure
 {
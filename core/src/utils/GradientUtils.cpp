@@ -294,11 +294,14 @@ Color GradientUtils::parseColor(const std::string& colorStr)
 std::shared_ptr<const ColorGradient> GradientUtils::evaluateGradient(const StyleProvider& styleProvider,
                                                                      const Style &style,
                                                                      const std::vector<utymap::entities::Tag>& tags,
-                                                                     const std::string &key)
+                                                                     std::uint32_t key)
 {
+    auto gradient = style.getGradient(key);
+    if (gradient != nullptr)
+        return gradient;
+
     // TODO evaluate gradient using tags
-    auto gradient = style.getString(key);
-    return styleProvider.getGradient(*gradient);
+    return styleProvider.getGradient(style.getString(key));
 }
 
 
@@ -33,7 +33,7 @@ public:
     static std::shared_ptr<const utymap::mapcss::ColorGradient> evaluateGradient(const utymap::mapcss::StyleProvider& styleProvider,
                                                                                  const utymap::mapcss::Style& style,
                                                                                  const std::vector<utymap::entities::Tag>& tags,
-                                                                                 const std::string& key);
+                                                                                 std::uint32_t key);
 
     // Gets color for specific coordinate using coherent noise function
     static inline utymap::mapcss::Color getColor(const utymap::mapcss::ColorGradient& gradient,
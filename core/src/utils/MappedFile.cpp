@@ -0,0 +1,120 @@
+#include "utils/MappedFile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace utymap::utils;
+
+class MappedFile::MappedFileImpl
+{
+public:
+
+    MappedFileImpl(const std::string& path) : data(nullptr), size(0)
+    {
+#ifdef _WIN32
+        file_ = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file_ == INVALID_HANDLE_VALUE)
+            throw std::domain_error("Cannot open file: " + path);
+
+        LARGE_INTEGER fileSize;
+        if (!::GetFileSizeEx(file_, &fileSize)) {
+            ::CloseHandle(file_);
+            throw std::domain_error("Cannot get file size: " + path);
+        }
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+        if (size == 0) {
+            mapping_ = NULL;
+            return;
+        }
+
+        mapping_ = ::CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping_ != NULL)
+            data = static_cast<const char*>(::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+
+        if (data == nullptr) {
+            if (mapping_ != NULL) ::CloseHandle(mapping_);
+            ::CloseHandle(file_);
+            throw std::domain_error("Cannot map file: " + path);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd == -1)
+            throw std::domain_error("Cannot open file: " + path);
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) == -1) {
+            ::close(fd);
+            throw std::domain_error("Cannot get file size: " + path);
+        }
+        size = static_cast<std::size_t>(fileStat.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return;
+        }
+
+        void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        // NOTE mapping stays valid after descriptor is closed.
+        ::close(fd);
+        if (address == MAP_FAILED)
+            throw std::domain_error("Cannot map file: " + path);
+
+        ::madvise(address, size, MADV_WILLNEED);
+        data = static_cast<const char*>(address);
+#endif
+    }
+
+    ~MappedFileImpl()
+    {
+#ifdef _WIN32
+        if (data != nullptr) ::UnmapViewOfFile(data);
+        if (mapping_ != NULL) ::CloseHandle(mapping_);
+        ::CloseHandle(file_);
+#else
+        if (data != nullptr) ::munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    const char* data;
+    std::size_t size;
+
+private:
+#ifdef _WIN32
+    HANDLE file_;
+    HANDLE mapping_;
+#endif
+};
+
+MappedFile::MappedFile(const std::string& path) :
+    pimpl_(new MappedFileImpl(path))
+{
+}
+
+MappedFile::~MappedFile()
+{
+}
+
+bool MappedFile::exists(const std::string& path)
+{
+    return std::ifstream(path.c_str(), std::ios::binary).good();
+}
+
+const char* MappedFile::data() const
+{
+    return pimpl_->data;
+}
+
+std::size_t MappedFile::size() const
+{
+    return pimpl_->size;
+}
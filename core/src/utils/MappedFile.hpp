@@ -0,0 +1,38 @@
+#ifndef UTILS_MAPPEDFILE_HPP_DEFINED
+#define UTILS_MAPPEDFILE_HPP_DEFINED
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace utymap { namespace utils {
+
+// Provides read only access to file content mapped into memory.
+class MappedFile
+{
+public:
+    // Maps file with given path. Throws domain_error if file cannot be mapped.
+    explicit MappedFile(const std::string& path);
+
+    ~MappedFile();
+
+    // Checks whether file exists and can be opened for reading.
+    static bool exists(const std::string& path);
+
+    // Returns pointer to file content. Null for empty file.
+    const char* data() const;
+
+    // Returns file size in bytes.
+    std::size_t size() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    class MappedFileImpl;
+    std::unique_ptr<MappedFileImpl> pimpl_;
+};
+
+}}
+
+#endif // UTILS_MAPPEDFILE_HPP_DEFINED
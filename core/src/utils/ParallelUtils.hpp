@@ -0,0 +1,101 @@
+#ifndef UTILS_PARALLELUTILS_HPP_DEFINED
+#define UTILS_PARALLELUTILS_HPP_DEFINED
+
+#include "utils/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace utymap { namespace utils {
+
+namespace detail {
+    // State of parallel loop. It is shared with helper tasks as some of them
+    // may start only after the loop is completed.
+    struct ParallelForState
+    {
+        explicit ParallelForState(std::size_t count) :
+            count(count), next(0), exception(nullptr), running(0), isDone(false)
+        {
+        }
+
+        const std::size_t count;
+        std::atomic<std::size_t> next;
+        std::exception_ptr exception;
+        std::size_t running;
+        bool isDone;
+        std::mutex lock;
+        std::condition_variable idleCondition;
+    };
+}
+
+// Returns amount of threads which parallel loop can use on current thread.
+inline std::size_t getParallelism()
+{
+    return ThreadPool::isWorkerThread() ? 1 : ThreadPool::shared().size() + 1;
+}
+
+// Calls function for every index in [0, count) on current thread helped by
+// workers of shared pool. Indices are taken in increasing order, first exception
+// thrown by function is rethrown. Calls made on pool workers, including nested
+// ones, are sequential, so threads are never created per call and workers never
+// wait for each other.
+template <typename Function>
+void parallelFor(std::size_t count, const Function& function, std::size_t workerCount = getWorkerCount())
+{
+    workerCount = std::min(std::min(workerCount, count), getParallelism());
+    if (workerCount < 2) {
+        for (std::size_t i = 0; i < count; ++i)
+            function(i);
+        return;
+    }
+
+    auto state = std::make_shared<detail::ParallelForState>(count);
+    auto run = [state, &function]() {
+        for (std::size_t i = state->next++; i < state->count; i = state->next++) {
+            try {
+                function(i);
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(state->lock);
+                if (state->exception == nullptr)
+                    state->exception = std::current_exception();
+                state->next = state->count;
+            }
+        }
+    };
+
+    for (std::size_t i = 1; i < workerCount; ++i) {
+        ThreadPool::shared().enqueue([state, run]() {
+            {
+                // NOTE function is not accessed by helper which is late.
+                std::lock_guard<std::mutex> lock(state->lock);
+                if (state->isDone)
+                    return;
+                ++state->running;
+            }
+            run();
+            {
+                std::lock_guard<std::mutex> lock(state->lock);
+                --state->running;
+            }
+            state->idleCondition.notify_all();
+        });
+    }
+    run();
+
+    // NOTE waits only for helpers which are already started.
+    std::unique_lock<std::mutex> lock(state->lock);
+    state->isDone = true;
+    state->idleCondition.wait(lock, [&state]() { return state->running == 0; });
+    if (state->exception != nullptr)
+        std::rethrow_exception(state->exception);
+}
+
+}}
+
+#endif // UTILS_PARALLELUTILS_HPP_DEFINED
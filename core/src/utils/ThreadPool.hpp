@@ -0,0 +1,125 @@
+#ifndef UTILS_THREADPOOL_HPP_DEFINED
+#define UTILS_THREADPOOL_HPP_DEFINED
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace utymap { namespace utils {
+
+// Returns amount of worker threads to use.
+inline std::size_t getWorkerCount()
+{
+    std::size_t count = std::thread::hardware_concurrency();
+    return count == 0 ? 1 : count;
+}
+
+// Runs tasks on fixed amount of worker threads in order of submission.
+// Tasks are expected to handle their exceptions.
+class ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    explicit ThreadPool(std::size_t workerCount = getWorkerCount()) :
+        stopped_(false), active_(0)
+    {
+        if (workerCount == 0)
+            workerCount = 1;
+
+        workers_.reserve(workerCount);
+        for (std::size_t i = 0; i < workerCount; ++i)
+            workers_.push_back(std::thread([this]() { run(); }));
+    }
+
+    // Completes already queued tasks and stops workers.
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            stopped_ = true;
+        }
+        taskCondition_.notify_all();
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    // Adds task to the queue.
+    void enqueue(const Task& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(lock_);
+            tasks_.push_back(task);
+        }
+        taskCondition_.notify_one();
+    }
+
+    // Blocks until all queued tasks are completed.
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(lock_);
+        idleCondition_.wait(lock, [this]() { return tasks_.empty() && active_ == 0; });
+    }
+
+    std::size_t size() const { return workers_.size(); }
+
+    // Checks whether current thread is a worker of any pool.
+    static bool isWorkerThread() { return isWorker(); }
+
+    // Returns pool shared by parallel algorithms.
+    static ThreadPool& shared()
+    {
+        // NOTE pool is never destroyed: joining threads while library is unloaded may deadlock.
+        static ThreadPool* pool = new ThreadPool();
+        return *pool;
+    }
+
+private:
+
+    static bool& isWorker()
+    {
+        static thread_local bool value = false;
+        return value;
+    }
+
+    void run()
+    {
+        isWorker() = true;
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(lock_);
+                taskCondition_.wait(lock, [this]() { return stopped_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+                ++active_;
+            }
+
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(lock_);
+                --active_;
+            }
+            idleCondition_.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    std::mutex lock_;
+    std::condition_variable taskCondition_;
+    std::condition_variable idleCondition_;
+    bool stopped_;
+    std::size_t active_;
+};
+
+}}
+
+#endif // UTILS_THREADPOOL_HPP_DEFINED
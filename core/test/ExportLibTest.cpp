@@ -5,6 +5,10 @@
 
 #include "test_utils/ElementUtils.hpp"
 
+#include <atomic>
+#include <set>
+#include <thread>
+
 using namespace utymap::entities;
 using namespace utymap::utils;
 
@@ -13,13 +17,18 @@ namespace {
 
     // Use global variable as it is used inside lambda which is passed as function.
     bool isCalled;
+    std::atomic<int> meshCount;
+    std::atomic<int> completedCount;
+    std::atomic<int> errorCount;
+    std::atomic<int> vertexCount;
+    std::atomic<int> tagCount;
 
     struct ExportLibFixture {
         ExportLibFixture()
         {
             ::configure(TEST_ASSETS_PATH, TEST_ELEVATION_DIRECTORY,
                 [](const char* message) { BOOST_FAIL(message); });
-            ::registerInMemoryStore(InMemoryStoreKey);
+            ::registerInMemoryStore(InMemoryStoreKey, false);
         }
 
         void loadQuadKeys(int levelOfDetails, int startX, int endX, int startY, int endY)
@@ -120,4 +129,153 @@ BOOST_AUTO_TEST_CASE(GivenElement_WhenAddInMemory_ThenItIsAdded)
     BOOST_CHECK(::hasData(1, 0, 1));
 }
 
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenQuadKeysAreLoadedAsync_ThenCallbacksAreCalledForEveryRequest)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    ::setWorkerCount(2);
+    meshCount = 0;
+    completedCount = 0;
+    errorCount = 0;
+
+    std::vector<int> requestIds;
+    for (int i = 0; i <= 1; ++i) {
+        for (int j = 0; j <= 1; ++j) {
+            requestIds.push_back(::loadQuadKeyAsync(TEST_MAPCSS_DEFAULT, i, j, 1,
+                [](const char*, const double*, int, const int*, int, const int*, int) { ++meshCount; },
+                [](uint64_t, const char**, int, const double*, int, const char**, int) {},
+                // NOTE called on worker thread, so results are checked later.
+                [](int, const char* message) {
+                    if (message != nullptr) ++errorCount;
+                    ++completedCount;
+                }));
+        }
+    }
+    while (completedCount < 4)
+        std::this_thread::yield();
+
+    BOOST_CHECK_EQUAL(errorCount.load(), 0);
+    BOOST_CHECK_EQUAL(std::set<int>(requestIds.begin(), requestIds.end()).size(), 4);
+    BOOST_CHECK_GT(meshCount.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPrefetchEnabled_WhenItIsDisabledDuringLoading_ThenRequestsAreCompleted)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    ::setPrefetchEnabled(true);
+    completedCount = 0;
+    errorCount = 0;
+
+    for (int i = 0; i <= 1; ++i) {
+        ::loadQuadKeyAsync(TEST_MAPCSS_DEFAULT, i, 0, 1,
+            [](const char*, const double*, int, const int*, int, const int*, int) {},
+            [](uint64_t, const char**, int, const double*, int, const char**, int) {},
+            [](int, const char* message) {
+                if (message != nullptr) ++errorCount;
+                ++completedCount;
+            });
+    }
+    ::setPrefetchEnabled(false);
+    while (completedCount < 2)
+        std::this_thread::yield();
+    // NOTE waits for cancelled prefetches as well.
+    ::setWorkerCount(0);
+
+    BOOST_CHECK_EQUAL(errorCount.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenQuadKeysAreLoadedInBatch_ThenCallbacksAreCalledForEveryQuadKey)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    const int quadKeys[] = { 1, 1, 1, 0, 0, 1, 1, 0, 1, 0, 1, 1 };
+    meshCount = 0;
+    completedCount = 0;
+    errorCount = 0;
+    static std::set<int> indices;
+    indices.clear();
+
+    ::loadQuadKeys(TEST_MAPCSS_DEFAULT, quadKeys, 4,
+        [](const char*, const double*, int, const int*, int, const int*, int) { ++meshCount; },
+        [](uint64_t, const char**, int, const double*, int, const char**, int) {},
+        // NOTE callbacks are never concurrent, so set is safe to modify.
+        [](int index, const char* message) {
+            if (message != nullptr) ++errorCount;
+            indices.insert(index);
+            ++completedCount;
+        });
+
+    BOOST_CHECK_EQUAL(errorCount.load(), 0);
+    BOOST_CHECK_EQUAL(completedCount.load(), 4);
+    BOOST_CHECK_EQUAL(indices.size(), 4);
+    BOOST_CHECK_GT(meshCount.load(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestData_WhenHasDataBatch_ThenReturnsResultForEveryQuadKey)
+{
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    const int quadKeys[] = { 1, 0, 1, 0, 0, 1, 3, 3, 5 };
+    bool results[] = { false, false, true };
+
+    ::hasDataBatch(quadKeys, 3, results);
+
+    BOOST_CHECK(results[0]);
+    BOOST_CHECK(results[1]);
+    BOOST_CHECK(!results[2]);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFilteredStore_WhenDataIsImported_ThenLessTagsAreLoaded)
+{
+    auto load = []() {
+        tagCount = 0;
+        ::loadQuadKey(TEST_MAPCSS_DEFAULT, 35205, 21489, 16,
+            [](const char*, const double*, int, const int*, int, const int*, int) {},
+            [](uint64_t, const char**, int size, const double*, int, const char**, int) { tagCount += size; },
+            [](const char* message) { BOOST_FAIL(message); });
+        return tagCount.load();
+    };
+    ::addToStoreInQuadKey(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_XML_FILE, 35205, 21489, 16, callback);
+    int original = load();
+    // NOTE replace store with empty one, so only filtered store has data.
+    ::registerInMemoryStore(InMemoryStoreKey, false);
+    ::registerInMemoryStore("Filtered", true);
+
+    ::addToStoreInQuadKey("Filtered", TEST_MAPCSS_DEFAULT, TEST_XML_FILE, 35205, 21489, 16, callback);
+
+    BOOST_CHECK_GT(load(), 0);
+    BOOST_CHECK_LT(load(), original);
+}
+
+BOOST_AUTO_TEST_CASE(GivenCacheDirectory_WhenStylesheetIsRegistered_ThenCompiledStylesheetIsWrittenToCacheDirectory)
+{
+    const std::string binaryPath = std::string(TEST_ASSETS_PATH) +
+        std::to_string(std::hash<std::string>()(TEST_MAPCSS_DEFAULT)) + ".mapcss.bin";
+    ::configureMeshCache(TEST_ASSETS_PATH, 0);
+
+    ::registerStylesheet(TEST_MAPCSS_DEFAULT);
+
+    BOOST_CHECK(std::ifstream(binaryPath).good());
+    BOOST_CHECK(!std::ifstream(std::string(TEST_MAPCSS_DEFAULT) + ".mapcss.bin").good());
+    std::remove(binaryPath.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(GivenLoadedQuadKey_WhenDataIsChanged_ThenQuadKeyIsNotTakenFromCache)
+{
+    const std::vector<double> vertices = { 5, 5, 20, 5, 20, 10, 5, 10, 5, 5 };
+    const std::vector<const char*> tags = { "featurecla", "Lake", "scalerank", "0" };
+    auto load = []() {
+        vertexCount = 0;
+        ::loadQuadKey(TEST_MAPCSS_DEFAULT, 1, 0, 1,
+            [](const char*, const double*, int count, const int*, int, const int*, int) { vertexCount += count; },
+            [](uint64_t, const char**, int, const double*, int, const char**, int) {},
+            [](const char* message) { BOOST_FAIL(message); });
+        return vertexCount.load();
+    };
+    ::addToStoreInRange(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, TEST_SHAPE_NE_110M_LAND, 1, 1, callback);
+    int original = load();
+
+    ::addToStoreElement(InMemoryStoreKey, TEST_MAPCSS_DEFAULT, 1, vertices.data(), 10,
+        const_cast<const char**>(tags.data()), 4, 1, 1, callback);
+
+    BOOST_CHECK_NE(load(), original);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
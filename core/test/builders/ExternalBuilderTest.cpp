@@ -0,0 +1,54 @@
+#include "builders/ExternalBuilder.hpp"
+#include "entities/Way.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::entities;
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string stylesheet = "way|z16[highway] { width: 2m; }";
+
+    struct Builders_ExternalBuilderFixture
+    {
+        DependencyProvider dependencyProvider;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_ExternalBuilder, Builders_ExternalBuilderFixture)
+
+BOOST_AUTO_TEST_CASE(GivenStyle_WhenBuild_ThenCallbackReceivesSameDeclarations)
+{
+    const Style::Declarations* received = nullptr;
+    auto context = dependencyProvider.createBuilderContext(QuadKey(16, 1, 1), stylesheet, nullptr,
+        [&](const Element&, const Style& style) { received = &style.declarations(); });
+    ExternalBuilder builder(*context);
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(), 0,
+        { { "highway", "primary" } }, { { 0, 0 }, { 0, 10 } });
+    Style style = dependencyProvider.getStyleProvider(stylesheet)->forElement(way, 16);
+
+    builder.build(way, style);
+
+    BOOST_CHECK(received == &style.declarations());
+}
+
+BOOST_AUTO_TEST_CASE(GivenNoStyle_WhenVisit_ThenCallbackReceivesCalculatedStyle)
+{
+    bool hasWidth = false;
+    std::uint32_t widthKey = dependencyProvider.getStringTable()->getId("width");
+    auto context = dependencyProvider.createBuilderContext(QuadKey(16, 1, 1), stylesheet, nullptr,
+        [&](const Element&, const Style& style) { hasWidth = style.has(widthKey); });
+    ExternalBuilder builder(*context);
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(), 0,
+        { { "highway", "primary" } }, { { 0, 0 }, { 0, 10 } });
+
+    way.accept(builder);
+
+    BOOST_CHECK(hasWidth);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
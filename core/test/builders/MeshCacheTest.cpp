@@ -0,0 +1,128 @@
+#include "QuadKey.hpp"
+#include "builders/MeshCache.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdio>
+#include <fstream>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::meshing;
+
+namespace {
+    const std::string Directory = "";
+    const std::size_t MemoryLimit = 1024 * 1024;
+
+    MeshCache::Key createKey(int lod, std::uint64_t styleHash = 1)
+    {
+        return MeshCache::Key{ QuadKey(lod, 1, 0), styleHash, 0, 7 };
+    }
+
+    std::shared_ptr<MeshCache::TileData> createData(std::size_t vertexCount = 3)
+    {
+        auto mesh = std::make_shared<Mesh>("mesh");
+        mesh->vertices = std::vector<double>(vertexCount, 1);
+        mesh->triangles = { 0, 1, 2 };
+        mesh->colors = { 0xffffff };
+
+        auto data = std::make_shared<MeshCache::TileData>();
+        data->meshes.push_back(mesh);
+        data->elements.push_back(MeshCache::ElementData{ 42, { "key", "value" }, { 1, 2 }, { "color", "red" } });
+        return data;
+    }
+
+    std::string getFilePath(const QuadKey& quadKey)
+    {
+        return "./" + std::to_string(quadKey.levelOfDetail) + "_" + utymap::utils::GeoUtils::quadKeyToString(quadKey) + ".mesh";
+    }
+
+    struct Builders_MeshCacheFixture
+    {
+        ~Builders_MeshCacheFixture()
+        {
+            std::remove(getFilePath(createKey(1).quadKey).c_str());
+        }
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_MeshCache, Builders_MeshCacheFixture)
+
+BOOST_AUTO_TEST_CASE(GivenPutData_WhenGet_ThenReturnsSameData)
+{
+    MeshCache cache(Directory, MemoryLimit);
+    auto data = createData();
+    cache.put(createKey(1), data);
+
+    auto result = cache.get(createKey(1));
+
+    BOOST_CHECK(result == data);
+}
+
+BOOST_AUTO_TEST_CASE(GivenDifferentStyleHash_WhenGet_ThenReturnsNull)
+{
+    MeshCache cache(Directory, MemoryLimit);
+    cache.put(createKey(1, 1), createData());
+
+    BOOST_CHECK(cache.get(createKey(1, 2)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMemoryLimitExceeded_WhenGet_ThenLeastRecentlyUsedIsEvicted)
+{
+    // NOTE every entry takes more than one third of limit.
+    MeshCache cache(Directory, 3 * 2048 * sizeof(double));
+    cache.put(createKey(1), createData(2048));
+    cache.put(createKey(2), createData(2048));
+    cache.get(createKey(1));
+
+    cache.put(createKey(3), createData(2048));
+
+    BOOST_CHECK(cache.get(createKey(1)) != nullptr);
+    BOOST_CHECK(cache.get(createKey(2)) == nullptr);
+    BOOST_CHECK(cache.get(createKey(3)) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenInvalidatedLod_WhenGet_ThenOnlyOtherLodsAreReturned)
+{
+    MeshCache cache(Directory, MemoryLimit);
+    cache.put(createKey(1), createData());
+    cache.put(createKey(2), createData());
+
+    cache.invalidate(1 << 1);
+
+    BOOST_CHECK(cache.get(createKey(1)) == nullptr);
+    BOOST_CHECK(cache.get(createKey(2)) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenDataOnDisk_WhenGetFromNewCache_ThenDataIsRead)
+{
+    MeshCache("./", 0).put(createKey(1), createData());
+    MeshCache cache("./", MemoryLimit);
+
+    auto result = cache.get(createKey(1));
+
+    BOOST_REQUIRE(result != nullptr);
+    BOOST_REQUIRE_EQUAL(result->meshes.size(), 1);
+    BOOST_CHECK_EQUAL(result->meshes[0]->name, "mesh");
+    BOOST_CHECK_EQUAL(result->meshes[0]->vertices.size(), 3);
+    BOOST_CHECK_EQUAL(result->meshes[0]->triangles.size(), 3);
+    BOOST_CHECK_EQUAL(result->meshes[0]->colors[0], 0xffffff);
+    BOOST_REQUIRE_EQUAL(result->elements.size(), 1);
+    BOOST_CHECK_EQUAL(result->elements[0].id, 42);
+    BOOST_CHECK_EQUAL(result->elements[0].tags[1], "value");
+    BOOST_CHECK_EQUAL(result->elements[0].style[1], "red");
+    BOOST_CHECK(cache.get(createKey(1, 2)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenCorruptedFile_WhenGet_ThenReturnsNull)
+{
+    std::ofstream file(getFilePath(createKey(1).quadKey), std::ios::out | std::ios::binary | std::ios::trunc);
+    file << "UMMC garbage";
+    file.close();
+    MeshCache cache("./", MemoryLimit);
+
+    BOOST_CHECK(cache.get(createKey(1)) == nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
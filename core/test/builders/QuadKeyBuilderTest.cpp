@@ -0,0 +1,132 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyBuilder.hpp"
+#include "entities/Area.hpp"
+#include "index/GeoStore.hpp"
+#include "index/InMemoryElementStore.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include "test_utils/DependencyProvider.hpp"
+#include "test_utils/ElementUtils.hpp"
+
+#include <map>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::entities;
+using namespace utymap::index;
+using namespace utymap::mapcss;
+using namespace utymap::meshing;
+using namespace utymap::utils;
+
+namespace {
+    const std::string StoreKey = "test";
+    const std::string stylesheet =
+        "area|z1[kind=both] { builders: first,second; }"
+        "area|z1[kind=first] { builders: first; }"
+        "area|z1[builder] { builders: eval(\"tag('builder')\"); }";
+
+    // Counts visited areas and reports mesh with their amount when completed.
+    class CountingBuilder : public ElementBuilder
+    {
+    public:
+        CountingBuilder(const BuilderContext& context, const std::string& name) :
+            ElementBuilder(context), name_(name), count_(0)
+        {
+        }
+
+        void visitNode(const Node&) { }
+        void visitWay(const Way&) { }
+        void visitRelation(const Relation&) { }
+        void visitArea(const Area&) { ++count_; }
+
+        void complete()
+        {
+            Mesh mesh(name_);
+            mesh.vertices.resize(count_);
+            context_.meshCallback(mesh);
+        }
+
+    private:
+        std::string name_;
+        std::size_t count_;
+    };
+
+    struct Builders_QuadKeyBuilderFixture
+    {
+        Builders_QuadKeyBuilderFixture() :
+            geoStore(*dependencyProvider.getStringTable()),
+            quadKeyBuilder(geoStore, *dependencyProvider.getStringTable())
+        {
+            geoStore.registerStore(StoreKey, std::make_shared<InMemoryElementStore>(*dependencyProvider.getStringTable()));
+            for (const std::string name : { "first", "second" }) {
+                quadKeyBuilder.registerElementBuilder(name, [name](const BuilderContext& context) {
+                    return std::make_shared<CountingBuilder>(context, name);
+                });
+            }
+        }
+
+        void addArea(std::uint64_t id, const char* kind, const char* key = "kind")
+        {
+            geoStore.add(StoreKey, ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), id,
+                { { key, kind } }, { { 1, 1 }, { 1, 2 }, { 2, 2 }, { 2, 1 } }),
+                LodRange(1, 1), *dependencyProvider.getStyleProvider(stylesheet));
+        }
+
+        DependencyProvider dependencyProvider;
+        GeoStore geoStore;
+        QuadKeyBuilder quadKeyBuilder;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_QuadKeyBuilder, Builders_QuadKeyBuilderFixture)
+
+BOOST_AUTO_TEST_CASE(GivenElementsForSeveralBuilders_WhenBuild_ThenEveryBuilderGetsItsElements)
+{
+    addArea(1, "both");
+    addArea(2, "first");
+    addArea(3, "both");
+    std::map<std::string, std::size_t> counts;
+
+    quadKeyBuilder.build(QuadKey(1, 1, 0), *dependencyProvider.getStyleProvider(stylesheet),
+        *dependencyProvider.getElevationProvider(),
+        [&](const Mesh& mesh) { counts[mesh.name] = mesh.vertices.size(); }, nullptr,
+        CancellationToken::none());
+
+    BOOST_CHECK_EQUAL(counts.size(), 2);
+    BOOST_CHECK_EQUAL(counts["first"], 3);
+    BOOST_CHECK_EQUAL(counts["second"], 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPlainAndEvaluatedBuilders_WhenBuild_ThenBuildersAreResolvedForEveryElement)
+{
+    addArea(1, "first", "builder");
+    addArea(2, "second", "builder");
+    addArea(3, "first,second", "builder");
+    addArea(4, "both");
+    std::map<std::string, std::size_t> counts;
+
+    quadKeyBuilder.build(QuadKey(1, 1, 0), *dependencyProvider.getStyleProvider(stylesheet),
+        *dependencyProvider.getElevationProvider(),
+        [&](const Mesh& mesh) { counts[mesh.name] = mesh.vertices.size(); }, nullptr,
+        CancellationToken::none());
+
+    BOOST_CHECK_EQUAL(counts.size(), 2);
+    BOOST_CHECK_EQUAL(counts["first"], 3);
+    BOOST_CHECK_EQUAL(counts["second"], 3);
+}
+
+BOOST_AUTO_TEST_CASE(GivenCancelledToken_WhenBuild_ThenBuildersAreNotCompleted)
+{
+    addArea(1, "both");
+    CancellationToken cancelToken;
+    cancelToken.cancel();
+    std::size_t meshCount = 0;
+
+    quadKeyBuilder.build(QuadKey(1, 1, 0), *dependencyProvider.getStyleProvider(stylesheet),
+        *dependencyProvider.getElevationProvider(), [&](const Mesh&) { ++meshCount; }, nullptr, cancelToken);
+
+    BOOST_CHECK_EQUAL(meshCount, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,78 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyPrefetcher.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+
+namespace {
+    bool contains(const std::vector<QuadKey>& quadKeys, const QuadKey& quadKey)
+    {
+        return std::find(quadKeys.begin(), quadKeys.end(), quadKey) != quadKeys.end();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(Builders_QuadKeyPrefetcher)
+
+BOOST_AUTO_TEST_CASE(GivenNoHistory_WhenPredict_ThenReturnsDirectNeighbours)
+{
+    QuadKeyPrefetcher prefetcher;
+
+    auto result = prefetcher.predict(QuadKey(10, 100, 100));
+
+    BOOST_CHECK_EQUAL(result.size(), 4);
+    BOOST_CHECK(contains(result, QuadKey(10, 100, 99)));
+    BOOST_CHECK(contains(result, QuadKey(10, 101, 100)));
+    BOOST_CHECK(contains(result, QuadKey(10, 100, 101)));
+    BOOST_CHECK(contains(result, QuadKey(10, 99, 100)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenMotionToEast_WhenPredict_ThenReturnsTilesAhead)
+{
+    QuadKeyPrefetcher prefetcher;
+    prefetcher.predict(QuadKey(10, 100, 100));
+
+    auto result = prefetcher.predict(QuadKey(10, 101, 100));
+
+    BOOST_REQUIRE_EQUAL(result.size(), 3);
+    BOOST_CHECK(result[0] == QuadKey(10, 102, 100));
+    BOOST_CHECK(contains(result, QuadKey(10, 102, 101)));
+    BOOST_CHECK(contains(result, QuadKey(10, 102, 99)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenZoomingIn_WhenPredict_ThenReturnsChildren)
+{
+    QuadKeyPrefetcher prefetcher;
+    prefetcher.predict(QuadKey(10, 100, 100));
+
+    auto result = prefetcher.predict(QuadKey(11, 200, 200));
+
+    BOOST_CHECK(contains(result, QuadKey(12, 400, 400)));
+    BOOST_CHECK(contains(result, QuadKey(12, 401, 401)));
+    BOOST_CHECK(!contains(result, QuadKey(10, 100, 100)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenZoomingOut_WhenPredict_ThenReturnsParent)
+{
+    QuadKeyPrefetcher prefetcher;
+    prefetcher.predict(QuadKey(12, 400, 400));
+
+    auto result = prefetcher.predict(QuadKey(11, 200, 200));
+
+    BOOST_CHECK(contains(result, QuadKey(10, 100, 100)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenTileAtBorder_WhenPredict_ThenInvalidTilesAreSkipped)
+{
+    QuadKeyPrefetcher prefetcher;
+
+    auto result = prefetcher.predict(QuadKey(1, 0, 0));
+
+    BOOST_CHECK_EQUAL(result.size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,129 @@
+#include "QuadKey.hpp"
+#include "builders/QuadKeyScheduler.hpp"
+#include "utils/GeoUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace utymap;
+using namespace utymap::builders;
+using namespace utymap::utils;
+
+namespace {
+    const int LevelOfDetail = 16;
+    const GeoCoordinate Position(52.53, 13.38);
+
+    struct Builders_QuadKeySchedulerFixture
+    {
+        // Adds request for tile shifted from camera's one.
+        bool push(const std::string& name, int dx, int dy, bool isBackground = false)
+        {
+            QuadKey origin = GeoUtils::latLonToQuadKey(Position, LevelOfDetail);
+            return scheduler.push(QuadKey(LevelOfDetail, origin.tileX + dx, origin.tileY + dy),
+                [this, name]() { processed.push_back(name); },
+                [this, name]() { dropped.push_back(name); },
+                isBackground);
+        }
+
+        void processAll()
+        {
+            QuadKeyScheduler::Task task;
+            while (scheduler.pop(task))
+                task();
+        }
+
+        QuadKeyScheduler scheduler;
+        std::vector<std::string> processed;
+        std::vector<std::string> dropped;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Builders_QuadKeyScheduler, Builders_QuadKeySchedulerFixture)
+
+BOOST_AUTO_TEST_CASE(GivenNoCamera_WhenPop_ThenRequestsAreInSubmissionOrder)
+{
+    push("far", 10, 0);
+    push("near", 1, 0);
+    push("current", 0, 0);
+
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "far", "near", "current" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenCameraLookingNorth_WhenPop_ThenVisibleAndCloseRequestsAreFirst)
+{
+    // NOTE tile y grows to south.
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 0, 60, 0 });
+    push("behind", 0, 2);
+    push("aheadFar", 0, -4);
+    push("aheadNear", 0, -2);
+    push("current", 0, 0);
+
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "current", "aheadNear", "aheadFar", "behind" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenQueuedRequests_WhenCameraTurns_ThenRequestsAreReordered)
+{
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 0, 60, 0 });
+    push("north", 0, -2);
+    push("south", 0, 2);
+
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 180, 60, 0 });
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "south", "north" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenQueuedRequests_WhenCameraMovesAway_ThenFarRequestsAreDropped)
+{
+    push("near", 1, 0);
+    push("far", 100, 0);
+
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 90, 60, 2000 });
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "near" }));
+    BOOST_CHECK((dropped == std::vector<std::string>{ "far" }));
+    BOOST_CHECK_EQUAL(scheduler.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenCamera_WhenPushOutOfViewDistance_ThenRequestIsRejected)
+{
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 90, 60, 2000 });
+
+    BOOST_CHECK(!push("far", 100, 0));
+    BOOST_CHECK(push("near", 1, 0));
+
+    BOOST_CHECK(dropped.empty());
+    BOOST_CHECK_EQUAL(scheduler.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenBackgroundRequests_WhenPop_ThenTheyAreProcessedLast)
+{
+    scheduler.setCamera(QuadKeyScheduler::Camera{ Position, 0, 60, 0 });
+    push("background", 0, 0, true);
+    push("foreground", 0, 3);
+
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "foreground", "background" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenBackgroundRequests_WhenDropBackground_ThenOnlyTheyAreDropped)
+{
+    push("background", 1, 0, true);
+    push("foreground", 2, 0);
+
+    scheduler.dropBackground();
+    processAll();
+
+    BOOST_CHECK((processed == std::vector<std::string>{ "foreground" }));
+    BOOST_CHECK((dropped == std::vector<std::string>{ "background" }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
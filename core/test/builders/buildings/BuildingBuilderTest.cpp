@@ -55,6 +55,7 @@ BOOST_AUTO_TEST_CASE(GivenRectangleArea_WhenVisitArea_ThenMeshIsBuilt)
     BuildingBuilder builder(*context);
 
     builder.visitArea(building);
+    builder.complete();
 
     BOOST_CHECK(isCalled);
 }
@@ -86,8 +87,32 @@ BOOST_AUTO_TEST_CASE(GivenRelationWithHole_WhenVisitRelation_ThenMeshIsBuilt)
     BuildingBuilder builder(*context);
 
     builder.visitRelation(relation);
+    builder.complete();
 
     BOOST_CHECK(isCalled);
 }
 
+BOOST_AUTO_TEST_CASE(GivenSeveralBuildings_WhenComplete_ThenMeshesAreReportedInOrder)
+{
+    QuadKey quadKey(1, 1, 0);
+    std::vector<std::string> names;
+    auto context = dependencyProvider.createBuilderContext(quadKey, stylesheet,
+        [&](const Mesh& mesh) { names.push_back(mesh.name); });
+    std::vector<Area> buildings;
+    for (int i = 0; i < 20; ++i) {
+        double offset = i;
+        buildings.push_back(ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), i, { { "building", "yes" } },
+            { { offset + 1, 0 }, { offset + 1, 1 }, { offset, 1 }, { offset, 0 } }));
+    }
+    BuildingBuilder builder(*context);
+
+    for (const auto& building : buildings)
+        builder.visitArea(building);
+    builder.complete();
+
+    BOOST_REQUIRE_EQUAL(names.size(), buildings.size());
+    for (std::size_t i = 0; i < buildings.size(); ++i)
+        BOOST_CHECK_EQUAL(names[i], "building:" + std::to_string(i));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
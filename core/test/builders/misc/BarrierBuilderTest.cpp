@@ -40,6 +40,7 @@ BOOST_AUTO_TEST_CASE(GivenBarrier_WhenVisitWay_ThenMeshIsBuilt)
     { { 0, 0 }, { 0, 10 }, { 10, 10 }, { 10, 0 } });
 
     builder.visitWay(way);
+    builder.complete();
 
     BOOST_CHECK(isCalled);
 }
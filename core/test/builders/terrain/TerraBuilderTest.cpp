@@ -21,7 +21,9 @@ namespace {
     const std::string stylesheet =
         "canvas|z1 { grid-cell-size: 1%; layer-priority: water; ele-noise-freq: 0.05; color-noise-freq: 0.1; color:gradient(red); max-area: 5%;"
         "water-ele-noise-freq: 0.05; water-color-noise-freq: 0.1; water-color:gradient(red);  water-max-area: 5%;}"
-        "area|z1[natural=water] { builders:terrain; terrain-layer:water; }";
+        "area|z1[natural=water] { builders:terrain; terrain-layer:water; }"
+        "way|z1[natural=water] { builders:terrain; terrain-layer:water; width: 1m; }"
+        "relation|z1[natural=water] { builders:terrain; terrain-layer:water; }";
 
     struct Builders_Terrain_TerraBuilderFixture
     {
@@ -55,4 +57,21 @@ BOOST_AUTO_TEST_CASE(GivenLargeWater_WhenComplete_ThenMeshIsNotEmpty)
     BOOST_CHECK(isCalled);
 }
 
+BOOST_AUTO_TEST_CASE(GivenRelationWithUntaggedMember_WhenBuild_ThenMemberTagsAreNotChanged)
+{
+    QuadKey quadKey(1, 0, 0);
+    auto context = dependencyProvider.createBuilderContext(quadKey, stylesheet, [](const Mesh&) {});
+    TerraBuilder terraBuilder(*context);
+    auto way = std::make_shared<Way>(ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(),
+        1, {}, { { 0, 0 }, { 20, 20 } }));
+    Relation relation = ElementUtils::createElement<Relation>(*dependencyProvider.getStringTable(),
+        2, { { "natural", "water" } });
+    relation.elements.push_back(way);
+
+    relation.accept(terraBuilder);
+    terraBuilder.complete();
+
+    BOOST_CHECK(way->tags.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
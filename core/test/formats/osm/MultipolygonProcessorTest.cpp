@@ -292,4 +292,26 @@ BOOST_AUTO_TEST_CASE(GivenSpecificFourOuter_WhenProcess_ThenDoesNotCrash)
     BOOST_CHECK_EQUAL(5, reinterpret_cast<const Area&>(*relation->elements[0]).coordinates.size());
 }
 
+BOOST_AUTO_TEST_CASE(GivenInnerTouchingNonClosedOuter_WhenProcess_ThenInnerIsDetected)
+{
+    RelationMembers relationMembers = createRelationMembers({
+        std::make_tuple(1, "w", "inner"),
+        std::make_tuple(2, "w", "outer"),
+        std::make_tuple(3, "w", "outer")
+    });
+    context.areaMap[1] = createElement<Area>({ { 0, 10 }, { 2, 8 }, { 4, 9 }, { 0, 10 } });
+    context.wayMap[2] = createElement<Way>({ { 0, 0 }, { 0, 10 }, { 10, 10 } });
+    context.wayMap[3] = createElement<Way>({ { 0, 0 }, { 10, 0 }, { 10, 10 } });
+    MultipolygonProcessor processor(*createRelation(), relationMembers, context,
+        std::bind(&Formats_Osm_MultipolygonProcessorFixture::resolve, this, std::placeholders::_1));
+
+    processor.process();
+
+    auto relation = context.relationMap[0];
+    BOOST_CHECK_EQUAL(2, relation->elements.size());
+    BOOST_CHECK_EQUAL(5, reinterpret_cast<const Area&>(*relation->elements[0]).coordinates.size());
+    BOOST_CHECK(ensureExpectedOrientation(context.areaMap[1]->coordinates, false) ==
+        reinterpret_cast<const Area&>(*relation->elements[1]).coordinates);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+#include "entities/Node.hpp"
+#include "entities/Way.hpp"
+#include "entities/Area.hpp"
+#include "entities/Relation.hpp"
+#include "formats/osm/OsmDataVisitor.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include "test_utils/DependencyProvider.hpp"
+
+#include <map>
+#include <set>
+
+using namespace utymap;
+using namespace utymap::entities;
+using namespace utymap::formats;
+
+namespace {
+
+    struct Formats_Osm_OsmDataVisitorFixture
+    {
+        Formats_Osm_OsmDataVisitorFixture() :
+            dependencyProvider(),
+            visitor(*dependencyProvider.getStringTable(), [this](Element& element) {
+                auto relation = dynamic_cast<Relation*>(&element);
+                if (relation != nullptr)
+                    relations[relation->id] = relation;
+                else
+                    elements.insert(element.id);
+                return true;
+            })
+        {
+        }
+
+        void addWay(std::uint64_t id, std::uint64_t firstNodeId)
+        {
+            for (std::uint64_t nodeId = firstNodeId; nodeId < firstNodeId + 2; ++nodeId) {
+                GeoCoordinate coordinate(static_cast<double>(nodeId), 1);
+                Tags tags;
+                visitor.visitNode(nodeId, coordinate, tags);
+            }
+
+            std::vector<std::uint64_t> nodeIds = { firstNodeId, firstNodeId + 1 };
+            Tags tags;
+            visitor.visitWay(id, nodeIds, tags);
+        }
+
+        void addRelation(std::uint64_t id, const std::string& type, RelationMembers members)
+        {
+            Tags tags = { utymap::formats::Tag{ "type", type } };
+            visitor.visitRelation(id, members, tags);
+        }
+
+        DependencyProvider dependencyProvider;
+        OsmDataVisitor visitor;
+        std::set<std::uint64_t> elements;
+        std::map<std::uint64_t, const Relation*> relations;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(Formats_Osm_OsmDataVisitor, Formats_Osm_OsmDataVisitorFixture)
+
+BOOST_AUTO_TEST_CASE(GivenBuildingsSharingWay_WhenComplete_ThenWayIsPartOfBothAndRemovedOnce)
+{
+    addWay(11, 1);
+    addWay(12, 3);
+    addRelation(100, "building", { { 11, "w", "part" }, { 12, "w", "part" } });
+    addRelation(200, "building", { { 12, "w", "part" } });
+
+    visitor.complete();
+
+    BOOST_CHECK_EQUAL(relations.size(), 2);
+    BOOST_CHECK_EQUAL(relations[100]->elements.size(), 2);
+    BOOST_CHECK_EQUAL(relations[200]->elements.size(), 1);
+    BOOST_CHECK((elements == std::set<std::uint64_t>{ 1, 2, 3, 4 }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenRelationsSharingRelationMember_WhenComplete_ThenMemberIsResolvedOnce)
+{
+    addWay(11, 1);
+    addWay(12, 3);
+    addWay(13, 5);
+    addRelation(101, "building", { { 12, "w", "part" } });
+    addRelation(100, "building", { { 11, "w", "part" }, { 101, "r", "part" } });
+    addRelation(300, "route", { { 101, "r", "" } });
+    addRelation(200, "building", { { 13, "w", "part" } });
+
+    visitor.complete();
+
+    BOOST_CHECK_EQUAL(relations.size(), 3);
+    BOOST_CHECK(relations.find(101) == relations.end());
+    BOOST_CHECK_EQUAL(relations[100]->elements.size(), 2);
+    BOOST_CHECK_EQUAL(relations[200]->elements.size(), 1);
+    BOOST_REQUIRE_EQUAL(relations[300]->elements.size(), 1);
+    BOOST_CHECK_EQUAL(relations[300]->elements[0]->id, 101);
+    BOOST_CHECK_EQUAL(dynamic_cast<const Relation&>(*relations[300]->elements[0]).elements.size(), 1);
+    BOOST_CHECK((elements == std::set<std::uint64_t>{ 1, 2, 3, 4, 5, 6 }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -5,12 +5,135 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <cmath>
 #include <fstream>
+#include <set>
+#include <sstream>
 
 using namespace utymap::formats;
 
 namespace {
 
+    // Collects ids of visited elements.
+    struct IdOsmDataVisitor
+    {
+        std::set<uint64_t> nodes, ways, relations;
+
+        void visitNode(uint64_t id, utymap::GeoCoordinate&, Tags&) { nodes.insert(id); }
+        void visitWay(uint64_t id, std::vector<uint64_t>&, Tags&) { ways.insert(id); }
+        void visitRelation(uint64_t id, RelationMembers&, Tags&) { relations.insert(id); }
+    };
+
+    template<typename Message>
+    void writeBlob(std::ostream& stream, const std::string& type, const Message& message)
+    {
+        OSMPBF::Blob blob;
+        blob.set_raw(message.SerializeAsString());
+        blob.set_raw_size(static_cast<int>(blob.raw().size()));
+        std::string blobData = blob.SerializeAsString();
+
+        OSMPBF::BlobHeader header;
+        header.set_type(type);
+        header.set_datasize(static_cast<int>(blobData.size()));
+        std::string headerData = header.SerializeAsString();
+
+        std::uint32_t size = static_cast<std::uint32_t>(headerData.size());
+        char sizeData[] = { char(size >> 24), char(size >> 16), char(size >> 8), char(size) };
+        stream.write(sizeData, 4);
+        stream << headerData << blobData;
+    }
+
+    // Writes block with dense nodes which have the same latitude and longitude.
+    void writeNodes(std::ostream& stream, std::initializer_list<std::pair<uint64_t, double>> nodes)
+    {
+        OSMPBF::PrimitiveBlock block;
+        block.mutable_stringtable()->add_s("");
+        auto dense = block.add_primitivegroup()->mutable_dense();
+        int64_t lastId = 0, lastCoord = 0;
+        for (const auto& node : nodes) {
+            int64_t coord = std::llround(node.second * 10000000);
+            dense->add_id(static_cast<int64_t>(node.first) - lastId);
+            dense->add_lat(coord - lastCoord);
+            dense->add_lon(coord - lastCoord);
+            lastId = node.first;
+            lastCoord = coord;
+        }
+        writeBlob(stream, "OSMData", block);
+    }
+
+    // Writes test file with three node blocks, ways and relations.
+    std::string createPbf()
+    {
+        std::stringstream stream;
+        writeBlob(stream, "OSMHeader", OSMPBF::HeaderBlock());
+        writeNodes(stream, { { 1, 1.1 }, { 2, 1.2 }, { 3, 1.3 } });
+        writeNodes(stream, { { 4, 5.1 }, { 5, 5.2 }, { 6, 5.3 } });
+        writeNodes(stream, { { 7, 9.1 }, { 8, 9.2 } });
+
+        OSMPBF::PrimitiveBlock block;
+        block.mutable_stringtable()->add_s("");
+        block.mutable_stringtable()->add_s("highway");
+        auto group = block.add_primitivegroup();
+        // crosses bbox
+        auto way = group->add_ways();
+        way->set_id(100);
+        way->add_keys(1);
+        way->add_vals(1);
+        way->add_refs(2);
+        way->add_refs(2);
+        // outside of bbox
+        way = group->add_ways();
+        way->set_id(101);
+        way->add_refs(5);
+        way->add_refs(1);
+        // outside of bbox, not referenced
+        way = group->add_ways();
+        way->set_id(102);
+        way->add_refs(7);
+        way->add_refs(1);
+
+        group = block.add_primitivegroup();
+        // refers to relation defined later
+        auto relation = group->add_relations();
+        relation->set_id(205);
+        relation->add_memids(201);
+        relation->add_types(OSMPBF::Relation::RELATION);
+        relation->add_roles_sid(0);
+        // refers to way inside bbox and to way outside
+        relation = group->add_relations();
+        relation->set_id(200);
+        relation->add_memids(100);
+        relation->add_memids(1);
+        relation->add_types(OSMPBF::Relation::WAY);
+        relation->add_types(OSMPBF::Relation::WAY);
+        relation->add_roles_sid(0);
+        relation->add_roles_sid(0);
+        // refers to relation defined before and to relation outside of bbox
+        relation = group->add_relations();
+        relation->set_id(201);
+        relation->add_memids(200);
+        relation->add_memids(3);
+        relation->add_types(OSMPBF::Relation::RELATION);
+        relation->add_types(OSMPBF::Relation::RELATION);
+        relation->add_roles_sid(0);
+        relation->add_roles_sid(0);
+        // refers to node outside bbox only
+        relation = group->add_relations();
+        relation->set_id(202);
+        relation->add_memids(7);
+        relation->add_types(OSMPBF::Relation::NODE);
+        relation->add_roles_sid(0);
+        // outside of bbox, member of relation inside
+        relation = group->add_relations();
+        relation->set_id(203);
+        relation->add_memids(102);
+        relation->add_types(OSMPBF::Relation::WAY);
+        relation->add_roles_sid(0);
+        writeBlob(stream, "OSMData", block);
+
+        return stream.str();
+    }
+
     struct Formats_Osm_Pbf_OsmPbfParserFixture
     {
         Formats_Osm_Pbf_OsmPbfParserFixture() :
@@ -42,4 +165,55 @@ BOOST_AUTO_TEST_CASE(GivenDefaultPbf_WhenParserParse_ThenHasExpectedElementCount
     BOOST_CHECK_EQUAL(visitor.relations, 3064);
 }
 
+BOOST_AUTO_TEST_CASE(GivenPbf_WhenBuildIndex_ThenIndexHasBlocks)
+{
+    std::stringstream stream(createPbf());
+
+    auto index = parser.buildIndex(stream);
+
+    BOOST_CHECK_EQUAL(index.sourceSize, stream.str().size());
+    BOOST_CHECK_EQUAL(index.blocks.size(), 4);
+    BOOST_CHECK(index.blocks[0].has(OsmPbfIndex::Nodes));
+    BOOST_CHECK_EQUAL(index.blocks[1].minNodeId, 4);
+    BOOST_CHECK_EQUAL(index.blocks[1].maxNodeId, 6);
+    BOOST_CHECK_CLOSE(index.blocks[1].bbox.minPoint.latitude, 5.1, 1e-6);
+    BOOST_CHECK_CLOSE(index.blocks[1].bbox.maxPoint.longitude, 5.3, 1e-6);
+    BOOST_CHECK(index.blocks[3].has(OsmPbfIndex::Ways));
+    BOOST_CHECK(index.blocks[3].has(OsmPbfIndex::Relations));
+    BOOST_CHECK(!index.blocks[3].has(OsmPbfIndex::Nodes));
+}
+
+BOOST_AUTO_TEST_CASE(GivenIndex_WhenWriteAndRead_ThenIndexIsTheSame)
+{
+    std::stringstream stream(createPbf());
+    auto index = parser.buildIndex(stream);
+    index.sourceTime = 1234567890;
+    std::stringstream indexStream;
+
+    index.write(indexStream);
+    OsmPbfIndex result;
+    bool isRead = result.read(indexStream);
+
+    BOOST_CHECK(isRead);
+    BOOST_CHECK_EQUAL(result.sourceSize, index.sourceSize);
+    BOOST_CHECK_EQUAL(result.sourceTime, index.sourceTime);
+    BOOST_CHECK_EQUAL(result.blocks.size(), index.blocks.size());
+    BOOST_CHECK_EQUAL(result.blocks[2].offset, index.blocks[2].offset);
+    BOOST_CHECK_EQUAL(result.blocks[2].maxNodeId, index.blocks[2].maxNodeId);
+}
+
+BOOST_AUTO_TEST_CASE(GivenIndex_WhenParseBoundingBox_ThenVisitsOnlyRelatedElements)
+{
+    std::stringstream stream(createPbf());
+    OsmPbfParser<IdOsmDataVisitor> idParser;
+    auto index = idParser.buildIndex(stream);
+    IdOsmDataVisitor idVisitor;
+
+    idParser.parse(stream, idVisitor, index, utymap::BoundingBox(utymap::GeoCoordinate(1, 1), utymap::GeoCoordinate(2, 2)));
+
+    BOOST_CHECK((idVisitor.nodes == std::set<uint64_t>{ 1, 2, 3, 4, 5, 6, 7, 8 }));
+    BOOST_CHECK((idVisitor.ways == std::set<uint64_t>{ 100, 101, 102 }));
+    BOOST_CHECK((idVisitor.relations == std::set<uint64_t>{ 200, 201, 203, 205 }));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
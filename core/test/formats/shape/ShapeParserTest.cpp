@@ -2,8 +2,14 @@
 #include "formats/shape/ShapeParser.hpp"
 #include "formats/shape/CountableShapeDataVisitor.hpp"
 
+#include "shapefile/shapefil.h"
+
 #include <boost/test/unit_test.hpp>
 
+#include <sstream>
+#include <string>
+#include <vector>
+
 using namespace utymap::formats;
 using namespace utymap::index;
 
@@ -15,6 +21,158 @@ namespace {
         ShapeParser<CountableShapeDataVisitor> parser;
         CountableShapeDataVisitor visitor;
     };
+
+    // Visited shape record: node, way or relation.
+    struct ShapeRecordData
+    {
+        char type;
+        PolygonMembers members;
+        Tags tags;
+    };
+
+    // Records all visited shapes in visit order.
+    struct RecordingShapeDataVisitor
+    {
+        std::vector<ShapeRecordData> records;
+
+        void visitNode(utymap::GeoCoordinate& coordinate, Tags& tags)
+        {
+            PolygonMember member;
+            member.isRing = false;
+            member.coordinates.push_back(coordinate);
+            records.push_back(ShapeRecordData{ 'n', PolygonMembers{ member }, tags });
+        }
+
+        void visitWay(Coordinates& coordinates, Tags& tags, bool isRing)
+        {
+            PolygonMember member;
+            member.isRing = isRing;
+            member.coordinates = coordinates;
+            records.push_back(ShapeRecordData{ 'w', PolygonMembers{ member }, tags });
+        }
+
+        void visitRelation(PolygonMembers& members, Tags& tags)
+        {
+            records.push_back(ShapeRecordData{ 'r', members, tags });
+        }
+    };
+
+    template <typename T>
+    std::string toString(const T& value)
+    {
+        std::stringstream ss;
+        ss << value;
+        return ss.str();
+    }
+
+    // Reads shapes with shapelib the way parser did before it was
+    // switched to memory mapped reader.
+    std::vector<ShapeRecordData> readBaseline(const std::string& path)
+    {
+        std::vector<ShapeRecordData> records;
+        SHPHandle shpFile = SHPOpen(path.c_str(), "rb");
+        DBFHandle dbfFile = DBFOpen(path.c_str(), "rb");
+        BOOST_REQUIRE(shpFile != nullptr && dbfFile != nullptr);
+
+        int entityCount, shapeType;
+        double minBound[4], maxBound[4];
+        SHPGetInfo(shpFile, &entityCount, &shapeType, minBound, maxBound);
+        for (int k = 0; k < entityCount; ++k) {
+            SHPObject* shape = SHPReadObject(shpFile, k);
+            BOOST_REQUIRE(shape != nullptr);
+
+            ShapeRecordData record;
+            char title[12];
+            for (int i = 0; i < DBFGetFieldCount(dbfFile); ++i) {
+                if (DBFIsAttributeNULL(dbfFile, k, i))
+                    continue;
+                int width, decimals;
+                Tag tag;
+                DBFFieldType type = DBFGetFieldInfo(dbfFile, i, title, &width, &decimals);
+                tag.key = title;
+                if (type == FTString)
+                    tag.value = DBFReadStringAttribute(dbfFile, k, i);
+                else if (type == FTInteger)
+                    tag.value = toString(DBFReadIntegerAttribute(dbfFile, k, i));
+                else if (type == FTDouble)
+                    tag.value = toString(DBFReadDoubleAttribute(dbfFile, k, i));
+                record.tags.push_back(tag);
+            }
+
+            switch (shape->nSHPType) {
+                case SHPT_POINT:
+                case SHPT_POINTM:
+                case SHPT_POINTZ:
+                    record.type = 'n';
+                    record.members.push_back(PolygonMember{ false, { utymap::GeoCoordinate(shape->padfY[0], shape->padfX[0]) } });
+                    break;
+                case SHPT_ARC:
+                case SHPT_ARCZ:
+                case SHPT_ARCM:
+                    record.type = shape->nParts > 1 ? '\0' : 'w';
+                    record.members.push_back(PolygonMember());
+                    for (int i = 0; i < shape->nVertices; ++i)
+                        record.members[0].coordinates.push_back(utymap::GeoCoordinate(shape->padfY[i], shape->padfX[i]));
+                    record.members[0].isRing = record.members[0].coordinates.front() == record.members[0].coordinates.back();
+                    break;
+                case SHPT_POLYGON:
+                case SHPT_POLYGONZ:
+                case SHPT_POLYGONM:
+                    record.type = 'r';
+                    for (int part = 0; part < shape->nParts; ++part) {
+                        int end = part == shape->nParts - 1 ? shape->nVertices : shape->panPartStart[part + 1];
+                        record.members.push_back(PolygonMember());
+                        record.members.back().isRing = shape->panPartType[part] == SHPP_RING;
+                        for (int i = shape->panPartStart[part]; i < end; ++i)
+                            record.members.back().coordinates.push_back(utymap::GeoCoordinate(shape->padfY[i], shape->padfX[i]));
+                    }
+                    break;
+                default:
+                    record.type = '\0';
+                    break;
+            }
+            SHPDestroyObject(shape);
+
+            if (record.type != '\0')
+                records.push_back(record);
+        }
+
+        DBFClose(dbfFile);
+        SHPClose(shpFile);
+        return records;
+    }
+
+    // Checks that parser visits the same records as baseline reader.
+    void checkBaselineParity(const std::string& path)
+    {
+        BOOST_TEST_CHECKPOINT(path);
+        RecordingShapeDataVisitor visitor;
+        ShapeParser<RecordingShapeDataVisitor>().parse(path, visitor);
+        std::vector<ShapeRecordData> expected = readBaseline(path);
+
+        BOOST_REQUIRE_EQUAL(visitor.records.size(), expected.size());
+        for (std::size_t i = 0; i < expected.size(); ++i) {
+            const ShapeRecordData& actual = visitor.records[i];
+            BOOST_CHECK_EQUAL(actual.type, expected[i].type);
+
+            BOOST_REQUIRE_EQUAL(actual.tags.size(), expected[i].tags.size());
+            for (std::size_t j = 0; j < expected[i].tags.size(); ++j) {
+                BOOST_CHECK_EQUAL(actual.tags[j].key, expected[i].tags[j].key);
+                BOOST_CHECK_EQUAL(actual.tags[j].value, expected[i].tags[j].value);
+            }
+
+            BOOST_REQUIRE_EQUAL(actual.members.size(), expected[i].members.size());
+            for (std::size_t j = 0; j < expected[i].members.size(); ++j) {
+                const PolygonMember& member = actual.members[j];
+                BOOST_CHECK_EQUAL(member.isRing, expected[i].members[j].isRing);
+                BOOST_REQUIRE_EQUAL(member.coordinates.size(), expected[i].members[j].coordinates.size());
+                for (std::size_t k = 0; k < member.coordinates.size(); ++k) {
+                    BOOST_CHECK_EQUAL(member.coordinates[k].latitude, expected[i].members[j].coordinates[k].latitude);
+                    BOOST_CHECK_EQUAL(member.coordinates[k].longitude, expected[i].members[j].coordinates[k].longitude);
+                }
+            }
+        }
+    }
 }
 
 BOOST_FIXTURE_TEST_SUITE(Formats_ShapeParser, Formats_Shape_ShapeParserFixture)
@@ -43,6 +201,13 @@ BOOST_AUTO_TEST_CASE(GivenTestPointFile_WhenParse_ThenHasCorrectTags)
     BOOST_CHECK_EQUAL(visitor.lastTags[0].value, "test4");
 }
 
+BOOST_AUTO_TEST_CASE(GivenTestPointFileWithExtension_WhenParse_ThenVisitsAllRecords)
+{
+    parser.parse(std::string(TEST_SHAPE_POINT_FILE) + ".shp", visitor);
+
+    BOOST_CHECK_EQUAL(visitor.nodes, 4);
+}
+
 BOOST_AUTO_TEST_CASE(GivenTestLineFile_WhenParse_ThenVisitsAllRecords)
 {
     parser.parse(TEST_SHAPE_LINE_FILE, visitor);
@@ -102,4 +267,27 @@ BOOST_AUTO_TEST_CASE(GivenTestMultiPolyFile_WhenParse_ThenHasCorrectGeometry)
     BOOST_CHECK_CLOSE(visitor.lastMembers[1].coordinates[0].longitude, -94.9856752963366, Precision);
 }
 
+BOOST_AUTO_TEST_CASE(GivenTestPolyFile_WhenParse_ThenAllMembersAreRings)
+{
+    RecordingShapeDataVisitor recordingVisitor;
+
+    ShapeParser<RecordingShapeDataVisitor>().parse(TEST_SHAPE_POLY_FILE, recordingVisitor);
+
+    BOOST_REQUIRE(!recordingVisitor.records.empty());
+    for (const auto& record : recordingVisitor.records) {
+        for (const auto& member : record.members)
+            BOOST_CHECK(member.isRing);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(GivenTestAssets_WhenParse_ThenRecordsMatchShapelibBaseline)
+{
+    for (const std::string& path : { TEST_SHAPE_POINT_FILE, TEST_SHAPE_LINE_FILE, TEST_SHAPE_POLY_FILE,
+                                     TEST_SHAPE_MULTIPOLY_FILE, TEST_SHAPE_NE_110M_LAND, TEST_SHAPE_NE_110M_RIVERS,
+                                     TEST_SHAPE_NE_110M_LAKES, TEST_SHAPE_NE_110M_ADMIN, TEST_SHAPE_NE_110M_BORDERS,
+                                     TEST_SHAPE_NE_110M_POPULATED_PLACES }) {
+        checkBaselineParity(path);
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
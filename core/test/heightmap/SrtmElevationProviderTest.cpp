@@ -3,6 +3,9 @@
 #include "config.hpp"
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+#include <vector>
+
 using namespace utymap;
 using namespace utymap::heightmap;
 
@@ -18,4 +21,21 @@ BOOST_AUTO_TEST_CASE(GivenTestLocation_WhenGetElevation_ThenReturnExpectedIntege
     BOOST_CHECK_CLOSE(ele, 34.853, 0.01);
 }
 
+BOOST_AUTO_TEST_CASE(GivenNotPreloadedCell_WhenGetElevationConcurrently_ThenLoadsCellOnDemand)
+{
+    SrtmElevationProvider eleProvider(TEST_ELEVATION_DIRECTORY);
+    std::vector<double> elevations(4);
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < elevations.size(); ++i)
+        threads.push_back(std::thread([&, i]() {
+            elevations[i] = eleProvider.getElevation(52.5317429, 13.3871987);
+        }));
+    for (auto& thread : threads)
+        thread.join();
+
+    for (double ele : elevations)
+        BOOST_CHECK_CLOSE(ele, 34.853, 0.01);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
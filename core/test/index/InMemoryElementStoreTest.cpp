@@ -76,4 +76,32 @@ BOOST_AUTO_TEST_CASE(GivenNodeWayArea_WhenSearch_ThenAllSkipped)
     BOOST_CHECK_EQUAL(counter.times, 0);
 }
 
+BOOST_AUTO_TEST_CASE(GivenNodeWayArea_WhenSearchShared_ThenStoredElementsAreNotCopied)
+{
+    QuadKey quadKey(1, 0, 0);
+    std::vector<const Element*> first, second;
+
+    elementStore.search(quadKey, [&](const std::shared_ptr<const Element>& element) { first.push_back(element.get()); });
+    elementStore.search(quadKey, [&](const std::shared_ptr<const Element>& element) { second.push_back(element.get()); });
+
+    BOOST_CHECK_EQUAL(first.size(), 3);
+    BOOST_CHECK(first == second);
+}
+
+BOOST_AUTO_TEST_CASE(GivenNodeWayArea_WhenHasDataForSortedQuadKeys_ThenReturnsTheSameAsForSingleQuadKey)
+{
+    std::vector<QuadKey> quadKeys;
+    for (int lod = 1; lod <= 3; ++lod)
+        for (int x = 0; x < 1 << lod; ++x)
+            for (int y = 0; y < 1 << lod; ++y)
+                quadKeys.push_back(QuadKey(lod, x, y));
+    std::unique_ptr<bool[]> results(new bool[quadKeys.size()]());
+
+    elementStore.hasData(quadKeys, results.get());
+
+    for (std::size_t i = 0; i < quadKeys.size(); ++i)
+        BOOST_CHECK_EQUAL(results[i], elementStore.hasData(quadKeys[i]));
+    BOOST_CHECK(results[0]);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -9,7 +9,9 @@
 #include "test_utils/ElementUtils.hpp"
 
 #include <boost/filesystem/operations.hpp>
+#include <algorithm>
 #include <cstdio>
+#include <memory>
 
 using namespace utymap;
 using namespace utymap::entities;
@@ -18,6 +20,7 @@ using namespace utymap::mapcss;
 
 namespace {
     const std::string TestZoomDirectory = "1";
+    const std::string RevisionFile = "revision.txt";
 
     const std::string stylesheet = "node|z1[any], way|z1[any], area|z1[any], relation|z1[any] { clip: false; }";
 
@@ -39,6 +42,7 @@ namespace {
                 boost::filesystem::remove_all(it->path());
             }
             boost::filesystem::remove(TestZoomDirectory);
+            std::remove(RevisionFile.c_str());
         }
 
         DependencyProvider dependencyProvider;
@@ -198,4 +202,32 @@ BOOST_AUTO_TEST_CASE(GivenTwoAreas_WhenStoreAndSearchOnce_ThenTheyStoredTwiceAnd
     assertWayOrArea(area2, *std::dynamic_pointer_cast<Area>(counter.element));
 }
 
+BOOST_AUTO_TEST_CASE(GivenUpdatedRevision_WhenStoreIsOpenedAgain_ThenRevisionIsRestored)
+{
+    std::uint64_t initial = elementStore.getRevision();
+
+    elementStore.updateRevision("file;test.osm.xml;100;1");
+    PersistentElementStore reopened("", *dependencyProvider.getStringTable());
+
+    BOOST_CHECK_NE(elementStore.getRevision(), initial);
+    BOOST_CHECK_EQUAL(reopened.getRevision(), elementStore.getRevision());
+}
+
+BOOST_AUTO_TEST_CASE(GivenStoredNode_WhenHasDataForSeveralQuadKeys_ThenResultsMatchSingleChecks)
+{
+    auto styleProvider = dependencyProvider.getStyleProvider(stylesheet);
+    Node node = ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 7, { { "any", "true" } });
+    node.coordinate = { 5, -5 };
+    elementStore.store(node, LodRange(1, 1), *styleProvider);
+    elementStore.commit();
+    std::vector<QuadKey> quadKeys = { QuadKey(1, 0, 0), QuadKey(1, 0, 1), QuadKey(1, 1, 0), QuadKey(1, 1, 1), QuadKey(2, 1, 1) };
+    std::unique_ptr<bool[]> results(new bool[quadKeys.size()]());
+
+    elementStore.hasData(quadKeys, results.get());
+
+    for (std::size_t i = 0; i < quadKeys.size(); ++i)
+        BOOST_CHECK_EQUAL(results[i], elementStore.hasData(quadKeys[i]));
+    BOOST_CHECK_EQUAL(std::count(results.get(), results.get() + quadKeys.size(), true), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
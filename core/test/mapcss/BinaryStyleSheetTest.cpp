@@ -0,0 +1,80 @@
+#include "mapcss/BinaryStyleSheet.hpp"
+#include "mapcss/MapCssParser.hpp"
+#include "utils/CoreUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include "config.hpp"
+#include "test_utils/DependencyProvider.hpp"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace utymap::mapcss;
+
+namespace {
+    const std::string SourcePath = TEST_MAPCSS_PATH "import.mapcss";
+    const std::string BinaryPath = "test_stylesheet.bin";
+
+    struct MapCss_BinaryStyleSheetFixture
+    {
+        MapCss_BinaryStyleSheetFixture()
+        {
+            std::ifstream styleFile(SourcePath);
+            stylesheet = MapCssParser(TEST_MAPCSS_PATH).parse(styleFile);
+            stylesheet.rules[0].declarations.push_back(Declaration{ "color", "gradient(#0fffff, #099999 50%, #033333 70%, #000000)" });
+        }
+
+        ~MapCss_BinaryStyleSheetFixture()
+        {
+            std::remove(BinaryPath.c_str());
+        }
+
+        DependencyProvider dependencyProvider;
+        StyleSheet stylesheet;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_BinaryStyleSheet, MapCss_BinaryStyleSheetFixture)
+
+BOOST_AUTO_TEST_CASE(GivenWrittenStyleSheet_WhenRead_ThenStyleSheetIsSame)
+{
+    StyleProvider styleProvider(stylesheet, *dependencyProvider.getStringTable());
+    BOOST_REQUIRE(BinaryStyleSheet::write(BinaryPath, SourcePath, stylesheet, styleProvider.getGradients()));
+    StyleSheet result;
+    StyleProvider::Gradients gradients;
+
+    bool isRead = BinaryStyleSheet::read(BinaryPath, SourcePath, result, gradients);
+
+    BOOST_REQUIRE(isRead);
+    BOOST_REQUIRE_EQUAL(result.rules.size(), stylesheet.rules.size());
+    for (std::size_t i = 0; i < result.rules.size(); ++i)
+        BOOST_CHECK_EQUAL(utymap::utils::toString(result.rules[i]), utymap::utils::toString(stylesheet.rules[i]));
+    BOOST_CHECK_EQUAL(result.imports.size(), 2);
+    BOOST_REQUIRE_EQUAL(gradients.size(), 1);
+    auto expected = styleProvider.getGradients().begin()->second;
+    auto actual = gradients.begin()->second;
+    BOOST_CHECK_EQUAL(static_cast<std::uint32_t>(actual->evaluate(0.6)), static_cast<std::uint32_t>(expected->evaluate(0.6)));
+}
+
+BOOST_AUTO_TEST_CASE(GivenDifferentSourcePath_WhenRead_ThenReturnFalse)
+{
+    StyleProvider styleProvider(stylesheet, *dependencyProvider.getStringTable());
+    BinaryStyleSheet::write(BinaryPath, SourcePath, stylesheet, styleProvider.getGradients());
+    StyleSheet result;
+    StyleProvider::Gradients gradients;
+
+    BOOST_CHECK(!BinaryStyleSheet::read(BinaryPath, TEST_MAPCSS_PATH "import/import1.mapcss", result, gradients));
+}
+
+BOOST_AUTO_TEST_CASE(GivenCorruptedFile_WhenRead_ThenReturnFalse)
+{
+    std::ofstream file(BinaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+    file << "UMSS garbage";
+    file.close();
+    StyleSheet result;
+    StyleProvider::Gradients gradients;
+
+    BOOST_CHECK(!BinaryStyleSheet::read(BinaryPath, SourcePath, result, gradients));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,68 @@
+#include "mapcss/StyleCache.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace utymap::entities;
+using namespace utymap::mapcss;
+
+namespace {
+    struct MapCss_StyleCacheFixture
+    {
+        MapCss_StyleCacheFixture() : cache(2, 1)
+        {
+        }
+
+        std::shared_ptr<const int> put(int type, int lod, const std::vector<Tag>& tags, int value)
+        {
+            return cache.put(type, lod, tags, std::make_shared<const int>(value));
+        }
+
+        StyleCache<int> cache;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_StyleCache, MapCss_StyleCacheFixture)
+
+BOOST_AUTO_TEST_CASE(GivenStoredValue_WhenGetWithSameKey_ThenReturnValue)
+{
+    put(1, 16, { Tag(1, 2), Tag(3, 4) }, 42);
+
+    auto value = cache.get(1, 16, { Tag(1, 2), Tag(3, 4) });
+
+    BOOST_REQUIRE(value != nullptr);
+    BOOST_CHECK_EQUAL(*value, 42);
+}
+
+BOOST_AUTO_TEST_CASE(GivenStoredValue_WhenGetWithDifferentKey_ThenReturnNull)
+{
+    put(1, 16, { Tag(1, 2) }, 42);
+
+    BOOST_CHECK(cache.get(2, 16, { Tag(1, 2) }) == nullptr);
+    BOOST_CHECK(cache.get(1, 15, { Tag(1, 2) }) == nullptr);
+    BOOST_CHECK(cache.get(1, 16, { Tag(1, 3) }) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenStoredValue_WhenPutSameKey_ThenReturnExistingValue)
+{
+    put(1, 16, { Tag(1, 2) }, 42);
+
+    auto value = put(1, 16, { Tag(1, 2) }, 7);
+
+    BOOST_CHECK_EQUAL(*value, 42);
+}
+
+BOOST_AUTO_TEST_CASE(GivenFullCache_WhenPut_ThenLeastRecentlyUsedIsEvicted)
+{
+    put(1, 16, { Tag(1, 1) }, 1);
+    put(1, 16, { Tag(2, 2) }, 2);
+    cache.get(1, 16, { Tag(1, 1) });
+
+    put(1, 16, { Tag(3, 3) }, 3);
+
+    BOOST_CHECK_EQUAL(cache.size(), 2);
+    BOOST_CHECK(cache.get(1, 16, { Tag(1, 1) }) != nullptr);
+    BOOST_CHECK(cache.get(1, 16, { Tag(2, 2) }) == nullptr);
+    BOOST_CHECK(cache.get(1, 16, { Tag(3, 3) }) != nullptr);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,9 +1,12 @@
 #include "entities/Node.hpp"
 #include "mapcss/StyleDeclaration.hpp"
+#include "utils/ParallelUtils.hpp"
 
 #include <boost/test/unit_test.hpp>
 
 #include <cstdio>
+#include <string>
+#include <vector>
 
 #include "test_utils/DependencyProvider.hpp"
 #include "test_utils/ElementUtils.hpp"
@@ -74,4 +77,75 @@ BOOST_AUTO_TEST_CASE(GiveOneTagOneNumber_WhenStringEvaluate_ThenReturnValue)
     BOOST_CHECK_EQUAL(result, "red");
 }
 
+BOOST_AUTO_TEST_CASE(GivenValueInMeters_WhenCreate_ThenHasNumberWithUnit)
+{
+    StyleDeclaration styleDeclaration(0, "2.5m");
+
+    BOOST_CHECK(!styleDeclaration.isEval());
+    BOOST_CHECK_EQUAL(styleDeclaration.number(), 2.5);
+    BOOST_CHECK(styleDeclaration.unit() == StyleDeclaration::Unit::Meters);
+}
+
+BOOST_AUTO_TEST_CASE(GivenValueInPercents_WhenCreate_ThenHasNumberWithUnit)
+{
+    StyleDeclaration styleDeclaration(0, "50%");
+
+    BOOST_CHECK_EQUAL(styleDeclaration.number(), 50);
+    BOOST_CHECK(styleDeclaration.unit() == StyleDeclaration::Unit::Percent);
+}
+
+BOOST_AUTO_TEST_CASE(GivenStringValue_WhenCreate_ThenNumberIsZero)
+{
+    StyleDeclaration styleDeclaration(0, "flat");
+
+    BOOST_CHECK_EQUAL(styleDeclaration.number(), 0);
+    BOOST_CHECK(styleDeclaration.unit() == StyleDeclaration::Unit::None);
+    BOOST_CHECK_EQUAL(styleDeclaration.value(), "flat");
+}
+
+BOOST_AUTO_TEST_CASE(GivenExpressionWithPrecedence_WhenDoubleEvaluate_ThenReturnValue)
+{
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:levels') * -2 + 4 / 2\")");
+
+    double result = styleDeclaration.evaluate<double>(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
+        0, { { "building:levels", "5" } }).tags,
+    *dependencyProvider.getStringTable());
+
+    BOOST_CHECK_EQUAL(result, -8);
+}
+
+BOOST_AUTO_TEST_CASE(GivenExpression_WhenCompile_ThenHasFlatBytecode)
+{
+    auto tree = StyleEvaluator::parse("eval(\"tag('building:levels') * 3\")");
+
+    auto program = StyleEvaluator::Program::compile(*tree, *dependencyProvider.getStringTable());
+
+    BOOST_REQUIRE_EQUAL(program->instructions().size(), 3);
+    BOOST_CHECK(program->instructions()[0].code == StyleEvaluator::Program::OpCode::Tag);
+    BOOST_CHECK_EQUAL(program->instructions()[0].key, dependencyProvider.getStringTable()->getId("building:levels"));
+    BOOST_CHECK(program->instructions()[1].code == StyleEvaluator::Program::OpCode::Number);
+    BOOST_CHECK_EQUAL(program->instructions()[1].number, 3);
+    BOOST_CHECK(program->instructions()[2].code == StyleEvaluator::Program::OpCode::Multiply);
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyElements_WhenDoubleEvaluateInParallel_ThenReturnValues)
+{
+    const std::size_t count = 1000;
+    StyleDeclaration styleDeclaration(0, "eval(\"tag('building:levels') * 3\")");
+    std::vector<Node> nodes;
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string levels = std::to_string(i % 100);
+        nodes.push_back(ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(),
+            i, { { "building:levels", levels.c_str() } }));
+    }
+    std::vector<double> results(count);
+
+    utymap::utils::parallelFor(count, [&](std::size_t i) {
+        results[i] = styleDeclaration.evaluate<double>(nodes[i].tags, *dependencyProvider.getStringTable());
+    });
+
+    for (std::size_t i = 0; i < count; ++i)
+        BOOST_CHECK_EQUAL(results[i], (i % 100) * 3);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
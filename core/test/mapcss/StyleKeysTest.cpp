@@ -0,0 +1,58 @@
+#include "mapcss/StyleKeys.hpp"
+
+#include <boost/test/unit_test.hpp>
+#include "test_utils/DependencyProvider.hpp"
+
+using namespace utymap::mapcss;
+
+namespace {
+    struct MapCss_StyleKeysFixture
+    {
+        MapCss_StyleKeysFixture() :
+            dependencyProvider(),
+            stringTable(*dependencyProvider.getStringTable())
+        {
+            Rule rule;
+            rule.declarations.push_back(Declaration{ "layer-priority", "water,drive" });
+            rule.declarations.push_back(Declaration{ "terrain-layer", "pedestrian" });
+            stylesheet.rules.push_back(rule);
+        }
+
+        DependencyProvider dependencyProvider;
+        utymap::index::StringTable& stringTable;
+        StyleSheet stylesheet;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_StyleKeys, MapCss_StyleKeysFixture)
+
+BOOST_AUTO_TEST_CASE(GivenStyleSheet_WhenCreate_ThenKeysAreResolved)
+{
+    StyleKeys keys(stylesheet, stringTable);
+
+    BOOST_CHECK_EQUAL(keys.height, stringTable.getId("height"));
+    BOOST_CHECK_EQUAL(keys.roofType, stringTable.getId("roof-type"));
+    BOOST_CHECK_EQUAL(keys.terrainLayer, stringTable.getId("terrain-layer"));
+}
+
+BOOST_AUTO_TEST_CASE(GivenLayersInStyleSheet_WhenGetTerrainKeys_ThenPrefixedKeysAreReturned)
+{
+    StyleKeys keys(stylesheet, stringTable);
+
+    BOOST_CHECK_EQUAL(keys.terrain("").maxArea, stringTable.getId("max-area"));
+    BOOST_CHECK_EQUAL(keys.terrain("water-").color, stringTable.getId("water-color"));
+    BOOST_CHECK_EQUAL(keys.terrain("drive-").meshName, stringTable.getId("drive-mesh-name"));
+    BOOST_CHECK_EQUAL(keys.terrain("pedestrian-").meshExtras, stringTable.getId("pedestrian-mesh-extras"));
+}
+
+BOOST_AUTO_TEST_CASE(GivenUnknownLayer_WhenGetTerrainKeys_ThenKeysAreResolvedOnDemand)
+{
+    StyleKeys keys(stylesheet, stringTable);
+
+    const StyleKeys::TerrainKeys& terrainKeys = keys.terrain("sand-");
+
+    BOOST_CHECK_EQUAL(terrainKeys.heightOffset, stringTable.getId("sand-height-offset"));
+    BOOST_CHECK_EQUAL(&terrainKeys, &keys.terrain("sand-"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
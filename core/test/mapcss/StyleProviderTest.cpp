@@ -1,13 +1,18 @@
 #include "entities/Element.hpp"
 #include "entities/Node.hpp"
+#include "entities/Area.hpp"
 #include "entities/Way.hpp"
 #include "entities/Relation.hpp"
 #include "mapcss/StyleProvider.hpp"
 #include "test_utils/ElementUtils.hpp"
+#include "utils/ParallelUtils.hpp"
 
 #include <boost/test/unit_test.hpp>
 #include "test_utils/DependencyProvider.hpp"
 
+#include <atomic>
+#include <string>
+
 using namespace utymap::entities;
 using namespace utymap::mapcss;
 
@@ -114,4 +119,181 @@ BOOST_AUTO_TEST_CASE(GivenTwoNotEqualsConditions_WhenHasStyle_ThenReturnFalse)
     BOOST_CHECK(!styleProvider->hasStyle(node, zoomLevel));
 }
 
+BOOST_AUTO_TEST_CASE(GivenRulesIndexedByDifferentConditions_WhenForElement_ThenLaterRuleWins)
+{
+    setSingleSelector(1, 1, { "area" }, { { "building", "=", "yes" } });
+    stylesheet->rules[0].declarations.push_back(Declaration{ "color", "red" });
+    Rule rule;
+    Selector selector;
+    selector.names.push_back("area");
+    selector.zoom.start = 1;
+    selector.zoom.end = 1;
+    selector.conditions.push_back(Condition{ "building", "", "" });
+    rule.selectors.push_back(selector);
+    rule.declarations.push_back(Declaration{ "color", "blue" });
+    stylesheet->rules.push_back(rule);
+    styleProvider = std::make_shared<StyleProvider>(*stylesheet, *dependencyProvider.getStringTable());
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+        {
+            std::make_pair("building", "yes")
+        });
+
+    Style style = styleProvider->forElement(area, 1);
+
+    BOOST_CHECK_EQUAL(style.getString("color"), "blue");
+}
+
+BOOST_AUTO_TEST_CASE(GivenOnlyNotEqualsCondition_WhenHasStyle_ThenReturnTrueForOtherValue)
+{
+    setSingleSelector(1, 1, { "node" }, { { "access", "!=", "no" } });
+    Node node = ElementUtils::createElement<Node>(*dependencyProvider.getStringTable(), 0,
+        {
+            std::make_pair("access", "yes")
+        });
+
+    BOOST_CHECK(styleProvider->hasStyle(node, 1));
+}
+
+BOOST_AUTO_TEST_CASE(GivenRulesWithOverlappingZooms_WhenForLevelsOfDetails_ThenLodsAreGroupedByRules)
+{
+    setSingleSelector(1, 3, { "area" }, { { "building", "", "" } });
+    stylesheet->rules[0].declarations.push_back(Declaration{ "color", "red" });
+    Rule rule;
+    Selector selector;
+    selector.names.push_back("area");
+    selector.zoom.start = 3;
+    selector.zoom.end = 4;
+    selector.conditions.push_back(Condition{ "building", "=", "yes" });
+    rule.selectors.push_back(selector);
+    rule.declarations.push_back(Declaration{ "color", "blue" });
+    stylesheet->rules.push_back(rule);
+    styleProvider = std::make_shared<StyleProvider>(*stylesheet, *dependencyProvider.getStringTable());
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+        {
+            std::make_pair("building", "yes")
+        });
+
+    auto styles = styleProvider->forLevelsOfDetails(area);
+
+    BOOST_REQUIRE_EQUAL(styles.size(), 3);
+    BOOST_CHECK_EQUAL(styles[0].lodMask, (1u << 1) | (1u << 2));
+    BOOST_CHECK_EQUAL(styles[0].style.getString("color"), "red");
+    BOOST_CHECK_EQUAL(styles[1].lodMask, 1u << 3);
+    BOOST_CHECK_EQUAL(styles[1].style.getString("color"), "blue");
+    BOOST_CHECK_EQUAL(styles[2].lodMask, 1u << 4);
+    BOOST_CHECK_EQUAL(styles[2].style.getString("color"), "blue");
+}
+
+BOOST_AUTO_TEST_CASE(GivenNotMatchingElement_WhenForLevelsOfDetails_ThenNoStylesReturned)
+{
+    setSingleSelector(1, 3, { "area" }, { { "building", "", "" } });
+    Area area = ElementUtils::createElement<Area>(*dependencyProvider.getStringTable(), 0,
+        {
+            std::make_pair("landuse", "grass")
+        });
+
+    BOOST_CHECK(styleProvider->forLevelsOfDetails(area).empty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenGradientNotInStyleSheet_WhenGetGradientTwice_ThenSameInstanceIsReturned)
+{
+    setSingleSelector(1, 1, { "node" }, { { "amenity", "", "" } });
+
+    auto first = styleProvider->getGradient("gradient(#ffffff, #000000)");
+    auto second = styleProvider->getGradient("gradient(#ffffff, #000000)");
+
+    BOOST_CHECK(first == second);
+    BOOST_CHECK_EQUAL(styleProvider->getGradients().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyGradientsNotInStyleSheet_WhenGetGradient_ThenAmountOfKeptGradientsIsBounded)
+{
+    const int count = 1000;
+    setSingleSelector(1, 1, { "node" }, { { "amenity", "", "" } });
+
+    for (int i = 0; i < count; ++i)
+        styleProvider->getGradient("gradient(#ffffff, #" + std::to_string(100000 + i) + ")");
+
+    BOOST_CHECK(styleProvider->getGradients().size() < count);
+    BOOST_CHECK(styleProvider->getGradient("gradient(#ffffff, #000000)") != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(GivenConditions_WhenGetImportFilter_ThenFilterAcceptsOnlyMatchingData)
+{
+    setSingleSelector(1, 1, { "node" }, { { "amenity", "=", "biergarten" }, { "name", "", "" }, { "access", "!=", "no" } });
+    ImportFilter filter = styleProvider->getImportFilter(utymap::LodRange(1, 1));
+
+    BOOST_CHECK(filter.canMatch(ImportFilter::Node, { { "amenity", "biergarten" } }));
+    BOOST_CHECK(filter.canMatch(ImportFilter::Node, { { "name", "Foo" } }));
+    BOOST_CHECK(!filter.canMatch(ImportFilter::Node, { { "amenity", "cafe" } }));
+    BOOST_CHECK(!filter.canMatch(ImportFilter::Way, { { "amenity", "biergarten" } }));
+    BOOST_CHECK(filter.isUsed({ "access", "yes" }));
+    BOOST_CHECK(!filter.isUsed({ "amenity", "cafe" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenNotEqualsCondition_WhenGetImportFilter_ThenKeyPresenceIsRequired)
+{
+    setSingleSelector(1, 1, { "node" }, { { "access", "!=", "no" } });
+    ImportFilter filter = styleProvider->getImportFilter(utymap::LodRange(1, 1));
+
+    BOOST_CHECK(filter.canMatch(ImportFilter::Node, { { "access", "yes" } }));
+    BOOST_CHECK(!filter.canMatch(ImportFilter::Node, { { "name", "Foo" } }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenEvalDeclaration_WhenGetImportFilter_ThenEvalTagIsUsed)
+{
+    stylesheet->rules[0].declarations.push_back(Declaration{ "height", "eval(\"tag('building:levels') * 3\")" });
+    setSingleSelector(1, 1, { "area" }, { { "building", "", "" } });
+    ImportFilter filter = styleProvider->getImportFilter(utymap::LodRange(1, 1));
+    utymap::formats::Tags tags = { { "building", "yes" }, { "building:levels", "5" }, { "note", "test" } };
+
+    filter.apply(tags);
+
+    BOOST_CHECK_EQUAL(tags.size(), 2);
+    BOOST_CHECK_EQUAL(tags[1].key, "building:levels");
+}
+
+BOOST_AUTO_TEST_CASE(GivenBuildersDeclaration_WhenForElement_ThenBuildersAreResolvedToIndices)
+{
+    stylesheet->rules[0].declarations.push_back(Declaration{ "builders", "terrain,building" });
+    Rule rule;
+    rule.selectors.push_back(Selector{ { "node" }, { 1, 1 }, { { "amenity", "", "" } } });
+    rule.declarations.push_back(Declaration{ "builders", "building,tree" });
+    stylesheet->rules.push_back(rule);
+    setSingleSelector(1, 1, { "area" }, { { "building", "", "" } });
+    auto& stringTable = *dependencyProvider.getStringTable();
+    Node node = ElementUtils::createElement<Node>(stringTable, 0, { std::make_pair("amenity", "bench") });
+
+    Style style = styleProvider->forElement(node, 1);
+
+    const auto& names = styleProvider->getBuilderNames();
+    BOOST_CHECK((names == std::vector<std::string>{ "terrain", "building", "tree" }));
+    BOOST_CHECK((style.get(stringTable.getId("builders"))->builders() == std::vector<std::uint16_t>{ 1, 2 }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenSelectorWithDifferentZoom_WhenGetImportFilter_ThenNothingIsAccepted)
+{
+    setSingleSelector(1, 1, { "node" }, { { "amenity", "=", "biergarten" } });
+    ImportFilter filter = styleProvider->getImportFilter(utymap::LodRange(2, 5));
+
+    BOOST_CHECK(!filter.canMatch(ImportFilter::Node, { { "amenity", "biergarten" } }));
+    BOOST_CHECK(!filter.isUsed({ "amenity", "biergarten" }));
+}
+
+BOOST_AUTO_TEST_CASE(GivenCanvasForOneLod_WhenForCanvasConcurrentlyForUnknownLods_ThenEmptyStylesAreReturned)
+{
+    stylesheet->rules[0].declarations.push_back(Declaration{ "color", "red" });
+    setSingleSelector(1, 1, { "canvas" }, {});
+    std::atomic<int> nonEmptyCount(0);
+
+    // NOTE checks are done on main thread.
+    utymap::utils::parallelFor(64, [&](std::size_t i) {
+        if (!styleProvider->forCanvas(2 + static_cast<int>(i % 16)).empty())
+            ++nonEmptyCount;
+    }, 8);
+
+    BOOST_CHECK_EQUAL(nonEmptyCount.load(), 0);
+    BOOST_CHECK(!styleProvider->forCanvas(1).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#include "mapcss/StyleSheetDiff.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace utymap::mapcss;
+
+namespace {
+    Rule createRule(const std::string& name, std::uint8_t start, std::uint8_t end, const std::string& color)
+    {
+        Selector selector;
+        selector.names.push_back(name);
+        selector.zoom.start = start;
+        selector.zoom.end = end;
+        selector.conditions.push_back(Condition{ "building", "", "" });
+
+        Rule rule;
+        rule.selectors.push_back(selector);
+        rule.declarations.push_back(Declaration{ "color", color });
+        return rule;
+    }
+
+    struct MapCss_StyleSheetDiffFixture
+    {
+        MapCss_StyleSheetDiffFixture()
+        {
+            stylesheet.rules.push_back(createRule("area", 1, 1, "red"));
+            stylesheet.rules.push_back(createRule("way", 2, 3, "green"));
+            stylesheet.rules.push_back(createRule("node", 4, 4, "blue"));
+        }
+
+        StyleSheet stylesheet;
+    };
+}
+
+BOOST_FIXTURE_TEST_SUITE(MapCss_StyleSheetDiff, MapCss_StyleSheetDiffFixture)
+
+BOOST_AUTO_TEST_CASE(GivenSameStyleSheet_WhenCreate_ThenDiffIsEmpty)
+{
+    StyleSheetDiff diff = StyleSheetDiff::create(stylesheet, stylesheet);
+
+    BOOST_CHECK(diff.empty());
+    BOOST_CHECK_EQUAL(diff.lodMask, 0);
+}
+
+BOOST_AUTO_TEST_CASE(GivenChangedDeclaration_WhenCreate_ThenOnlyItsRuleIsReported)
+{
+    StyleSheet newStylesheet = stylesheet;
+    newStylesheet.rules[1].declarations[0].value = "yellow";
+
+    StyleSheetDiff diff = StyleSheetDiff::create(stylesheet, newStylesheet);
+
+    BOOST_REQUIRE_EQUAL(diff.selectors.size(), 1);
+    BOOST_CHECK(diff.selectors[0].find("way") != std::string::npos);
+    BOOST_CHECK_EQUAL(diff.lodMask, (1u << 2) | (1u << 3));
+}
+
+BOOST_AUTO_TEST_CASE(GivenAddedRule_WhenCreate_ThenItsLevelsOfDetailsAreReported)
+{
+    StyleSheet newStylesheet = stylesheet;
+    newStylesheet.rules.push_back(createRule("relation", 5, 6, "black"));
+
+    StyleSheetDiff diff = StyleSheetDiff::create(stylesheet, newStylesheet);
+
+    BOOST_REQUIRE_EQUAL(diff.selectors.size(), 1);
+    BOOST_CHECK(diff.selectors[0].find("relation") != std::string::npos);
+    BOOST_CHECK_EQUAL(diff.lodMask, (1u << 5) | (1u << 6));
+}
+
+BOOST_AUTO_TEST_CASE(GivenRemovedRule_WhenCreate_ThenItsLevelsOfDetailsAreReported)
+{
+    StyleSheet newStylesheet = stylesheet;
+    newStylesheet.rules.erase(newStylesheet.rules.begin());
+
+    StyleSheetDiff diff = StyleSheetDiff::create(stylesheet, newStylesheet);
+
+    BOOST_REQUIRE_EQUAL(diff.selectors.size(), 1);
+    BOOST_CHECK_EQUAL(diff.lodMask, 1u << 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
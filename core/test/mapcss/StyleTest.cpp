@@ -59,5 +59,27 @@ BOOST_AUTO_TEST_CASE(GivenNegativeValueInMeters_WhenGetValue_ThenReturnExpectedV
     BOOST_CHECK_EQUAL(width, -1);
 }
 
+BOOST_AUTO_TEST_CASE(GivenEvalDeclaration_WhenGetString_ThenReturnEvaluatedValue)
+{
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(),
+        0, { std::make_pair("color", "red") }, { { 52.52975, 13.38810 } });
+    Style style = dependencyProvider.getStyleProvider("way|z16[color] { fill-color: eval(\"tag('color')\"); }")
+        ->forElement(way, 16);
+
+    const std::string& color = style.getString("fill-color");
+
+    BOOST_CHECK_EQUAL(color, "red");
+    BOOST_CHECK_EQUAL(&style.getString("fill-color"), &color);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMissingDeclaration_WhenGetString_ThenReturnEmptyString)
+{
+    int lod = 16;
+    Way way = ElementUtils::createElement<Way>(*dependencyProvider.getStringTable(),
+        0, { std::make_pair("water", "") }, { { 52.52975, 13.38810 } });
+    Style style = dependencyProvider.getStyleProvider(stylesheet)->forElement(way, lod);
+
+    BOOST_CHECK(style.getString("color").empty());
+}
 
 BOOST_AUTO_TEST_SUITE_END()
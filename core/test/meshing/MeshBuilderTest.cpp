@@ -144,4 +144,19 @@ BOOST_AUTO_TEST_CASE(GivenPolygonWithSharePoint_WhenAddPolygon_ThenRefinesCorrec
     BOOST_CHECK(mesh.vertices.size() > 0);
 }
 
+BOOST_AUTO_TEST_CASE(GivenCancelledToken_WhenAddPolygon_ThenMeshIsNotChanged)
+{
+    utymap::utils::CancellationToken cancelToken;
+    cancelToken.cancel();
+    MeshBuilder cancelledBuilder(eleProvider, cancelToken);
+    Mesh mesh("");
+    Polygon polygon(4, 0);
+    polygon.addContour(std::vector<DPoint> { DPoint(0, 0), DPoint(10, 0), DPoint(10, 10), DPoint(0, 10) });
+
+    cancelledBuilder.addPolygon(mesh, polygon, MeshBuilder::Options(5, 0, 0, 0, colorGradient));
+
+    BOOST_CHECK(mesh.vertices.empty());
+    BOOST_CHECK(mesh.triangles.empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
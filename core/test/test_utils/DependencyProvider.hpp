@@ -52,7 +52,7 @@ public:
         const utymap::QuadKey& quadKey,
         const std::string& stylesheet,
         std::function<void(const utymap::meshing::Mesh&)> meshCallback = nullptr,
-        std::function<void(const utymap::entities::Element&)> elementCallback = nullptr)
+        std::function<void(const utymap::entities::Element&, const utymap::mapcss::Style&)> elementCallback = nullptr)
     {
         return std::make_shared<utymap::builders::BuilderContext>(quadKey,
                                                                  *getStyleProvider(stylesheet),
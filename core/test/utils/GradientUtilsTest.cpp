@@ -49,6 +49,18 @@ BOOST_AUTO_TEST_CASE(GivenNonStandardNamedColorStrings_WhenEvaluate_ThenReturnCo
 }
 
 
+BOOST_AUTO_TEST_CASE(GivenTimeBetweenStops_WhenEvaluate_ThenReturnInterpolatedColor)
+{
+    auto gradient = GradientUtils::parseGradient("gradient(#000000, #ffffff)");
+
+    Color color = gradient->evaluate(0.5);
+
+    BOOST_CHECK_EQUAL(static_cast<int>(color.r), 127);
+    BOOST_CHECK_EQUAL(color, gradient->evaluate(0.501));
+    BOOST_CHECK_EQUAL(gradient->evaluate(-1), 0x000000FF);
+    BOOST_CHECK_EQUAL(gradient->evaluate(2), 0xFFFFFFFF);
+}
+
 BOOST_AUTO_TEST_CASE(GivenColorString_WhenParseGradient_ThenReturnValid)
 {
     std::string gradientKey = "#ec8859";
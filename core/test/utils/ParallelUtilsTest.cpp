@@ -0,0 +1,44 @@
+#include "utils/ParallelUtils.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace utymap::utils;
+
+BOOST_AUTO_TEST_SUITE(Utils_ParallelUtils)
+
+BOOST_AUTO_TEST_CASE(GivenSeveralWorkers_WhenParallelFor_ThenEveryIndexIsVisitedOnce)
+{
+    std::vector<std::atomic<int>> visits(1000);
+    for (auto& visit : visits) visit = 0;
+
+    parallelFor(visits.size(), [&](std::size_t i) { ++visits[i]; }, 4);
+
+    for (const auto& visit : visits)
+        BOOST_CHECK_EQUAL(visit.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenNestedCalls_WhenParallelFor_ThenEveryIndexIsVisitedOnce)
+{
+    std::vector<std::atomic<int>> visits(400);
+    for (auto& visit : visits) visit = 0;
+
+    parallelFor(20, [&](std::size_t i) {
+        parallelFor(20, [&](std::size_t j) { ++visits[i * 20 + j]; }, 4);
+    }, 4);
+
+    for (const auto& visit : visits)
+        BOOST_CHECK_EQUAL(visit.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenThrowingFunction_WhenParallelFor_ThenExceptionIsRethrown)
+{
+    BOOST_CHECK_THROW(parallelFor(100, [](std::size_t i) {
+        if (i == 50) throw std::domain_error("test");
+    }, 4), std::domain_error);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
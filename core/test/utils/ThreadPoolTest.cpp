@@ -0,0 +1,65 @@
+#include "utils/ThreadPool.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace utymap::utils;
+
+BOOST_AUTO_TEST_SUITE(Utils_ThreadPool)
+
+BOOST_AUTO_TEST_CASE(GivenQueuedTasks_WhenWait_ThenAllTasksAreCompleted)
+{
+    ThreadPool pool(4);
+    std::atomic<int> counter(0);
+
+    for (int i = 0; i < 100; ++i)
+        pool.enqueue([&]() { ++counter; });
+    pool.wait();
+
+    BOOST_CHECK_EQUAL(counter.load(), 100);
+}
+
+BOOST_AUTO_TEST_CASE(GivenQueuedTasks_WhenDestroyed_ThenQueuedTasksAreCompleted)
+{
+    std::atomic<int> counter(0);
+    {
+        ThreadPool pool(2);
+        for (int i = 0; i < 50; ++i)
+            pool.enqueue([&]() { ++counter; });
+    }
+
+    BOOST_CHECK_EQUAL(counter.load(), 50);
+}
+
+BOOST_AUTO_TEST_CASE(GivenSingleWorker_WhenEnqueue_ThenTasksAreRunInOrderOnOtherThread)
+{
+    ThreadPool pool(1);
+    std::vector<int> order;
+    std::thread::id workerId;
+
+    for (int i = 0; i < 10; ++i)
+        pool.enqueue([&, i]() { order.push_back(i); workerId = std::this_thread::get_id(); });
+    pool.wait();
+
+    BOOST_REQUIRE_EQUAL(order.size(), 10);
+    for (int i = 0; i < 10; ++i)
+        BOOST_CHECK_EQUAL(order[i], i);
+    BOOST_CHECK(workerId != std::this_thread::get_id());
+}
+
+BOOST_AUTO_TEST_CASE(GivenTask_WhenRunOnWorker_ThenThreadIsReportedAsWorker)
+{
+    ThreadPool pool(1);
+    std::atomic<bool> isWorker(false);
+
+    pool.enqueue([&]() { isWorker = ThreadPool::isWorkerThread(); });
+    pool.wait();
+
+    BOOST_CHECK(isWorker.load());
+    BOOST_CHECK(!ThreadPool::isWorkerThread());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -25,14 +25,34 @@ namespace UtyMap.Unity.Maps
 
             // NOTE actually, it is possible to have multiple in-memory and persistent 
             // storages at the same time.
-            registerInMemoryStore(InMemoryStoreKey);
-            registerPersistentStore(PersistentStoreKey, mapDataPath);
+            registerInMemoryStore(InMemoryStoreKey, false);
+            registerPersistentStore(PersistentStoreKey, mapDataPath, false);
 
             // NOTE core library can't create directories so far
             for (int i = 1; i <= 16; ++i)
                 Directory.CreateDirectory(Path.Combine(mapDataPath, i.ToString()));
         }
 
+        /// <summary>
+        ///     Configures cache of built quadkeys and compiled stylesheets.
+        ///     Should be called before stylesheets are used.
+        /// </summary>
+        /// <param name="directory"> Cache directory, empty to keep only in memory. </param>
+        /// <param name="memorySize"> Memory limit in bytes. </param>
+        public static void ConfigureMeshCache(string directory, int memorySize)
+        {
+            configureMeshCache(directory, memorySize);
+        }
+
+        /// <summary> Reloads stylesheet and reports changes. </summary>
+        /// <param name="stylePath"> Stylesheet path. </param>
+        /// <param name="onStyleChanged"> Reports level of details and selectors affected by changes. </param>
+        /// <param name="onError"> OnError callback. </param>
+        public static void ReloadStylesheet(string stylePath, OnStyleChanged onStyleChanged, OnError onError)
+        {
+            reloadStylesheet(stylePath, onStyleChanged, onError);
+        }
+
         /// <summary> Preloads elevation data for given quadkey. </summary>
         /// <param name="quadKey">Quadkey.</param>
         public static void PreloadElevation(QuadKey quadKey)
@@ -98,6 +118,15 @@ namespace UtyMap.Unity.Maps
             return hasData(quadKey.TileX, quadKey.TileY, quadKey.LevelOfDetail);
         }
 
+        /// <summary> Checks whether there is data for every given quadkey. </summary>
+        /// <returns> Result for every quadkey. </returns>
+        public static bool[] HasData(QuadKey[] quadKeys)
+        {
+            var results = new bool[quadKeys.Length];
+            hasDataBatch(ToTriples(quadKeys), quadKeys.Length, results);
+            return results;
+        }
+
         /// <summary> Loads quadkey. </summary>
         /// <param name="stylePath"> Stylesheet path. </param>
         /// <param name="quadKey"> QuadKey</param>
@@ -111,6 +140,60 @@ namespace UtyMap.Unity.Maps
                 onMeshBuilt, onElementLoaded, onError);
         }
 
+        /// <summary> Loads several quadkeys and returns when all of them are loaded. </summary>
+        /// <param name="stylePath"> Stylesheet path. </param>
+        /// <param name="quadKeys"> QuadKeys. </param>
+        /// <param name="onMeshBuilt"></param>
+        /// <param name="onElementLoaded"></param>
+        /// <param name="onQuadKeyLoaded"> Gets index of loaded quadkey in given array. </param>
+        public static void LoadQuadKeys(string stylePath, QuadKey[] quadKeys,
+            OnMeshBuilt onMeshBuilt, OnElementLoaded onElementLoaded, OnQuadKeyLoaded onQuadKeyLoaded)
+        {
+            loadQuadKeys(stylePath, ToTriples(quadKeys), quadKeys.Length,
+                onMeshBuilt, onElementLoaded, onQuadKeyLoaded);
+        }
+
+        /// <summary>
+        ///     Loads quadkey on worker thread. Callbacks are called on worker threads
+        ///     and should be kept referenced until request is completed.
+        /// </summary>
+        /// <param name="stylePath"> Stylesheet path. </param>
+        /// <param name="quadKey"> QuadKey. </param>
+        /// <param name="onMeshBuilt"></param>
+        /// <param name="onElementLoaded"></param>
+        /// <param name="onRequestCompleted"> Called once, also when request is cancelled. </param>
+        /// <returns> Request id. </returns>
+        public static int LoadQuadKeyAsync(string stylePath, QuadKey quadKey,
+            OnMeshBuilt onMeshBuilt, OnElementLoaded onElementLoaded, OnRequestCompleted onRequestCompleted)
+        {
+            return loadQuadKeyAsync(stylePath, quadKey.TileX, quadKey.TileY, quadKey.LevelOfDetail,
+                onMeshBuilt, onElementLoaded, onRequestCompleted);
+        }
+
+        /// <summary> Cancels asynchronous loading of quadkey. </summary>
+        /// <param name="requestId"> Request id. </param>
+        public static void CancelRequest(int requestId)
+        {
+            cancelRequest(requestId);
+        }
+
+        /// <summary> Sets camera used to prioritize asynchronous loading. </summary>
+        /// <param name="position"> Camera position on the ground. </param>
+        /// <param name="heading"> View direction in degrees from north. </param>
+        /// <param name="fieldOfView"> Horizontal field of view in degrees. </param>
+        /// <param name="viewDistance"> Max distance to tile in meters. </param>
+        public static void SetCamera(GeoCoordinate position, double heading, double fieldOfView, double viewDistance)
+        {
+            setCamera(position.Latitude, position.Longitude, heading, fieldOfView, viewDistance);
+        }
+
+        /// <summary> Sets amount of worker threads used by asynchronous loading. </summary>
+        /// <param name="workerCount"> Amount of worker threads. </param>
+        public static void SetWorkerCount(int workerCount)
+        {
+            setWorkerCount(workerCount);
+        }
+
         /// <summary> Frees resources. Should be called before application stops. </summary>
         public static void Dispose()
         {
@@ -124,6 +207,19 @@ namespace UtyMap.Unity.Maps
             return storageType == MapStorageType.InMemory ? InMemoryStoreKey : PersistentStoreKey;
         }
 
+        /// <summary> Converts quadkeys to tileX, tileY, levelOfDetail triples. </summary>
+        private static int[] ToTriples(QuadKey[] quadKeys)
+        {
+            int[] triples = new int[quadKeys.Length * 3];
+            for (int i = 0; i < quadKeys.Length; ++i)
+            {
+                triples[i*3] = quadKeys[i].TileX;
+                triples[i*3 + 1] = quadKeys[i].TileY;
+                triples[i*3 + 2] = quadKeys[i].LevelOfDetail;
+            }
+            return triples;
+        }
+
         #endregion
 
         #region PInvoke import
@@ -140,6 +236,17 @@ namespace UtyMap.Unity.Maps
             [MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 4)] [In] double[] vertices, [In] int vertexCount,
             [MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 6)] [In] string[] styles, [In] int styleCount);
 
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void OnStyleChanged(
+            [MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 1)] [In] int[] levelOfDetails, [In] int lodCount,
+            [MarshalAs(UnmanagedType.LPArray, SizeParamIndex = 3)] [In] string[] selectors, [In] int selectorCount);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void OnRequestCompleted([In] int requestId, [In] string errorMessage);
+
+        [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+        internal delegate void OnQuadKeyLoaded([In] int quadKeyIndex, [In] string errorMessage);
+
         [UnmanagedFunctionPointer(CallingConvention.Cdecl)]
         internal delegate void OnError([In] string message);
 
@@ -147,10 +254,16 @@ namespace UtyMap.Unity.Maps
         private static extern void configure(string stringPath, string elePath, OnError errorHandler);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
-        private static extern void registerInMemoryStore(string key);
+        private static extern void configureMeshCache(string directory, int memorySize);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
-        private static extern void registerPersistentStore(string key, string path);
+        private static extern void reloadStylesheet(string path, OnStyleChanged changeHandler, OnError errorHandler);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void registerInMemoryStore(string key, [MarshalAs(UnmanagedType.I1)] bool isFiltered);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void registerPersistentStore(string key, string path, [MarshalAs(UnmanagedType.I1)] bool isFiltered);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
         private static extern void addToStoreInRange(string key, string stylePath, string path, int startLod, int endLod, OnError errorHandler);
@@ -163,12 +276,34 @@ namespace UtyMap.Unity.Maps
             string[] tags, int tagLength, int startLod, int endLod, OnError errorHandler);
 
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        [return: MarshalAs(UnmanagedType.I1)]
         private static extern bool hasData(int tileX, int tileY, int levelOfDetails);
 
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void hasDataBatch(int[] quadKeys, int quadKeyCount,
+            [MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.I1)] [Out] bool[] results);
+
         [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
         private static extern void loadQuadKey(string stylePath, int tileX, int tileY, int levelOfDetails,
             OnMeshBuilt meshBuiltHandler, OnElementLoaded elementLoadedHandler, OnError errorHandler);
 
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void loadQuadKeys(string stylePath, int[] quadKeys, int quadKeyCount,
+            OnMeshBuilt meshBuiltHandler, OnElementLoaded elementLoadedHandler, OnQuadKeyLoaded quadKeyLoadedHandler);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern int loadQuadKeyAsync(string stylePath, int tileX, int tileY, int levelOfDetails,
+            OnMeshBuilt meshBuiltHandler, OnElementLoaded elementLoadedHandler, OnRequestCompleted requestCompletedHandler);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void cancelRequest(int requestId);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void setCamera(double latitude, double longitude, double heading, double fieldOfView, double viewDistance);
+
+        [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
+        private static extern void setWorkerCount(int workerCount);
+
          [DllImport("UtyMap.Shared", CallingConvention = CallingConvention.StdCall)]
         private static extern void preloadElevation(int tileX, int tileY, int levelOfDetails);
 